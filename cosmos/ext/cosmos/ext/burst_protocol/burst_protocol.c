@@ -0,0 +1,146 @@
+/*
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+*/
+
+#include "ruby.h"
+#include "stdio.h"
+#include "string.h"
+
+VALUE mCosmos = Qnil;
+VALUE cProtocol = Qnil;
+VALUE cBurstProtocol = Qnil;
+
+/*
+ * Find the first full sync pattern at or after offset. Candidates are
+ * filtered on the first and last pattern bytes before comparing the rest.
+ * If there is no full pattern the start of the longest partial pattern at
+ * the end of the data is returned instead. The data length is returned if
+ * nothing matches.
+ */
+static long find_sync(const unsigned char *data, long length, long offset, const unsigned char *pattern, long pattern_length)
+{
+  const unsigned char *current = NULL;
+  const unsigned char *last = NULL;
+  unsigned char first_byte = 0;
+  unsigned char last_byte = 0;
+  long index = 0;
+
+  if (pattern_length <= 0)
+  {
+    return offset;
+  }
+
+  first_byte = pattern[0];
+  last_byte = pattern[pattern_length - 1];
+
+  /* Full patterns */
+  if ((length - offset) >= pattern_length)
+  {
+    current = data + offset;
+    last = data + length - pattern_length;
+    while (current <= last)
+    {
+      current = memchr(current, first_byte, (size_t)(last - current + 1));
+      if (current == NULL)
+      {
+        break;
+      }
+      if ((current[pattern_length - 1] == last_byte) &&
+          (memcmp(current + 1, pattern + 1, (size_t)(pattern_length - 1)) == 0))
+      {
+        return (long)(current - data);
+      }
+      current++;
+    }
+  }
+
+  /* Partial patterns at the end of the data */
+  index = length - pattern_length + 1;
+  if (index < offset)
+  {
+    index = offset;
+  }
+  for (; index < length; index++)
+  {
+    if ((data[index] == first_byte) &&
+        (memcmp(data + index, pattern, (size_t)(length - index)) == 0))
+    {
+      return index;
+    }
+  }
+
+  return length;
+}
+
+/*
+ * Search for a sync pattern in data
+ *
+ * @param data [String] Data to search
+ * @param sync_pattern [String] Sync pattern to find
+ * @param offset [Integer] Index in data to start searching
+ * @return [Integer] Index of the first full sync pattern. If there isn't one
+ *   the index of a partial sync pattern at the end of the data or the data
+ *   length if there isn't a partial sync pattern either.
+ */
+static VALUE burst_protocol_find_sync(int argc, VALUE *argv, VALUE self)
+{
+  volatile VALUE data = Qnil;
+  volatile VALUE sync_pattern = Qnil;
+  long offset = 0;
+  long length = 0;
+
+  switch (argc)
+  {
+  case 2:
+    data = argv[0];
+    sync_pattern = argv[1];
+    break;
+  case 3:
+    data = argv[0];
+    sync_pattern = argv[1];
+    offset = NUM2LONG(argv[2]);
+    break;
+  default:
+    /* Invalid number of arguments given */
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..3)", argc);
+    break;
+  }
+
+  Check_Type(data, T_STRING);
+  Check_Type(sync_pattern, T_STRING);
+
+  length = RSTRING_LEN(data);
+  if ((offset < 0) || (offset > length))
+  {
+    rb_raise(rb_eIndexError, "offset %ld outside of data length %ld", offset, length);
+  }
+
+  return LONG2NUM(find_sync((const unsigned char *)RSTRING_PTR(data), length, offset,
+                            (const unsigned char *)RSTRING_PTR(sync_pattern), RSTRING_LEN(sync_pattern)));
+}
+
+void Init_burst_protocol(void)
+{
+  rb_require("cosmos/interfaces/protocols/protocol");
+
+  mCosmos = rb_define_module("Cosmos");
+  cProtocol = rb_const_get(mCosmos, rb_intern("Protocol"));
+
+  cBurstProtocol = rb_define_class_under(mCosmos, "BurstProtocol", cProtocol);
+  rb_define_singleton_method(cBurstProtocol, "find_sync", burst_protocol_find_sync, -1);
+}
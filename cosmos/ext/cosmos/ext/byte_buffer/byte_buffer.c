@@ -0,0 +1,277 @@
+/*
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+*/
+
+#include "ruby.h"
+#include "stdio.h"
+#include "string.h"
+
+VALUE mCosmos = Qnil;
+VALUE cByteBuffer = Qnil;
+
+static ID id_ivar_buffer = 0;
+static ID id_ivar_read_index = 0;
+
+/*
+ * Get the buffer String and the read index after verifying them
+ */
+static VALUE byte_buffer_state(VALUE self, long *read_index)
+{
+  volatile VALUE buffer = rb_ivar_get(self, id_ivar_buffer);
+
+  Check_Type(buffer, T_STRING);
+  *read_index = NUM2LONG(rb_ivar_get(self, id_ivar_read_index));
+  if ((*read_index < 0) || (*read_index > RSTRING_LEN(buffer)))
+  {
+    rb_raise(rb_eRuntimeError, "ByteBuffer read index corrupted");
+  }
+  return buffer;
+}
+
+/*
+ * Verify offset and length lie within the unread data
+ */
+static void byte_buffer_check_range(long offset, long length, long available)
+{
+  if ((offset < 0) || (length < 0) || (offset > available) || (length > (available - offset)))
+  {
+    rb_raise(rb_eIndexError, "Range %ld, %ld outside of the %ld bytes in the buffer", offset, length, available);
+  }
+}
+
+/*
+ * Advance the read index. The buffer is emptied without moving anything
+ * once every byte has been read.
+ */
+static void byte_buffer_advance(VALUE self, VALUE buffer, long read_index, long length)
+{
+  read_index += length;
+  if (read_index == RSTRING_LEN(buffer))
+  {
+    rb_str_modify(buffer);
+    rb_str_set_len(buffer, 0);
+    read_index = 0;
+  }
+  rb_ivar_set(self, id_ivar_read_index, LONG2NUM(read_index));
+}
+
+/*
+ * Append data to the end of the buffer. The unread bytes are moved to the
+ * front first if at least as many bytes have already been read so each
+ * byte is moved an amortized constant number of times.
+ *
+ * @param data [String] Data to append
+ * @return [ByteBuffer] self
+ */
+static VALUE byte_buffer_append(VALUE self, VALUE data)
+{
+  long read_index = 0;
+  long unread = 0;
+  volatile VALUE buffer = byte_buffer_state(self, &read_index);
+
+  Check_Type(data, T_STRING);
+
+  unread = RSTRING_LEN(buffer) - read_index;
+  if ((read_index > 0) && (read_index >= unread))
+  {
+    rb_str_modify(buffer);
+    memmove(RSTRING_PTR(buffer), RSTRING_PTR(buffer) + read_index, (size_t)unread);
+    rb_str_set_len(buffer, unread);
+    rb_ivar_set(self, id_ivar_read_index, INT2FIX(0));
+  }
+  rb_str_buf_append(buffer, data);
+  return self;
+}
+
+/*
+ * @param offset [Integer] Offset from the first unread byte
+ * @return [Integer|nil] Byte at offset or nil if offset is past the end
+ */
+static VALUE byte_buffer_peek(VALUE self, VALUE arg_offset)
+{
+  long read_index = 0;
+  long offset = NUM2LONG(arg_offset);
+  volatile VALUE buffer = byte_buffer_state(self, &read_index);
+
+  if ((offset < 0) || (offset >= (RSTRING_LEN(buffer) - read_index)))
+  {
+    return Qnil;
+  }
+  return INT2FIX(((unsigned char *)RSTRING_PTR(buffer))[read_index + offset]);
+}
+
+/*
+ * Search for a pattern in the unread data
+ *
+ * @param pattern [String] Bytes to find
+ * @param offset [Integer] Offset from the first unread byte to start searching
+ * @return [Integer|nil] Offset of the pattern from the first unread byte or
+ *   nil if it wasn't found
+ */
+static VALUE byte_buffer_find(int argc, VALUE *argv, VALUE self)
+{
+  long read_index = 0;
+  long offset = 0;
+  long available = 0;
+  long pattern_length = 0;
+  volatile VALUE buffer = Qnil;
+  volatile VALUE pattern = Qnil;
+  const unsigned char *data = NULL;
+  const unsigned char *current = NULL;
+  const unsigned char *last = NULL;
+  const unsigned char *pattern_data = NULL;
+
+  switch (argc)
+  {
+  case 1:
+    pattern = argv[0];
+    break;
+  case 2:
+    pattern = argv[0];
+    offset = NUM2LONG(argv[1]);
+    break;
+  default:
+    /* Invalid number of arguments given */
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
+    break;
+  }
+
+  Check_Type(pattern, T_STRING);
+  buffer = byte_buffer_state(self, &read_index);
+  available = RSTRING_LEN(buffer) - read_index;
+  pattern_length = RSTRING_LEN(pattern);
+  if ((offset < 0) || (offset > available))
+  {
+    return Qnil;
+  }
+  if (pattern_length == 0)
+  {
+    return LONG2NUM(offset);
+  }
+  if ((available - offset) < pattern_length)
+  {
+    return Qnil;
+  }
+
+  data = (const unsigned char *)RSTRING_PTR(buffer) + read_index;
+  pattern_data = (const unsigned char *)RSTRING_PTR(pattern);
+  current = data + offset;
+  last = data + available - pattern_length;
+  while (current <= last)
+  {
+    current = memchr(current, pattern_data[0], (size_t)(last - current + 1));
+    if (current == NULL)
+    {
+      break;
+    }
+    if (memcmp(current + 1, pattern_data + 1, (size_t)(pattern_length - 1)) == 0)
+    {
+      return LONG2NUM(current - data);
+    }
+    current++;
+  }
+  return Qnil;
+}
+
+/*
+ * Discard bytes from the front of the buffer without copying anything
+ *
+ * @param length [Integer] Number of bytes to discard
+ * @return [nil]
+ */
+static VALUE byte_buffer_consume(VALUE self, VALUE arg_length)
+{
+  long read_index = 0;
+  long length = NUM2LONG(arg_length);
+  volatile VALUE buffer = byte_buffer_state(self, &read_index);
+
+  byte_buffer_check_range(0, length, RSTRING_LEN(buffer) - read_index);
+  byte_buffer_advance(self, buffer, read_index, length);
+  return Qnil;
+}
+
+/*
+ * Copy part of the unread data without consuming it
+ *
+ * @param offset [Integer] Offset from the first unread byte
+ * @param length [Integer] Number of bytes. Defaults to the rest of the data.
+ * @return [String] Copy of the bytes
+ */
+static VALUE byte_buffer_slice(int argc, VALUE *argv, VALUE self)
+{
+  long read_index = 0;
+  long offset = 0;
+  long length = 0;
+  long available = 0;
+  volatile VALUE buffer = byte_buffer_state(self, &read_index);
+
+  available = RSTRING_LEN(buffer) - read_index;
+  switch (argc)
+  {
+  case 1:
+    offset = NUM2LONG(argv[0]);
+    length = available - offset;
+    break;
+  case 2:
+    offset = NUM2LONG(argv[0]);
+    length = NUM2LONG(argv[1]);
+    break;
+  default:
+    /* Invalid number of arguments given */
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
+    break;
+  }
+
+  byte_buffer_check_range(offset, length, available);
+  return rb_str_new(RSTRING_PTR(buffer) + read_index + offset, length);
+}
+
+/*
+ * Copy and consume bytes from the front of the buffer
+ *
+ * @param length [Integer] Number of bytes
+ * @return [String] Copy of the bytes
+ */
+static VALUE byte_buffer_take(VALUE self, VALUE arg_length)
+{
+  long read_index = 0;
+  long length = NUM2LONG(arg_length);
+  volatile VALUE buffer = byte_buffer_state(self, &read_index);
+  volatile VALUE result = Qnil;
+
+  byte_buffer_check_range(0, length, RSTRING_LEN(buffer) - read_index);
+  result = rb_str_new(RSTRING_PTR(buffer) + read_index, length);
+  byte_buffer_advance(self, buffer, read_index, length);
+  return result;
+}
+
+void Init_byte_buffer(void)
+{
+  id_ivar_buffer = rb_intern("@buffer");
+  id_ivar_read_index = rb_intern("@read_index");
+
+  mCosmos = rb_define_module("Cosmos");
+
+  cByteBuffer = rb_define_class_under(mCosmos, "ByteBuffer", rb_cObject);
+  rb_define_method(cByteBuffer, "<<", byte_buffer_append, 1);
+  rb_define_method(cByteBuffer, "peek", byte_buffer_peek, 1);
+  rb_define_method(cByteBuffer, "find", byte_buffer_find, -1);
+  rb_define_method(cByteBuffer, "consume", byte_buffer_consume, 1);
+  rb_define_method(cByteBuffer, "slice", byte_buffer_slice, -1);
+  rb_define_method(cByteBuffer, "take", byte_buffer_take, 1);
+}
@@ -0,0 +1,223 @@
+/*
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+*/
+
+#include "ruby.h"
+#include "stdio.h"
+#include "string.h"
+#include "stdlib.h"
+#include "fcntl.h"
+#include "sys/stat.h"
+#include "unistd.h"
+#ifdef HAVE_SYS_MMAN_H
+#include "sys/mman.h"
+#endif
+
+VALUE mCosmos = Qnil;
+VALUE cColumnLogReader = Qnil;
+
+static ID id_ivar_filename = 0;
+
+/* Must match COSMOS5_COLUMN_TYPES in PacketLogConstants */
+enum
+{
+  COLUMN_INT8,
+  COLUMN_UINT8,
+  COLUMN_INT16,
+  COLUMN_UINT16,
+  COLUMN_INT32,
+  COLUMN_UINT32,
+  COLUMN_INT64,
+  COLUMN_UINT64,
+  COLUMN_FLOAT32,
+  COLUMN_FLOAT64,
+  COLUMN_TYPE_COUNT
+};
+
+static const char *column_type_names[COLUMN_TYPE_COUNT] = {
+    "INT8", "UINT8", "INT16", "UINT16", "INT32", "UINT32", "INT64", "UINT64", "FLOAT32", "FLOAT64"};
+static const long column_type_sizes[COLUMN_TYPE_COUNT] = {1, 1, 2, 2, 4, 4, 8, 8, 4, 8};
+
+/* Columns are always little endian */
+static unsigned long long read_le(const unsigned char *data, long size)
+{
+  unsigned long long value = 0;
+  long index = 0;
+  for (index = size - 1; index >= 0; index--)
+  {
+    value = (value << 8) | (unsigned long long)data[index];
+  }
+  return value;
+}
+
+static VALUE decode_value(int type, const unsigned char *data)
+{
+  unsigned long long value = read_le(data, column_type_sizes[type]);
+  union
+  {
+    unsigned int u;
+    float f;
+  } float32;
+  union
+  {
+    unsigned long long u;
+    double d;
+  } float64;
+
+  switch (type)
+  {
+  case COLUMN_INT8:
+    return INT2FIX((signed char)value);
+  case COLUMN_UINT8:
+    return INT2FIX((unsigned char)value);
+  case COLUMN_INT16:
+    return INT2FIX((short)value);
+  case COLUMN_UINT16:
+    return INT2FIX((unsigned short)value);
+  case COLUMN_INT32:
+    return INT2NUM((int)value);
+  case COLUMN_UINT32:
+    return UINT2NUM((unsigned int)value);
+  case COLUMN_INT64:
+    return LL2NUM((long long)value);
+  case COLUMN_UINT64:
+    return ULL2NUM(value);
+  case COLUMN_FLOAT32:
+    float32.u = (unsigned int)value;
+    return rb_float_new((double)float32.f);
+  default:
+    float64.u = value;
+    return rb_float_new(float64.d);
+  }
+}
+
+/*
+ * Read values from a column by memory mapping only the pages which hold them
+ */
+static VALUE column_log_reader_read_values(VALUE self, VALUE arg_offset, VALUE arg_type, VALUE arg_count)
+{
+  volatile VALUE filename = rb_ivar_get(self, id_ivar_filename);
+  volatile VALUE result = Qnil;
+  long long offset = NUM2LL(arg_offset);
+  long count = NUM2LONG(arg_count);
+  long size = 0;
+  long length = 0;
+  long index = 0;
+  int type = 0;
+  int fd = -1;
+  struct stat file_stat;
+  const unsigned char *values = NULL;
+  unsigned char *data = NULL;
+  long long map_offset = 0;
+  long map_length = 0;
+
+  StringValue(arg_type);
+  for (type = 0; type < COLUMN_TYPE_COUNT; type++)
+  {
+    if ((RSTRING_LEN(arg_type) == (long)strlen(column_type_names[type])) &&
+        (memcmp(RSTRING_PTR(arg_type), column_type_names[type], RSTRING_LEN(arg_type)) == 0))
+    {
+      break;
+    }
+  }
+  if (type == COLUMN_TYPE_COUNT)
+  {
+    rb_raise(rb_eRuntimeError, "Unknown column type %s", StringValueCStr(arg_type));
+  }
+  if (count <= 0)
+  {
+    return rb_ary_new();
+  }
+  size = column_type_sizes[type];
+  length = count * size;
+
+  FilePathValue(filename);
+  fd = open(StringValueCStr(filename), O_RDONLY);
+  if (fd < 0)
+  {
+    rb_sys_fail(StringValueCStr(filename));
+  }
+  if (fstat(fd, &file_stat) != 0)
+  {
+    close(fd);
+    rb_sys_fail(StringValueCStr(filename));
+  }
+  if ((offset < 0) || ((offset + length) > (long long)file_stat.st_size))
+  {
+    close(fd);
+    rb_raise(rb_eRuntimeError, "Column data truncated");
+  }
+
+#ifdef HAVE_SYS_MMAN_H
+  /* mmap offsets must be page aligned */
+  map_offset = offset - (offset % sysconf(_SC_PAGESIZE));
+  map_length = (long)(offset - map_offset) + length;
+  data = (unsigned char *)mmap(NULL, (size_t)map_length, PROT_READ, MAP_PRIVATE, fd, (off_t)map_offset);
+  if (data == (unsigned char *)MAP_FAILED)
+  {
+    close(fd);
+    rb_sys_fail(StringValueCStr(filename));
+  }
+#ifdef MADV_SEQUENTIAL
+  madvise(data, (size_t)map_length, MADV_SEQUENTIAL);
+#endif
+#else
+  map_offset = offset;
+  map_length = length;
+  data = (unsigned char *)malloc((size_t)length);
+  if (data == NULL)
+  {
+    close(fd);
+    rb_raise(rb_eNoMemError, "Unable to allocate %ld bytes", length);
+  }
+  if ((lseek(fd, (off_t)offset, SEEK_SET) < 0) || (read(fd, data, (size_t)length) != length))
+  {
+    free(data);
+    close(fd);
+    rb_sys_fail(StringValueCStr(filename));
+  }
+#endif
+  close(fd);
+
+  values = data + (offset - map_offset);
+  result = rb_ary_new_capa(count);
+  for (index = 0; index < count; index++)
+  {
+    rb_ary_push(result, decode_value(type, values + (index * size)));
+  }
+
+#ifdef HAVE_SYS_MMAN_H
+  munmap(data, (size_t)map_length);
+#else
+  free(data);
+#endif
+  return result;
+}
+
+/*
+ * Initialize methods for ColumnLogReader
+ */
+void Init_column_log_reader(void)
+{
+  id_ivar_filename = rb_intern("@filename");
+
+  mCosmos = rb_define_module("Cosmos");
+
+  cColumnLogReader = rb_define_class_under(mCosmos, "ColumnLogReader", rb_cObject);
+  rb_define_method(cColumnLogReader, "read_values", column_log_reader_read_values, 3);
+}
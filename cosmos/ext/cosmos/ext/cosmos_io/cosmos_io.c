@@ -28,6 +28,7 @@ static const int endianness_check = 1;
 VALUE mCosmosIO = Qnil;
 
 static ID id_method_read = 0;
+static ID id_LITTLE_ENDIAN = 0;
 
 /* Reads a length field and then return the String resulting from reading the
  * number of bytes the length field indicates
@@ -144,13 +145,146 @@ static VALUE read_length_bytes(int argc, VALUE *argv, VALUE self)
   return return_value;
 }
 
+/*
+ * Read an unsigned length field of 1, 2, 4 or 8 bytes
+ */
+static unsigned long long read_length_field(const unsigned char *data, long length_num_bytes, int little_endian)
+{
+  unsigned long long value = 0;
+  long index = 0;
+
+  if (little_endian)
+  {
+    for (index = length_num_bytes - 1; index >= 0; index--)
+    {
+      value = (value << 8) | data[index];
+    }
+  }
+  else
+  {
+    for (index = 0; index < length_num_bytes; index++)
+    {
+      value = (value << 8) | data[index];
+    }
+  }
+  return value;
+}
+
+/* Parses consecutive length fields each followed by the number of bytes the
+ * length field indicates. Nothing is copied, the offset and length of each
+ * field's bytes are returned so the caller can slice only what it needs.
+ * Parsing stops at the first field which isn't complete.
+ *
+ * For example:
+ *   data = "\x02\x01\x02\x01\x03\x05"
+ *   CosmosIO.read_length_fields(data, 0, 1)
+ *   # returns [1, 2, 4, 1] because the first field's two bytes start at
+ *   # index 1 and the second field's one byte starts at index 4. The last
+ *   # field is incomplete.
+ *
+ * @param data [String] Data to parse
+ * @param offset [Integer] Index of the first length field in data
+ * @param length_num_bytes [Integer] Number of bytes in each length field.
+ *   Must be 1, 2, 4 or 8.
+ * @param count [Integer|nil] Maximum number of fields to parse or nil to
+ *   parse every complete field
+ * @param endianness [Symbol] :BIG_ENDIAN or :LITTLE_ENDIAN length fields
+ * @param max_length [Integer|nil] Maximum allowed value of a length field
+ * @return [Array<Integer>] Offset in data followed by the length of the
+ *   bytes of each complete field
+ */
+static VALUE read_length_fields(int argc, VALUE *argv, VALUE self)
+{
+  volatile VALUE data = Qnil;
+  volatile VALUE param_count = Qnil;
+  volatile VALUE param_endianness = Qnil;
+  volatile VALUE param_max_length = Qnil;
+  volatile VALUE fields = rb_ary_new();
+  long offset = 0;
+  long length = 0;
+  long length_num_bytes = 0;
+  long count = -1;
+  long num_fields = 0;
+  int little_endian = 0;
+  unsigned long long max_length = 0;
+  unsigned long long field_length = 0;
+  const unsigned char *buffer = NULL;
+
+  switch (argc)
+  {
+  case 6:
+    param_max_length = argv[5];
+    /* fall through */
+  case 5:
+    param_endianness = argv[4];
+    /* fall through */
+  case 4:
+    param_count = argv[3];
+    /* fall through */
+  case 3:
+    data = argv[0];
+    offset = NUM2LONG(argv[1]);
+    length_num_bytes = NUM2LONG(argv[2]);
+    break;
+  default:
+    /* Invalid number of arguments given */
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 3..6)", argc);
+    break;
+  }
+
+  Check_Type(data, T_STRING);
+  length = RSTRING_LEN(data);
+  if ((offset < 0) || (offset > length))
+  {
+    rb_raise(rb_eIndexError, "offset %ld outside of data length %ld", offset, length);
+  }
+  if ((length_num_bytes != 1) && (length_num_bytes != 2) && (length_num_bytes != 4) && (length_num_bytes != 8))
+  {
+    rb_raise(rb_eArgError, "Unsupported length field size: %ld", length_num_bytes);
+  }
+  if (RTEST(param_count))
+  {
+    count = NUM2LONG(param_count);
+  }
+  little_endian = (param_endianness == ID2SYM(id_LITTLE_ENDIAN));
+  if (RTEST(param_max_length))
+  {
+    max_length = NUM2ULL(param_max_length);
+  }
+
+  buffer = (const unsigned char *)RSTRING_PTR(data);
+  while (((count < 0) || (num_fields < count)) && ((length - offset) >= length_num_bytes))
+  {
+    field_length = read_length_field(buffer + offset, length_num_bytes, little_endian);
+    if (RTEST(param_max_length) && (field_length > max_length))
+    {
+      rb_raise(rb_eRuntimeError, "Length value received larger than max_length: %llu > %llu", field_length, max_length);
+    }
+
+    offset += length_num_bytes;
+    if (field_length > (unsigned long long)(length - offset))
+    {
+      break;
+    }
+
+    rb_ary_push(fields, LONG2NUM(offset));
+    rb_ary_push(fields, LONG2NUM((long)field_length));
+    offset += (long)field_length;
+    num_fields++;
+  }
+
+  return fields;
+}
+
 /*
  * Initialize methods for CosmosIO
  */
 void Init_cosmos_io(void)
 {
   id_method_read = rb_intern("read");
+  id_LITTLE_ENDIAN = rb_intern("LITTLE_ENDIAN");
 
   mCosmosIO = rb_define_module("CosmosIO");
   rb_define_method(mCosmosIO, "read_length_bytes", read_length_bytes, -1);
+  rb_define_singleton_method(mCosmosIO, "read_length_fields", read_length_fields, -1);
 }
@@ -19,6 +19,12 @@
 
 #include "ruby.h"
 #include "stdio.h"
+#include "string.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CRC_PCLMUL 1
+#include <immintrin.h>
+#endif
 
 VALUE mCosmos;
 VALUE cCrc;
@@ -26,10 +32,38 @@ VALUE cCrc16;
 VALUE cCrc32;
 VALUE cCrc64;
 
+static ID id_ivar_poly = 0;
 static ID id_ivar_seed = 0;
 static ID id_ivar_xor = 0;
 static ID id_ivar_reflect = 0;
-static ID id_ivar_table = 0;
+static ID id_ivar_bit_size = 0;
+static ID id_ivar_engine = 0;
+
+/* Polynomial with precomputed carry-less multiply folding constants */
+#define CRC32_POLY 0x04C11DB7
+
+/*
+ * Everything needed to calculate a CRC. Built once by build_engine and kept
+ * in the @engine String so calc reads a single ivar.
+ *
+ * In reflect mode the tables are bit reversed so the CRC register is kept
+ * bit reversed and no per byte reversal is needed. Tables 1 to 7 are the
+ * slicing-by-8 tables for 32 and 64 bit CRCs.
+ */
+typedef struct
+{
+  int bit_size;
+  int reflect;
+  int xor;
+  int pclmul;
+  unsigned long long seed;
+  union
+  {
+    unsigned short table16[256];
+    unsigned int table32[8][256];
+    unsigned long long table64[8][256];
+  } tables;
+} crc_engine_t;
 
 static const unsigned char BIT_REVERSE_TABLE[] =
     {
@@ -50,14 +84,6 @@ static const unsigned char BIT_REVERSE_TABLE[] =
         0x07, 0x87, 0x47, 0xC7, 0x27, 0xA7, 0x67, 0xE7, 0x17, 0x97, 0x57, 0xD7, 0x37, 0xB7, 0x77, 0xF7,
         0x0F, 0x8F, 0x4F, 0xCF, 0x2F, 0xAF, 0x6F, 0xEF, 0x1F, 0x9F, 0x5F, 0xDF, 0x3F, 0xBF, 0x7F, 0xFF};
 
-/*
- * Bit Reverse an unsigned char
- */
-static unsigned char bit_reverse_8(unsigned char value)
-{
-  return BIT_REVERSE_TABLE[value];
-}
-
 /*
  * Bit Reverse an unsigned short
  */
@@ -94,234 +120,529 @@ static unsigned long long bit_reverse_64(unsigned long long value)
 }
 
 /*
- * Calculate a 16-bit CRC
+ * Get the engine built by build_engine
  */
-static VALUE crc16_calculate(int argc, VALUE *argv, VALUE self)
+static crc_engine_t *crc_engine(VALUE self)
 {
-  volatile VALUE param_data = Qnil;
-  volatile VALUE param_seed = Qnil;
-  unsigned char *data = NULL;
-  unsigned short *table = NULL;
-  int i = 0;
-  long length = 0;
-  unsigned short crc = 0;
+  volatile VALUE engine = rb_ivar_get(self, id_ivar_engine);
 
-  switch (argc)
+  if (!RB_TYPE_P(engine, T_STRING) || (RSTRING_LEN(engine) != (long)sizeof(crc_engine_t)))
   {
-  case 1:
-    Check_Type(argv[0], T_STRING);
-    param_data = argv[0];
-    param_seed = rb_ivar_get(self, id_ivar_seed);
-    break;
-  case 2:
-    Check_Type(argv[0], T_STRING);
-    param_data = argv[0];
-    if (argv[1] == Qnil)
+    rb_raise(rb_eRuntimeError, "Crc engine not built");
+  }
+  return (crc_engine_t *)RSTRING_PTR(engine);
+}
+
+/*
+ * Convert a CRC value to and from the register used by the engine
+ */
+static unsigned long long crc_reflect_value(crc_engine_t *engine, unsigned long long value)
+{
+  if (!engine->reflect)
+  {
+    return value;
+  }
+  switch (engine->bit_size)
+  {
+  case 16:
+    return bit_reverse_16((unsigned short)value);
+  case 32:
+    return bit_reverse_32((unsigned int)value);
+  default:
+    return bit_reverse_64(value);
+  }
+}
+
+static unsigned short crc16_update(crc_engine_t *engine, unsigned short crc, const unsigned char *data, long length)
+{
+  const unsigned short *table = engine->tables.table16;
+  long i = 0;
+
+  if (engine->reflect)
+  {
+    for (i = 0; i < length; i++)
     {
-      param_seed = rb_ivar_get(self, id_ivar_seed);
+      crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
     }
-    else
+  }
+  else
+  {
+    for (i = 0; i < length; i++)
     {
-      param_seed = argv[1];
+      crc = (crc << 8) ^ table[(crc >> 8) ^ data[i]];
     }
-    break;
-  default:
-    /* Invalid number of arguments given */
-    rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
-    break;
-  };
+  }
+  return crc;
+}
 
-  crc = NUM2UINT(param_seed);
-  data = (unsigned char *)RSTRING_PTR(param_data);
-  length = RSTRING_LEN(param_data);
-  table = (unsigned short *)RSTRING_PTR(rb_ivar_get(self, id_ivar_table));
+#ifdef CRC_PCLMUL
+/*
+ * Reflected CRC-32 by folding 64 bytes at a time with carry-less multiplies.
+ * Length must be at least 64 and a multiple of 16. The constants are for
+ * polynomial 0x04C11DB7 from "Fast CRC Computation for Generic Polynomials
+ * Using PCLMULQDQ Instruction" by Intel.
+ */
+__attribute__((target("pclmul,sse4.1"))) static unsigned int crc32_pclmul(unsigned int crc, const unsigned char *data, long length)
+{
+  const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+  const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+  const __m128i k5k0 = _mm_set_epi64x(0x0000000000LL, 0x0163cd6124LL);
+  const __m128i poly = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+  const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+  x1 = _mm_loadu_si128((const __m128i *)(data + 0x00));
+  x2 = _mm_loadu_si128((const __m128i *)(data + 0x10));
+  x3 = _mm_loadu_si128((const __m128i *)(data + 0x20));
+  x4 = _mm_loadu_si128((const __m128i *)(data + 0x30));
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+  data += 64;
+  length -= 64;
+
+  /* Fold four blocks in parallel */
+  x0 = k1k2;
+  while (length >= 64)
+  {
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+    x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *)(data + 0x00)));
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i *)(data + 0x10)));
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i *)(data + 0x20)));
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i *)(data + 0x30)));
+    data += 64;
+    length -= 64;
+  }
 
-  if (RTEST(rb_ivar_get(self, id_ivar_reflect)))
+  /* Fold into 128 bits */
+  x0 = k3k4;
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+  /* Fold the remaining 16 byte blocks */
+  while (length >= 16)
   {
-    for (i = 0; i < length; i++)
+    x2 = _mm_loadu_si128((const __m128i *)data);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    data += 16;
+    length -= 16;
+  }
+
+  /* Fold 128 bits to 64 bits */
+  x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+  x0 = k5k0;
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, mask);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  /* Barrett reduce to 32 bits */
+  x0 = poly;
+  x2 = _mm_and_si128(x1, mask);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+  x2 = _mm_and_si128(x2, mask);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  return (unsigned int)_mm_extract_epi32(x1, 1);
+}
+#endif
+
+static unsigned int crc32_update(crc_engine_t *engine, unsigned int crc, const unsigned char *data, long length)
+{
+  const unsigned int(*table)[256] = engine->tables.table32;
+  long blocks = 0;
+
+  if (engine->reflect)
+  {
+#ifdef CRC_PCLMUL
+    if (engine->pclmul && (length >= 64))
     {
-      crc = (crc << 8) ^ table[(crc >> 8) ^ bit_reverse_8(data[i])];
+      blocks = length & ~15L;
+      crc = crc32_pclmul(crc, data, blocks);
+      data += blocks;
+      length -= blocks;
     }
-
-    if (RTEST(rb_ivar_get(self, id_ivar_xor)))
+#endif
+    for (; length >= 8; data += 8, length -= 8)
     {
-      return UINT2NUM(bit_reverse_16(crc ^ 0xFFFF));
+      crc ^= (unsigned int)data[0] | ((unsigned int)data[1] << 8) |
+             ((unsigned int)data[2] << 16) | ((unsigned int)data[3] << 24);
+      crc = table[7][crc & 0xFF] ^ table[6][(crc >> 8) & 0xFF] ^
+            table[5][(crc >> 16) & 0xFF] ^ table[4][crc >> 24] ^
+            table[3][data[4]] ^ table[2][data[5]] ^ table[1][data[6]] ^ table[0][data[7]];
     }
-    else
+    for (; length > 0; data++, length--)
     {
-      return UINT2NUM(bit_reverse_16(crc));
+      crc = (crc >> 8) ^ table[0][(crc ^ *data) & 0xFF];
     }
   }
   else
   {
-    for (i = 0; i < length; i++)
+    for (; length >= 8; data += 8, length -= 8)
     {
-      crc = (crc << 8) ^ table[(crc >> 8) ^ data[i]];
+      crc ^= ((unsigned int)data[0] << 24) | ((unsigned int)data[1] << 16) |
+             ((unsigned int)data[2] << 8) | (unsigned int)data[3];
+      crc = table[7][crc >> 24] ^ table[6][(crc >> 16) & 0xFF] ^
+            table[5][(crc >> 8) & 0xFF] ^ table[4][crc & 0xFF] ^
+            table[3][data[4]] ^ table[2][data[5]] ^ table[1][data[6]] ^ table[0][data[7]];
+    }
+    for (; length > 0; data++, length--)
+    {
+      crc = (crc << 8) ^ table[0][(crc >> 24) ^ *data];
     }
+  }
+  return crc;
+}
+
+static unsigned long long crc64_update(crc_engine_t *engine, unsigned long long crc, const unsigned char *data, long length)
+{
+  const unsigned long long(*table)[256] = engine->tables.table64;
+  unsigned long long block = 0;
+  int i = 0;
 
-    if (RTEST(rb_ivar_get(self, id_ivar_xor)))
+  if (engine->reflect)
+  {
+    for (; length >= 8; data += 8, length -= 8)
     {
-      return UINT2NUM(crc ^ 0xFFFF);
+      block = 0;
+      for (i = 7; i >= 0; i--)
+      {
+        block = (block << 8) | data[i];
+      }
+      crc ^= block;
+      crc = table[7][crc & 0xFF] ^ table[6][(crc >> 8) & 0xFF] ^
+            table[5][(crc >> 16) & 0xFF] ^ table[4][(crc >> 24) & 0xFF] ^
+            table[3][(crc >> 32) & 0xFF] ^ table[2][(crc >> 40) & 0xFF] ^
+            table[1][(crc >> 48) & 0xFF] ^ table[0][crc >> 56];
     }
-    else
+    for (; length > 0; data++, length--)
     {
-      return UINT2NUM(crc);
+      crc = (crc >> 8) ^ table[0][(crc ^ *data) & 0xFF];
     }
   }
+  else
+  {
+    for (; length >= 8; data += 8, length -= 8)
+    {
+      block = 0;
+      for (i = 0; i < 8; i++)
+      {
+        block = (block << 8) | data[i];
+      }
+      crc ^= block;
+      crc = table[7][crc >> 56] ^ table[6][(crc >> 48) & 0xFF] ^
+            table[5][(crc >> 40) & 0xFF] ^ table[4][(crc >> 32) & 0xFF] ^
+            table[3][(crc >> 24) & 0xFF] ^ table[2][(crc >> 16) & 0xFF] ^
+            table[1][(crc >> 8) & 0xFF] ^ table[0][crc & 0xFF];
+    }
+    for (; length > 0; data++, length--)
+    {
+      crc = (crc << 8) ^ table[0][(crc >> 56) ^ *data];
+    }
+  }
+  return crc;
 }
 
 /*
- * Calculate a 32-bit CRC
+ * Update a CRC register with more data
  */
-static VALUE crc32_calculate(int argc, VALUE *argv, VALUE self)
+static unsigned long long crc_update(crc_engine_t *engine, unsigned long long crc, const unsigned char *data, long length)
+{
+  switch (engine->bit_size)
+  {
+  case 16:
+    return crc16_update(engine, (unsigned short)crc, data, length);
+  case 32:
+    return crc32_update(engine, (unsigned int)crc, data, length);
+  default:
+    return crc64_update(engine, crc, data, length);
+  }
+}
+
+/*
+ * Convert a CRC register into the CRC value
+ */
+static VALUE crc_finish(crc_engine_t *engine, unsigned long long crc)
+{
+  unsigned long long mask = 0xFFFFFFFFFFFFFFFFULL >> (64 - engine->bit_size);
+
+  /* In reflect mode the register is already bit reversed */
+  if (engine->xor)
+  {
+    crc ^= mask;
+  }
+  return ULL2NUM(crc & mask);
+}
+
+/*
+ * Calculates the CRC across the data buffer using the optional seed
+ */
+static VALUE crc_calculate(int argc, VALUE *argv, VALUE self)
 {
   volatile VALUE param_data = Qnil;
-  volatile VALUE param_seed = Qnil;
-  unsigned char *data = NULL;
-  unsigned int *table = NULL;
-  int i = 0;
-  long length = 0;
-  unsigned int crc = 0;
+  crc_engine_t *engine = crc_engine(self);
+  unsigned long long crc = engine->seed;
 
   switch (argc)
   {
   case 1:
     Check_Type(argv[0], T_STRING);
     param_data = argv[0];
-    param_seed = rb_ivar_get(self, id_ivar_seed);
     break;
   case 2:
     Check_Type(argv[0], T_STRING);
     param_data = argv[0];
-    if (argv[1] == Qnil)
-    {
-      param_seed = rb_ivar_get(self, id_ivar_seed);
-    }
-    else
+    if (argv[1] != Qnil)
     {
-      param_seed = argv[1];
+      crc = NUM2ULL(argv[1]);
     }
     break;
   default:
     /* Invalid number of arguments given */
     rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
     break;
-  };
+  }
 
-  crc = NUM2UINT(param_seed);
-  data = (unsigned char *)RSTRING_PTR(param_data);
-  length = RSTRING_LEN(param_data);
-  table = (unsigned int *)RSTRING_PTR(rb_ivar_get(self, id_ivar_table));
+  crc = crc_update(engine, crc_reflect_value(engine, crc), (const unsigned char *)RSTRING_PTR(param_data), RSTRING_LEN(param_data));
+  return crc_finish(engine, crc);
+}
 
-  if (RTEST(rb_ivar_get(self, id_ivar_reflect)))
-  {
-    for (i = 0; i < length; i++)
-    {
-      crc = (crc << 8) ^ table[((crc >> 24) ^ bit_reverse_8(data[i])) & 0x000000FF];
-    }
+/*
+ * Get the data range to calculate across. Length defaults to the rest of
+ * the data when it is nil.
+ */
+static const unsigned char *crc_data_range(VALUE data, VALUE param_offset, VALUE param_length, long *length)
+{
+  long offset = 0;
+  long data_length = 0;
 
-    if (RTEST(rb_ivar_get(self, id_ivar_xor)))
-    {
-      return UINT2NUM(bit_reverse_32(crc ^ 0xFFFFFFFF));
-    }
-    else
-    {
-      return UINT2NUM(bit_reverse_32(crc));
-    }
+  Check_Type(data, T_STRING);
+  data_length = RSTRING_LEN(data);
+  offset = NUM2LONG(param_offset);
+  if (param_length == Qnil)
+  {
+    *length = data_length - offset;
   }
   else
   {
-    for (i = 0; i < length; i++)
-    {
-      crc = (crc << 8) ^ table[((crc >> 24) ^ data[i]) & 0x000000FF];
-    }
+    *length = NUM2LONG(param_length);
+  }
 
-    if (RTEST(rb_ivar_get(self, id_ivar_xor)))
-    {
-      return UINT2NUM(crc ^ 0xFFFFFFFF);
-    }
-    else
-    {
-      return UINT2NUM(crc);
-    }
+  if ((offset < 0) || (*length < 0) || (offset > data_length) || (*length > (data_length - offset)))
+  {
+    rb_raise(rb_eIndexError, "Range %ld, %ld outside of the %ld bytes of data", offset, *length, data_length);
   }
+  return (const unsigned char *)RSTRING_PTR(data) + offset;
 }
 
 /*
- * Calculate a 64-bit CRC
+ * Continues a CRC calculation across more data
+ *
+ * @param state [Integer|nil] CRC state returned by a previous update. Pass
+ *   nil to start with the default seed.
+ * @param data [String] String buffer of binary data
+ * @param offset [Integer] Index of the first byte
+ * @param length [Integer|nil] Number of bytes. Defaults to the rest of data.
+ * @return [Integer] The updated CRC state
  */
-static VALUE crc64_calculate(int argc, VALUE *argv, VALUE self)
+static VALUE crc_update_state(int argc, VALUE *argv, VALUE self)
 {
-  volatile VALUE param_data = Qnil;
-  volatile VALUE param_seed = Qnil;
-  unsigned char *data = NULL;
-  unsigned long long *table = NULL;
-  int i = 0;
+  volatile VALUE param_offset = INT2FIX(0);
+  volatile VALUE param_length = Qnil;
+  crc_engine_t *engine = crc_engine(self);
+  unsigned long long crc = engine->seed;
+  const unsigned char *data = NULL;
   long length = 0;
-  unsigned long long crc = 0;
 
   switch (argc)
   {
-  case 1:
-    Check_Type(argv[0], T_STRING);
-    param_data = argv[0];
-    param_seed = rb_ivar_get(self, id_ivar_seed);
-    break;
   case 2:
-    Check_Type(argv[0], T_STRING);
-    param_data = argv[0];
-    if (argv[1] == Qnil)
-    {
-      param_seed = rb_ivar_get(self, id_ivar_seed);
-    }
-    else
-    {
-      param_seed = argv[1];
-    }
+    break;
+  case 3:
+    param_offset = argv[2];
+    break;
+  case 4:
+    param_offset = argv[2];
+    param_length = argv[3];
     break;
   default:
     /* Invalid number of arguments given */
-    rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 2..4)", argc);
     break;
-  };
+  }
+
+  if (argv[0] != Qnil)
+  {
+    crc = NUM2ULL(argv[0]);
+  }
+  data = crc_data_range(argv[1], param_offset, param_length, &length);
+
+  crc = crc_update(engine, crc_reflect_value(engine, crc), data, length);
+  return ULL2NUM(crc_reflect_value(engine, crc));
+}
+
+/*
+ * Converts a CRC state into the CRC value
+ *
+ * @param state [Integer] CRC state returned by update
+ * @return [Integer] The CRC value
+ */
+static VALUE crc_finalize(VALUE self, VALUE state)
+{
+  crc_engine_t *engine = crc_engine(self);
+
+  return crc_finish(engine, crc_reflect_value(engine, NUM2ULL(state)));
+}
 
-  crc = NUM2ULL(param_seed);
-  data = (unsigned char *)RSTRING_PTR(param_data);
-  length = RSTRING_LEN(param_data);
-  table = (unsigned long long *)RSTRING_PTR(rb_ivar_get(self, id_ivar_table));
+/*
+ * Calculates the CRC across part of the data buffer without copying it
+ *
+ * @param data [String] String buffer of binary data
+ * @param offset [Integer] Index of the first byte
+ * @param length [Integer] Number of bytes
+ * @return [Integer] The CRC value
+ */
+static VALUE crc_calculate_range(VALUE self, VALUE param_data, VALUE param_offset, VALUE param_length)
+{
+  crc_engine_t *engine = crc_engine(self);
+  const unsigned char *data = NULL;
+  long length = 0;
 
-  if (RTEST(rb_ivar_get(self, id_ivar_reflect)))
+  data = crc_data_range(param_data, param_offset, param_length, &length);
+  return crc_finish(engine, crc_update(engine, crc_reflect_value(engine, engine->seed), data, length));
+}
+
+/*
+ * Build the lookup tables and cache the configuration in @engine
+ */
+static VALUE crc_build_engine(VALUE self)
+{
+  volatile VALUE engine_string = rb_str_new(NULL, sizeof(crc_engine_t));
+  crc_engine_t *engine = (crc_engine_t *)RSTRING_PTR(engine_string);
+  unsigned long long poly = NUM2ULL(rb_ivar_get(self, id_ivar_poly));
+  unsigned long long top_bit = 0;
+  unsigned long long mask = 0;
+  unsigned long long crc = 0;
+  unsigned long long table[256];
+  int index = 0;
+  int slice = 0;
+  int bit = 0;
+
+  memset(engine, 0, sizeof(crc_engine_t));
+  engine->bit_size = NUM2INT(rb_ivar_get(self, id_ivar_bit_size));
+  if ((engine->bit_size != 16) && (engine->bit_size != 32) && (engine->bit_size != 64))
   {
-    for (i = 0; i < length; i++)
+    rb_raise(rb_eArgError, "Unsupported CRC bit size %d", engine->bit_size);
+  }
+  engine->reflect = RTEST(rb_ivar_get(self, id_ivar_reflect));
+  engine->xor = RTEST(rb_ivar_get(self, id_ivar_xor));
+  engine->seed = NUM2ULL(rb_ivar_get(self, id_ivar_seed));
+  top_bit = 1ULL << (engine->bit_size - 1);
+  mask = 0xFFFFFFFFFFFFFFFFULL >> (64 - engine->bit_size);
+
+  /* Byte at a time table in the register domain */
+  for (index = 0; index < 256; index++)
+  {
+    crc = (unsigned long long)index << (engine->bit_size - 8);
+    for (bit = 0; bit < 8; bit++)
     {
-      crc = (crc << 8) ^ table[((crc >> 56) ^ bit_reverse_8(data[i])) & 0x00000000000000FFULL];
+      if (crc & top_bit)
+      {
+        crc = (crc << 1) ^ poly;
+      }
+      else
+      {
+        crc = crc << 1;
+      }
     }
-
-    if (RTEST(rb_ivar_get(self, id_ivar_xor)))
+    crc &= mask;
+    if (engine->reflect)
     {
-      return ULL2NUM(bit_reverse_64(crc ^ 0xFFFFFFFFFFFFFFFFULL));
+      crc = crc_reflect_value(engine, crc);
+      table[BIT_REVERSE_TABLE[index]] = crc;
     }
     else
     {
-      return ULL2NUM(bit_reverse_64(crc));
+      table[index] = crc;
     }
   }
-  else
+
+  switch (engine->bit_size)
   {
-    for (i = 0; i < length; i++)
+  case 16:
+    for (index = 0; index < 256; index++)
     {
-      crc = (crc << 8) ^ table[((crc >> 56) ^ data[i]) & 0x00000000000000FFULL];
+      engine->tables.table16[index] = (unsigned short)table[index];
     }
-
-    if (RTEST(rb_ivar_get(self, id_ivar_xor)))
+    break;
+  case 32:
+    for (index = 0; index < 256; index++)
     {
-      return ULL2NUM(crc ^ 0xFFFFFFFFFFFFFFFFULL);
+      engine->tables.table32[0][index] = (unsigned int)table[index];
     }
-    else
+    for (slice = 1; slice < 8; slice++)
     {
-      return ULL2NUM(crc);
+      for (index = 0; index < 256; index++)
+      {
+        crc = engine->tables.table32[slice - 1][index];
+        if (engine->reflect)
+        {
+          crc = (crc >> 8) ^ engine->tables.table32[0][crc & 0xFF];
+        }
+        else
+        {
+          crc = ((crc << 8) & mask) ^ engine->tables.table32[0][crc >> 24];
+        }
+        engine->tables.table32[slice][index] = (unsigned int)crc;
+      }
     }
+#ifdef CRC_PCLMUL
+    engine->pclmul = engine->reflect && (poly == CRC32_POLY) &&
+                     __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+#endif
+    break;
+  default:
+    for (index = 0; index < 256; index++)
+    {
+      engine->tables.table64[0][index] = table[index];
+    }
+    for (slice = 1; slice < 8; slice++)
+    {
+      for (index = 0; index < 256; index++)
+      {
+        crc = engine->tables.table64[slice - 1][index];
+        if (engine->reflect)
+        {
+          crc = (crc >> 8) ^ engine->tables.table64[0][crc & 0xFF];
+        }
+        else
+        {
+          crc = (crc << 8) ^ engine->tables.table64[0][crc >> 56];
+        }
+        engine->tables.table64[slice][index] = crc;
+      }
+    }
+    break;
   }
+
+  rb_ivar_set(self, id_ivar_engine, engine_string);
+  return Qnil;
 }
 
 /*
@@ -329,21 +650,33 @@ static VALUE crc64_calculate(int argc, VALUE *argv, VALUE self)
  */
 void Init_crc()
 {
+  id_ivar_poly = rb_intern("@poly");
   id_ivar_seed = rb_intern("@seed");
   id_ivar_xor = rb_intern("@xor");
   id_ivar_reflect = rb_intern("@reflect");
-  id_ivar_table = rb_intern("@table");
+  id_ivar_bit_size = rb_intern("@bit_size");
+  id_ivar_engine = rb_intern("@engine");
 
   mCosmos = rb_define_module("Cosmos");
 
   cCrc = rb_define_class_under(mCosmos, "Crc", rb_cObject);
+  rb_define_protected_method(cCrc, "build_engine", crc_build_engine, 0);
 
   cCrc16 = rb_define_class_under(mCosmos, "Crc16", cCrc);
-  rb_define_method(cCrc16, "calc", crc16_calculate, -1);
+  rb_define_method(cCrc16, "calc", crc_calculate, -1);
+  rb_define_method(cCrc16, "update", crc_update_state, -1);
+  rb_define_method(cCrc16, "finalize", crc_finalize, 1);
+  rb_define_method(cCrc16, "calc_range", crc_calculate_range, 3);
 
   cCrc32 = rb_define_class_under(mCosmos, "Crc32", cCrc);
-  rb_define_method(cCrc32, "calc", crc32_calculate, -1);
+  rb_define_method(cCrc32, "calc", crc_calculate, -1);
+  rb_define_method(cCrc32, "update", crc_update_state, -1);
+  rb_define_method(cCrc32, "finalize", crc_finalize, 1);
+  rb_define_method(cCrc32, "calc_range", crc_calculate_range, 3);
 
   cCrc64 = rb_define_class_under(mCosmos, "Crc64", cCrc);
-  rb_define_method(cCrc64, "calc", crc64_calculate, -1);
+  rb_define_method(cCrc64, "calc", crc_calculate, -1);
+  rb_define_method(cCrc64, "update", crc_update_state, -1);
+  rb_define_method(cCrc64, "finalize", crc_finalize, 1);
+  rb_define_method(cCrc64, "calc_range", crc_calculate_range, 3);
 }
@@ -0,0 +1,209 @@
+/*
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+*/
+
+#include "ruby.h"
+#include "stdio.h"
+#include "string.h"
+
+VALUE mCosmos = Qnil;
+VALUE cHistogram = Qnil;
+
+static ID id_ivar_counts = 0;
+
+#define SUB_BUCKET_BITS 5
+#define SUB_BUCKET_COUNT (1 << SUB_BUCKET_BITS)
+#define MAX_NSEC ((1ULL << 42) - 1)
+#define BUCKET_COUNT (((42 - SUB_BUCKET_BITS) * SUB_BUCKET_COUNT) + SUB_BUCKET_COUNT)
+#define COUNT_INDEX 0
+#define MAX_INDEX 1
+#define BUCKET_OFFSET 2
+#define NSEC_PER_SECOND 1000000000.0
+
+/*
+ * Get the counts array after verifying it is the expected size
+ */
+static unsigned long long *histogram_counts(VALUE self)
+{
+  volatile VALUE counts = rb_ivar_get(self, id_ivar_counts);
+  Check_Type(counts, T_STRING);
+  if (RSTRING_LEN(counts) != ((BUCKET_COUNT + BUCKET_OFFSET) * 8))
+  {
+    rb_raise(rb_eRuntimeError, "Histogram counts corrupted");
+  }
+  return (unsigned long long *)RSTRING_PTR(counts);
+}
+
+/*
+ * Index of the bucket holding a value in nanoseconds
+ */
+static long bucket_index(unsigned long long nsec)
+{
+  int shift = 0;
+  if (nsec < (SUB_BUCKET_COUNT << 1))
+  {
+    return (long)nsec;
+  }
+  /* 64 - clz is the bit length of the value */
+  shift = (64 - __builtin_clzll(nsec)) - SUB_BUCKET_BITS - 1;
+  return (long)((shift * SUB_BUCKET_COUNT) + (nsec >> shift));
+}
+
+/*
+ * Midpoint of a bucket in nanoseconds
+ */
+static double bucket_value(long index)
+{
+  int shift = 0;
+  if (index < (SUB_BUCKET_COUNT << 1))
+  {
+    return (double)index;
+  }
+  shift = (int)(index >> SUB_BUCKET_BITS) - 1;
+  return (double)((unsigned long long)(index - (shift * SUB_BUCKET_COUNT)) << shift) + ((double)(1ULL << shift) / 2.0);
+}
+
+/*
+ * Record a value in seconds
+ */
+static VALUE histogram_record(VALUE self, VALUE value)
+{
+  unsigned long long *counts = NULL;
+  double seconds = NUM2DBL(value);
+  unsigned long long nsec = 0;
+
+  if (seconds > 0.0)
+  {
+    if (seconds * NSEC_PER_SECOND >= (double)MAX_NSEC)
+    {
+      nsec = MAX_NSEC;
+    }
+    else
+    {
+      nsec = (unsigned long long)(seconds * NSEC_PER_SECOND);
+    }
+  }
+
+  rb_str_modify(rb_ivar_get(self, id_ivar_counts));
+  counts = histogram_counts(self);
+  counts[BUCKET_OFFSET + bucket_index(nsec)] += 1;
+  counts[COUNT_INDEX] += 1;
+  if (nsec > counts[MAX_INDEX])
+  {
+    counts[MAX_INDEX] = nsec;
+  }
+  return Qnil;
+}
+
+/*
+ * Number of values recorded
+ */
+static VALUE histogram_count(VALUE self)
+{
+  return ULL2NUM(histogram_counts(self)[COUNT_INDEX]);
+}
+
+/*
+ * Largest value recorded in seconds
+ */
+static VALUE histogram_max(VALUE self)
+{
+  return rb_float_new((double)histogram_counts(self)[MAX_INDEX] / NSEC_PER_SECOND);
+}
+
+/*
+ * Value in seconds at the given percentile (0 to 100)
+ */
+static VALUE histogram_percentile(VALUE self, VALUE percentile)
+{
+  unsigned long long *counts = histogram_counts(self);
+  unsigned long long total = counts[COUNT_INDEX];
+  unsigned long long target = 0;
+  unsigned long long cumulative = 0;
+  double target_float = 0.0;
+  long index = 0;
+
+  if (total == 0)
+  {
+    return rb_float_new(0.0);
+  }
+
+  target_float = (NUM2DBL(percentile) / 100.0) * (double)total;
+  target = (unsigned long long)target_float;
+  if ((double)target < target_float)
+  {
+    target += 1;
+  }
+  if (target < 1)
+  {
+    target = 1;
+  }
+
+  for (index = 0; index < BUCKET_COUNT; index++)
+  {
+    cumulative += counts[BUCKET_OFFSET + index];
+    if (cumulative >= target)
+    {
+      return rb_float_new(bucket_value(index) / NSEC_PER_SECOND);
+    }
+  }
+  return rb_float_new((double)counts[MAX_INDEX] / NSEC_PER_SECOND);
+}
+
+/*
+ * Clear all recorded values
+ */
+static VALUE histogram_reset(VALUE self)
+{
+  volatile VALUE counts = rb_ivar_get(self, id_ivar_counts);
+  rb_str_modify(counts);
+  memset(histogram_counts(self), 0, (BUCKET_COUNT + BUCKET_OFFSET) * 8);
+  return Qnil;
+}
+
+/*
+ * Copy the recorded values into a new Histogram and clear them. No Ruby code
+ * runs in between so values recorded by other threads are never lost.
+ */
+static VALUE histogram_snapshot_and_reset(VALUE self)
+{
+  volatile VALUE snapshot = rb_obj_alloc(cHistogram);
+  unsigned long long *counts = histogram_counts(self);
+
+  rb_ivar_set(snapshot, id_ivar_counts, rb_str_new((const char *)counts, (BUCKET_COUNT + BUCKET_OFFSET) * 8));
+  histogram_reset(self);
+  return snapshot;
+}
+
+/*
+ * Initialize methods for Histogram
+ */
+void Init_histogram(void)
+{
+  id_ivar_counts = rb_intern("@counts");
+
+  mCosmos = rb_define_module("Cosmos");
+
+  cHistogram = rb_define_class_under(mCosmos, "Histogram", rb_cObject);
+  rb_define_method(cHistogram, "record", histogram_record, 1);
+  rb_define_method(cHistogram, "count", histogram_count, 0);
+  rb_define_method(cHistogram, "max", histogram_max, 0);
+  rb_define_method(cHistogram, "percentile", histogram_percentile, 1);
+  rb_define_method(cHistogram, "reset", histogram_reset, 0);
+  rb_define_method(cHistogram, "snapshot_and_reset", histogram_snapshot_and_reset, 0);
+}
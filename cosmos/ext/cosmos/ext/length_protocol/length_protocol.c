@@ -0,0 +1,191 @@
+/*
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+*/
+
+#include "ruby.h"
+#include "stdio.h"
+#include "string.h"
+
+VALUE mCosmos = Qnil;
+VALUE cBurstProtocol = Qnil;
+VALUE cLengthProtocol = Qnil;
+
+static ID id_ivar_length_bit_offset = 0;
+static ID id_ivar_length_bit_size = 0;
+static ID id_ivar_length_value_offset = 0;
+static ID id_ivar_length_bytes_per_count = 0;
+static ID id_ivar_length_endianness = 0;
+static ID id_ivar_sync_pattern = 0;
+static ID id_ivar_max_length = 0;
+static ID id_LITTLE_ENDIAN = 0;
+
+/*
+ * Read an unsigned byte aligned length field
+ */
+static unsigned long long read_length(const unsigned char *data, long byte_size, int little_endian)
+{
+  unsigned long long value = 0;
+  long index = 0;
+
+  if (little_endian)
+  {
+    for (index = byte_size - 1; index >= 0; index--)
+    {
+      value = (value << 8) | data[index];
+    }
+  }
+  else
+  {
+    for (index = 0; index < byte_size; index++)
+    {
+      value = (value << 8) | data[index];
+    }
+  }
+  return value;
+}
+
+/*
+ * Find the lengths of the complete packets at the start of the data.
+ * Framing stops at the first packet which is incomplete, doesn't begin with
+ * the sync pattern, has a length larger than max_length or has a length too
+ * short to hold the length field. Those cases are left to
+ * reduce_to_single_packet which waits for data, resynchronizes or raises.
+ *
+ * Only byte aligned length fields of 8, 16, 32 or 64 bits are framed. An
+ * empty Array is returned for any other length field.
+ *
+ * @param data [String] Data to frame
+ * @param offset [Integer] Index of the first packet in data
+ * @return [Array<Integer>] Length of each complete packet in order
+ */
+static VALUE length_protocol_find_frames(int argc, VALUE *argv, VALUE self)
+{
+  volatile VALUE data = Qnil;
+  volatile VALUE sync_pattern = rb_ivar_get(self, id_ivar_sync_pattern);
+  volatile VALUE max_length = rb_ivar_get(self, id_ivar_max_length);
+  volatile VALUE frames = rb_ary_new();
+  long offset = 0;
+  long length = 0;
+  long bit_offset = NUM2LONG(rb_ivar_get(self, id_ivar_length_bit_offset));
+  long bit_size = NUM2LONG(rb_ivar_get(self, id_ivar_length_bit_size));
+  long long value_offset = NUM2LL(rb_ivar_get(self, id_ivar_length_value_offset));
+  long long bytes_per_count = NUM2LL(rb_ivar_get(self, id_ivar_length_bytes_per_count));
+  int little_endian = (rb_ivar_get(self, id_ivar_length_endianness) == ID2SYM(id_LITTLE_ENDIAN));
+  long byte_offset = bit_offset / 8;
+  long byte_size = bit_size / 8;
+  long bytes_needed = byte_offset + byte_size;
+  long sync_length = 0;
+  const unsigned char *buffer = NULL;
+  const char *sync_data = NULL;
+  unsigned long long count = 0;
+  unsigned long long max_count = 0;
+  long long packet_length = 0;
+
+  switch (argc)
+  {
+  case 1:
+    data = argv[0];
+    break;
+  case 2:
+    data = argv[0];
+    offset = NUM2LONG(argv[1]);
+    break;
+  default:
+    /* Invalid number of arguments given */
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..2)", argc);
+    break;
+  }
+
+  Check_Type(data, T_STRING);
+  length = RSTRING_LEN(data);
+  if ((offset < 0) || (offset > length))
+  {
+    rb_raise(rb_eIndexError, "offset %ld outside of data length %ld", offset, length);
+  }
+
+  if (((bit_offset % 8) != 0) || ((bit_size != 8) && (bit_size != 16) && (bit_size != 32) && (bit_size != 64)))
+  {
+    return frames;
+  }
+  if (RTEST(sync_pattern))
+  {
+    Check_Type(sync_pattern, T_STRING);
+    sync_data = RSTRING_PTR(sync_pattern);
+    sync_length = RSTRING_LEN(sync_pattern);
+  }
+  if (RTEST(max_length))
+  {
+    max_count = NUM2ULL(max_length);
+  }
+
+  buffer = (const unsigned char *)RSTRING_PTR(data);
+  while ((length - offset) >= bytes_needed)
+  {
+    if ((sync_length > 0) &&
+        (((length - offset) < sync_length) || (memcmp(buffer + offset, sync_data, (size_t)sync_length) != 0)))
+    {
+      break;
+    }
+
+    count = read_length(buffer + offset + byte_offset, byte_size, little_endian);
+    if (RTEST(max_length) && (count > max_count))
+    {
+      break;
+    }
+    /* Lengths which overflow are left to the Ruby implementation */
+    if (count > (unsigned long long)(LONG_MAX / (bytes_per_count > 0 ? bytes_per_count : 1)))
+    {
+      break;
+    }
+
+    packet_length = ((long long)count * bytes_per_count) + value_offset;
+    if ((packet_length * 8) < (bit_offset + bit_size))
+    {
+      break;
+    }
+    if (packet_length > (length - offset))
+    {
+      break;
+    }
+
+    rb_ary_push(frames, LONG2NUM((long)packet_length));
+    offset += (long)packet_length;
+  }
+
+  return frames;
+}
+
+void Init_length_protocol(void)
+{
+  rb_require("cosmos/interfaces/protocols/burst_protocol");
+
+  id_ivar_length_bit_offset = rb_intern("@length_bit_offset");
+  id_ivar_length_bit_size = rb_intern("@length_bit_size");
+  id_ivar_length_value_offset = rb_intern("@length_value_offset");
+  id_ivar_length_bytes_per_count = rb_intern("@length_bytes_per_count");
+  id_ivar_length_endianness = rb_intern("@length_endianness");
+  id_ivar_sync_pattern = rb_intern("@sync_pattern");
+  id_ivar_max_length = rb_intern("@max_length");
+  id_LITTLE_ENDIAN = rb_intern("LITTLE_ENDIAN");
+
+  mCosmos = rb_define_module("Cosmos");
+  cBurstProtocol = rb_const_get(mCosmos, rb_intern("BurstProtocol"));
+
+  cLengthProtocol = rb_define_class_under(mCosmos, "LengthProtocol", cBurstProtocol);
+  rb_define_method(cLengthProtocol, "find_frames", length_protocol_find_frames, -1);
+}
@@ -0,0 +1,334 @@
+/*
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+*/
+
+#include "ruby.h"
+#include "ruby/thread.h"
+#include "stdio.h"
+#include "string.h"
+#include "errno.h"
+#include "unistd.h"
+#ifdef HAVE_SYS_UIO_H
+#include "sys/uio.h"
+#endif
+
+VALUE mCosmos = Qnil;
+VALUE cLogWriteBuffer = Qnil;
+
+static ID id_ivar_buffer = 0;
+static ID id_ivar_index_buffer = 0;
+static ID id_ivar_fd = 0;
+static ID id_ivar_index_fd = 0;
+static ID id_ivar_flush_size = 0;
+static ID id_ivar_unsynced = 0;
+
+#define MAX_IOV 2
+
+#ifndef HAVE_SYS_UIO_H
+struct iovec
+{
+  void *iov_base;
+  size_t iov_len;
+};
+#endif
+
+/* Writes for up to two files performed in a single release of the GVL */
+typedef struct
+{
+  int fd;
+  struct iovec iov[MAX_IOV];
+  int iovcnt;
+  size_t written;
+  int error;
+} write_job_t;
+
+typedef struct
+{
+  write_job_t jobs[2];
+  int job_count;
+  int sync;
+} write_jobs_t;
+
+/*
+ * Write every byte described by the iovecs, handling partial writes. The
+ * number of bytes written is counted even if an error occurs.
+ */
+static int write_all(int fd, struct iovec *iov, int iovcnt, size_t *written)
+{
+  ssize_t result = 0;
+
+  while (iovcnt > 0)
+  {
+    if (iov->iov_len == 0)
+    {
+      iov++;
+      iovcnt--;
+      continue;
+    }
+#ifdef HAVE_WRITEV
+    result = writev(fd, iov, iovcnt);
+#else
+    result = write(fd, iov->iov_base, iov->iov_len);
+#endif
+    if (result < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return errno;
+    }
+    *written += (size_t)result;
+    while ((iovcnt > 0) && ((size_t)result >= iov->iov_len))
+    {
+      result -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0)
+    {
+      iov->iov_base = (char *)iov->iov_base + result;
+      iov->iov_len -= result;
+    }
+  }
+  return 0;
+}
+
+/*
+ * Perform the queued writes (and optionally sync). Runs without the GVL.
+ */
+static void *write_jobs(void *arg)
+{
+  write_jobs_t *jobs = (write_jobs_t *)arg;
+  write_job_t *job = NULL;
+  int index = 0;
+
+  for (index = 0; index < jobs->job_count; index++)
+  {
+    job = &jobs->jobs[index];
+    job->error = write_all(job->fd, job->iov, job->iovcnt, &job->written);
+    if ((job->error == 0) && jobs->sync)
+    {
+#ifdef HAVE_FDATASYNC
+      if (fdatasync(job->fd) != 0)
+#else
+      if (fsync(job->fd) != 0)
+#endif
+      {
+        job->error = errno;
+      }
+    }
+  }
+  return NULL;
+}
+
+static void add_job(write_jobs_t *jobs, int fd, VALUE buffer, VALUE data)
+{
+  write_job_t *job = &jobs->jobs[jobs->job_count++];
+  job->fd = fd;
+  job->iovcnt = 0;
+  job->written = 0;
+  job->error = 0;
+  if (RSTRING_LEN(buffer) > 0)
+  {
+    job->iov[job->iovcnt].iov_base = RSTRING_PTR(buffer);
+    job->iov[job->iovcnt].iov_len = (size_t)RSTRING_LEN(buffer);
+    job->iovcnt++;
+  }
+  if (!NIL_P(data) && (RSTRING_LEN(data) > 0))
+  {
+    job->iov[job->iovcnt].iov_base = RSTRING_PTR(data);
+    job->iov[job->iovcnt].iov_len = (size_t)RSTRING_LEN(data);
+    job->iovcnt++;
+  }
+}
+
+/*
+ * Remove the bytes which were written from the buffer. Whatever part of data
+ * wasn't written is appended to the buffer so it is written next time.
+ */
+static void keep_unwritten(VALUE buffer, VALUE data, size_t written)
+{
+  long length = RSTRING_LEN(buffer);
+
+  if (written < (size_t)length)
+  {
+    memmove(RSTRING_PTR(buffer), RSTRING_PTR(buffer) + written, length - written);
+    rb_str_set_len(buffer, length - (long)written);
+    written = 0;
+  }
+  else
+  {
+    rb_str_set_len(buffer, 0);
+    written -= (size_t)length;
+  }
+  if (!NIL_P(data) && (written < (size_t)RSTRING_LEN(data)))
+  {
+    rb_str_buf_cat(buffer, RSTRING_PTR(data) + written, RSTRING_LEN(data) - (long)written);
+  }
+}
+
+/*
+ * Run the jobs without the GVL and raise on error. The buffer of the first
+ * job and data are written to the log file and the optional second job
+ * writes the index buffer. Only the bytes which were written are removed
+ * from the buffers so a failed write is retried by the next write or flush.
+ */
+static void run_jobs(VALUE self, write_jobs_t *jobs, VALUE buffer, VALUE data, VALUE index_buffer)
+{
+  int index = 0;
+  int error = 0;
+
+  rb_thread_call_without_gvl(write_jobs, jobs, RUBY_UBF_IO, NULL);
+
+  keep_unwritten(buffer, data, jobs->jobs[0].written);
+  if (jobs->job_count > 1)
+  {
+    keep_unwritten(index_buffer, Qnil, jobs->jobs[1].written);
+  }
+  for (index = 0; index < jobs->job_count; index++)
+  {
+    if (jobs->jobs[index].error != 0)
+    {
+      error = jobs->jobs[index].error;
+    }
+  }
+  /* A failed sync leaves the files unsynced so the next sync tries again */
+  rb_ivar_set(self, id_ivar_unsynced, (jobs->sync && (error == 0)) ? Qfalse : Qtrue);
+  if (error != 0)
+  {
+    errno = error;
+    rb_sys_fail("LogWriteBuffer");
+  }
+}
+
+static VALUE flush_and_sync(VALUE self, int sync)
+{
+  volatile VALUE buffer = rb_ivar_get(self, id_ivar_buffer);
+  volatile VALUE index_buffer = rb_ivar_get(self, id_ivar_index_buffer);
+  volatile VALUE index_fd = rb_ivar_get(self, id_ivar_index_fd);
+  write_jobs_t jobs;
+
+  if ((RSTRING_LEN(buffer) == 0) && (NIL_P(index_buffer) || (RSTRING_LEN(index_buffer) == 0)) &&
+      (!sync || !RTEST(rb_ivar_get(self, id_ivar_unsynced))))
+  {
+    return Qnil;
+  }
+  rb_str_modify(buffer);
+  jobs.job_count = 0;
+  jobs.sync = sync;
+  /* The log file job is always first so run_jobs knows which buffer is which */
+  add_job(&jobs, NUM2INT(rb_ivar_get(self, id_ivar_fd)), buffer, Qnil);
+  if (!NIL_P(index_fd) && (sync || (RSTRING_LEN(index_buffer) > 0)))
+  {
+    rb_str_modify(index_buffer);
+    add_job(&jobs, NUM2INT(index_fd), index_buffer, Qnil);
+  }
+  run_jobs(self, &jobs, buffer, Qnil, index_buffer);
+  return Qnil;
+}
+
+/*
+ * Buffer data (and optionally index data). When the data buffer reaches the
+ * flush size the buffer and the new data are written with a single writev
+ * along with any buffered index data.
+ */
+static VALUE log_write_buffer_write(int argc, VALUE *argv, VALUE self)
+{
+  VALUE data = Qnil;
+  VALUE index_data = Qnil;
+  volatile VALUE buffer = rb_ivar_get(self, id_ivar_buffer);
+  volatile VALUE index_buffer = Qnil;
+  volatile VALUE index_fd = Qnil;
+  long flush_size = NUM2LONG(rb_ivar_get(self, id_ivar_flush_size));
+  write_jobs_t jobs;
+
+  rb_scan_args(argc, argv, "11", &data, &index_data);
+  StringValue(data);
+
+  if (!NIL_P(index_data))
+  {
+    StringValue(index_data);
+    index_buffer = rb_ivar_get(self, id_ivar_index_buffer);
+    if (NIL_P(index_buffer))
+    {
+      rb_raise(rb_eArgError, "No index file to write index data");
+    }
+    rb_str_buf_cat(index_buffer, RSTRING_PTR(index_data), RSTRING_LEN(index_data));
+  }
+
+  if ((RSTRING_LEN(buffer) + RSTRING_LEN(data)) < flush_size)
+  {
+    rb_str_buf_cat(buffer, RSTRING_PTR(data), RSTRING_LEN(data));
+    if (NIL_P(index_buffer) || (RSTRING_LEN(index_buffer) < flush_size))
+    {
+      return Qnil;
+    }
+    data = Qnil;
+  }
+
+  rb_str_modify(buffer);
+  jobs.job_count = 0;
+  jobs.sync = 0;
+  add_job(&jobs, NUM2INT(rb_ivar_get(self, id_ivar_fd)), buffer, data);
+  index_fd = rb_ivar_get(self, id_ivar_index_fd);
+  index_buffer = rb_ivar_get(self, id_ivar_index_buffer);
+  if (!NIL_P(index_fd) && (RSTRING_LEN(index_buffer) > 0))
+  {
+    rb_str_modify(index_buffer);
+    add_job(&jobs, NUM2INT(index_fd), index_buffer, Qnil);
+  }
+  run_jobs(self, &jobs, buffer, data, index_buffer);
+  return Qnil;
+}
+
+/*
+ * Write all buffered data to the files
+ */
+static VALUE log_write_buffer_flush(VALUE self)
+{
+  return flush_and_sync(self, 0);
+}
+
+/*
+ * Write all buffered data and fdatasync the files
+ */
+static VALUE log_write_buffer_sync(VALUE self)
+{
+  return flush_and_sync(self, 1);
+}
+
+/*
+ * Initialize methods for LogWriteBuffer
+ */
+void Init_log_write_buffer(void)
+{
+  id_ivar_buffer = rb_intern("@buffer");
+  id_ivar_index_buffer = rb_intern("@index_buffer");
+  id_ivar_fd = rb_intern("@fd");
+  id_ivar_index_fd = rb_intern("@index_fd");
+  id_ivar_flush_size = rb_intern("@flush_size");
+  id_ivar_unsynced = rb_intern("@unsynced");
+
+  mCosmos = rb_define_module("Cosmos");
+
+  cLogWriteBuffer = rb_define_class_under(mCosmos, "LogWriteBuffer", rb_cObject);
+  rb_define_method(cLogWriteBuffer, "write", log_write_buffer_write, -1);
+  rb_define_method(cLogWriteBuffer, "flush", log_write_buffer_flush, 0);
+  rb_define_method(cLogWriteBuffer, "sync", log_write_buffer_sync, 0);
+}
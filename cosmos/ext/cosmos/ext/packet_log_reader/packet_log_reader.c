@@ -0,0 +1,774 @@
+/*
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+*/
+
+#include "ruby.h"
+#include "stdio.h"
+#include "string.h"
+#include "stdlib.h"
+#include "errno.h"
+#include "fcntl.h"
+#include "sys/stat.h"
+#include "unistd.h"
+#ifdef HAVE_SYS_MMAN_H
+#include "sys/mman.h"
+#endif
+
+VALUE mCosmos = Qnil;
+VALUE cPacketLogReader = Qnil;
+
+static ID id_ivar_filename = 0;
+static ID id_ivar_target_names = 0;
+static ID id_ivar_target_ids = 0;
+static ID id_ivar_packets = 0;
+static ID id_ivar_packet_ids = 0;
+static ID id_ivar_redis_offset = 0;
+static ID id_method_reset = 0;
+static ID id_method_inflate = 0;
+
+static VALUE symbol_CMD = Qnil;
+static VALUE symbol_TLM = Qnil;
+
+/* Must match PacketLogConstants */
+#define COSMOS5_FILE_HEADER "COSMOS5_"
+#define COSMOS4_FILE_HEADER "COSMOS4_"
+#define COSMOS2_FILE_HEADER "COSMOS2_"
+#define COSMOS5_HEADER_LENGTH 8
+#define COSMOS5_ENTRY_TYPE_MASK 0xF000
+#define COSMOS5_TARGET_DECLARATION_ENTRY_TYPE_MASK 0x1000
+#define COSMOS5_PACKET_DECLARATION_ENTRY_TYPE_MASK 0x2000
+#define COSMOS5_RAW_PACKET_ENTRY_TYPE_MASK 0x3000
+#define COSMOS5_JSON_PACKET_ENTRY_TYPE_MASK 0x4000
+#define COSMOS5_OFFSET_MARKER_ENTRY_TYPE_MASK 0x5000
+#define COSMOS5_ID_FLAG_MASK 0x0200
+#define COSMOS5_STORED_FLAG_MASK 0x0400
+#define COSMOS5_CMD_FLAG_MASK 0x0800
+#define COSMOS5_ID_FIXED_SIZE 32
+#define COSMOS5_PRIMARY_FIXED_SIZE 2
+#define COSMOS5_PACKET_DECLARATION_SECONDARY_FIXED_SIZE 2
+#define COSMOS5_PACKET_SECONDARY_FIXED_SIZE 10
+#define COSMOS5_COMPRESSED_FILE_HEADER "COSMOS5Z"
+#define COSMOS5_BLOCK_HEADER_SIZE 8
+
+/* A log file mapped into memory (or read into memory without mmap) */
+typedef struct
+{
+  unsigned char *data;
+  long size;
+  int mapped;
+} log_map_t;
+
+static unsigned int read_uint16_be(const unsigned char *data)
+{
+  return ((unsigned int)data[0] << 8) | (unsigned int)data[1];
+}
+
+static unsigned int read_uint32_be(const unsigned char *data)
+{
+  return ((unsigned int)data[0] << 24) | ((unsigned int)data[1] << 16) |
+         ((unsigned int)data[2] << 8) | (unsigned int)data[3];
+}
+
+static unsigned long long read_uint64_be(const unsigned char *data)
+{
+  return ((unsigned long long)read_uint32_be(data) << 32) | (unsigned long long)read_uint32_be(data + 4);
+}
+
+/*
+ * Map the entire file into memory. Raises on error.
+ */
+static void log_map_open(log_map_t *map, VALUE filename)
+{
+  int fd = -1;
+  struct stat file_stat;
+
+  map->data = NULL;
+  map->size = 0;
+  map->mapped = 0;
+
+  FilePathValue(filename);
+  fd = open(StringValueCStr(filename), O_RDONLY);
+  if (fd < 0)
+  {
+    rb_sys_fail(StringValueCStr(filename));
+  }
+  if (fstat(fd, &file_stat) != 0)
+  {
+    close(fd);
+    rb_sys_fail(StringValueCStr(filename));
+  }
+  map->size = (long)file_stat.st_size;
+  if (map->size == 0)
+  {
+    close(fd);
+    return;
+  }
+
+#ifdef HAVE_SYS_MMAN_H
+  map->data = (unsigned char *)mmap(NULL, (size_t)map->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map->data == (unsigned char *)MAP_FAILED)
+  {
+    map->data = NULL;
+    close(fd);
+    rb_sys_fail(StringValueCStr(filename));
+  }
+  map->mapped = 1;
+#ifdef MADV_SEQUENTIAL
+  madvise(map->data, (size_t)map->size, MADV_SEQUENTIAL);
+#endif
+#else
+  {
+    long total = 0;
+    long result = 0;
+    map->data = (unsigned char *)malloc((size_t)map->size);
+    if (map->data == NULL)
+    {
+      close(fd);
+      rb_raise(rb_eNoMemError, "Unable to allocate %ld bytes for %s", map->size, StringValueCStr(filename));
+    }
+    while (total < map->size)
+    {
+      result = (long)read(fd, map->data + total, (unsigned int)(map->size - total));
+      if (result <= 0)
+      {
+        free(map->data);
+        map->data = NULL;
+        close(fd);
+        rb_sys_fail(StringValueCStr(filename));
+      }
+      total += result;
+    }
+  }
+#endif
+  close(fd);
+}
+
+static void log_map_close(log_map_t *map)
+{
+  if (map->data)
+  {
+#ifdef HAVE_SYS_MMAN_H
+    if (map->mapped)
+    {
+      munmap(map->data, (size_t)map->size);
+    }
+    else
+    {
+      free(map->data);
+    }
+#else
+    free(map->data);
+#endif
+    map->data = NULL;
+  }
+}
+
+/*
+ * Verify the COSMOS5 file header with the same errors as read_file_header.
+ * Returns whether the log is compressed.
+ */
+static int log_map_check_header(log_map_t *map)
+{
+  if (map->size < COSMOS5_HEADER_LENGTH)
+  {
+    rb_raise(rb_eRuntimeError, "Failed to read at least %d bytes from packet log", COSMOS5_HEADER_LENGTH);
+  }
+  if (memcmp(map->data, COSMOS5_FILE_HEADER, COSMOS5_HEADER_LENGTH) == 0)
+  {
+    return 0;
+  }
+  if (memcmp(map->data, COSMOS5_COMPRESSED_FILE_HEADER, COSMOS5_HEADER_LENGTH) == 0)
+  {
+    return 1;
+  }
+  if (memcmp(map->data, COSMOS4_FILE_HEADER, COSMOS5_HEADER_LENGTH) == 0)
+  {
+    rb_raise(rb_eRuntimeError, "COSMOS 4 log file must be converted to COSMOS 5");
+  }
+  if (memcmp(map->data, COSMOS2_FILE_HEADER, COSMOS5_HEADER_LENGTH) == 0)
+  {
+    rb_raise(rb_eRuntimeError, "COSMOS 2 log file must be converted to COSMOS 5");
+  }
+  rb_raise(rb_eRuntimeError, "COSMOS file header not found");
+  return 0;
+}
+
+/*
+ * Process a target declaration, packet declaration or offset marker entry
+ * into the reader's ivars. Returns 0 if the entry is not one of those.
+ */
+static int process_declaration(VALUE self, unsigned int flags, const unsigned char *entry, long length)
+{
+  volatile VALUE target_names = Qnil;
+  volatile VALUE target_name = Qnil;
+  volatile VALUE packet = Qnil;
+  long name_length = 0;
+  int id = ((flags & COSMOS5_ID_FLAG_MASK) == COSMOS5_ID_FLAG_MASK);
+
+  switch (flags & COSMOS5_ENTRY_TYPE_MASK)
+  {
+  case COSMOS5_TARGET_DECLARATION_ENTRY_TYPE_MASK:
+    name_length = length - COSMOS5_PRIMARY_FIXED_SIZE;
+    if (id)
+    {
+      name_length -= COSMOS5_ID_FIXED_SIZE;
+    }
+    if (name_length < 0)
+    {
+      rb_raise(rb_eRuntimeError, "Invalid target declaration length: %ld", length);
+    }
+    if (id)
+    {
+      rb_ary_push(rb_ivar_get(self, id_ivar_target_ids), rb_str_new((const char *)entry + 2 + name_length, COSMOS5_ID_FIXED_SIZE));
+    }
+    rb_ary_push(rb_ivar_get(self, id_ivar_target_names), rb_str_new((const char *)entry + 2, name_length));
+    return 1;
+
+  case COSMOS5_PACKET_DECLARATION_ENTRY_TYPE_MASK:
+    name_length = length - COSMOS5_PRIMARY_FIXED_SIZE - COSMOS5_PACKET_DECLARATION_SECONDARY_FIXED_SIZE;
+    if (id)
+    {
+      name_length -= COSMOS5_ID_FIXED_SIZE;
+    }
+    if (name_length < 0)
+    {
+      rb_raise(rb_eRuntimeError, "Invalid packet declaration length: %ld", length);
+    }
+    target_names = rb_ivar_get(self, id_ivar_target_names);
+    target_name = rb_ary_entry(target_names, (long)read_uint16_be(entry + 2));
+    packet = rb_ary_new2(4);
+    rb_ary_push(packet, ((flags & COSMOS5_CMD_FLAG_MASK) == COSMOS5_CMD_FLAG_MASK) ? symbol_CMD : symbol_TLM);
+    rb_ary_push(packet, target_name);
+    rb_ary_push(packet, rb_str_new((const char *)entry + 4, name_length));
+    if (id)
+    {
+      VALUE packet_id = rb_str_new((const char *)entry + 4 + name_length, COSMOS5_ID_FIXED_SIZE);
+      rb_ary_push(rb_ivar_get(self, id_ivar_packet_ids), packet_id);
+      rb_ary_push(packet, packet_id);
+    }
+    else
+    {
+      rb_ary_push(packet, Qfalse);
+    }
+    rb_ary_push(rb_ivar_get(self, id_ivar_packets), packet);
+    return 1;
+
+  case COSMOS5_OFFSET_MARKER_ENTRY_TYPE_MASK:
+    rb_ivar_set(self, id_ivar_redis_offset, rb_str_new((const char *)entry + 2, length - 2));
+    return 1;
+
+  default:
+    return 0;
+  }
+}
+
+struct each_entry_args
+{
+  VALUE self;
+  log_map_t map;
+  int offsets;
+};
+
+/*
+ * Yield the packet entries and process the declarations in a buffer of
+ * complete entries. base is the file offset of the buffer (used for offsets).
+ */
+static void each_entry_parse(struct each_entry_args *args, const unsigned char *data, long pos, long size, long base)
+{
+  VALUE self = args->self;
+  long length = 0;
+  long data_length = 0;
+  unsigned int flags = 0;
+  unsigned int entry_type = 0;
+  const unsigned char *entry = NULL;
+  volatile VALUE packets = rb_ivar_get(self, id_ivar_packets);
+  volatile VALUE packet = Qnil;
+  VALUE cmd_or_tlm = Qnil;
+  VALUE yield_args[7];
+
+  while (pos < size)
+  {
+    if ((size - pos) < 4)
+    {
+      rb_raise(rb_eRuntimeError, "Truncated entry length at offset %ld", base + pos);
+    }
+    length = (long)read_uint32_be(data + pos);
+    if ((length < COSMOS5_PRIMARY_FIXED_SIZE) || (length > (size - pos - 4)))
+    {
+      rb_raise(rb_eRuntimeError, "Invalid entry length %ld at offset %ld", length, base + pos);
+    }
+    entry = data + pos + 4;
+    flags = read_uint16_be(entry);
+    entry_type = flags & COSMOS5_ENTRY_TYPE_MASK;
+
+    if ((entry_type == COSMOS5_RAW_PACKET_ENTRY_TYPE_MASK) || (entry_type == COSMOS5_JSON_PACKET_ENTRY_TYPE_MASK))
+    {
+      if (length < (COSMOS5_PRIMARY_FIXED_SIZE + COSMOS5_PACKET_SECONDARY_FIXED_SIZE))
+      {
+        rb_raise(rb_eRuntimeError, "Invalid packet entry length %ld at offset %ld", length, base + pos);
+      }
+      cmd_or_tlm = ((flags & COSMOS5_CMD_FLAG_MASK) == COSMOS5_CMD_FLAG_MASK) ? symbol_CMD : symbol_TLM;
+      packet = rb_ary_entry(packets, (long)read_uint16_be(entry + 2));
+      if (NIL_P(packet) || (rb_ary_entry(packet, 0) != cmd_or_tlm))
+      {
+        rb_raise(rb_eRuntimeError, "Packet type mismatch, packet:%s, lookup:%s",
+                 rb_id2name(SYM2ID(cmd_or_tlm)),
+                 NIL_P(packet) ? "" : rb_id2name(SYM2ID(rb_ary_entry(packet, 0))));
+      }
+      data_length = length - COSMOS5_PRIMARY_FIXED_SIZE - COSMOS5_PACKET_SECONDARY_FIXED_SIZE;
+
+      yield_args[0] = cmd_or_tlm;
+      yield_args[1] = rb_ary_entry(packet, 1);
+      yield_args[2] = rb_ary_entry(packet, 2);
+      yield_args[3] = ULL2NUM(read_uint64_be(entry + 4));
+      yield_args[4] = ((flags & COSMOS5_STORED_FLAG_MASK) == COSMOS5_STORED_FLAG_MASK) ? Qtrue : Qfalse;
+      if (args->offsets)
+      {
+        yield_args[5] = LONG2NUM(base + pos + 4 + COSMOS5_PRIMARY_FIXED_SIZE + COSMOS5_PACKET_SECONDARY_FIXED_SIZE);
+        yield_args[6] = LONG2NUM(data_length);
+        rb_yield_values2(7, yield_args);
+      }
+      else
+      {
+        yield_args[5] = rb_str_new((const char *)entry + COSMOS5_PRIMARY_FIXED_SIZE + COSMOS5_PACKET_SECONDARY_FIXED_SIZE, data_length);
+        rb_yield_values2(6, yield_args);
+      }
+    }
+    else if (!process_declaration(self, flags, entry, length))
+    {
+      rb_raise(rb_eRuntimeError, "Invalid Entry Flags: %u", flags);
+    }
+
+    pos += 4 + length;
+  }
+}
+
+static VALUE each_entry_body(VALUE arg)
+{
+  struct each_entry_args *args = (struct each_entry_args *)arg;
+  const unsigned char *data = args->map.data;
+  long size = args->map.size;
+  long pos = COSMOS5_HEADER_LENGTH;
+  long compressed_length = 0;
+  long length = 0;
+  volatile VALUE block = Qnil;
+
+  if (!log_map_check_header(&args->map))
+  {
+    each_entry_parse(args, data, pos, size, 0);
+    return Qnil;
+  }
+
+  if (args->offsets)
+  {
+    rb_raise(rb_eRuntimeError, "Entry offsets are not available for compressed logs");
+  }
+  /* Decompress each block with Zlib and parse the entries it contains */
+  while (pos < size)
+  {
+    if ((size - pos) < COSMOS5_BLOCK_HEADER_SIZE)
+    {
+      rb_raise(rb_eRuntimeError, "Truncated compressed block");
+    }
+    compressed_length = (long)read_uint32_be(data + pos);
+    length = (long)read_uint32_be(data + pos + 4);
+    pos += COSMOS5_BLOCK_HEADER_SIZE;
+    if (compressed_length > (size - pos))
+    {
+      rb_raise(rb_eRuntimeError, "Truncated compressed block");
+    }
+    block = rb_funcall(rb_path2class("Zlib::Inflate"), id_method_inflate, 1, rb_str_new((const char *)data + pos, compressed_length));
+    StringValue(block);
+    if (RSTRING_LEN(block) != length)
+    {
+      rb_raise(rb_eRuntimeError, "Invalid compressed block length %ld, expected %ld", RSTRING_LEN(block), length);
+    }
+    each_entry_parse(args, (const unsigned char *)RSTRING_PTR(block), 0, length, 0);
+    pos += compressed_length;
+  }
+
+  return Qnil;
+}
+
+static VALUE each_entry_ensure(VALUE arg)
+{
+  struct each_entry_args *args = (struct each_entry_args *)arg;
+  log_map_close(&args->map);
+  return Qnil;
+}
+
+/*
+ * Yield the contents of every packet entry in a log file
+ */
+static VALUE packet_log_reader_each_entry(int argc, VALUE *argv, VALUE self)
+{
+  struct each_entry_args args;
+  VALUE filename = Qnil;
+  VALUE offsets = Qfalse;
+
+  rb_scan_args(argc, argv, "11", &filename, &offsets);
+  rb_need_block();
+
+  rb_funcall(self, id_method_reset, 0);
+  rb_ivar_set(self, id_ivar_filename, filename);
+
+  args.self = self;
+  args.offsets = RTEST(offsets);
+  log_map_open(&args.map, filename);
+  rb_ensure(each_entry_body, (VALUE)&args, each_entry_ensure, (VALUE)&args);
+  return Qnil;
+}
+
+/* A log file being merged by each_merged_entry */
+typedef struct
+{
+  VALUE reader; /* PacketLogReader holding the declarations of this log */
+  log_map_t map;
+  int compressed;
+  long file_pos;              /* Position of the next compressed block in the map */
+  const unsigned char *data;  /* Entries being parsed (the map or an inflated block) */
+  long pos;
+  long size;
+  int active;
+  /* The current packet entry */
+  unsigned long long time;
+  const unsigned char *entry;
+  long length;
+  unsigned int flags;
+} merge_cursor_t;
+
+struct each_merged_entry_args
+{
+  VALUE filenames;
+  VALUE readers;
+  VALUE blocks; /* Inflated blocks kept alive while being parsed */
+  VALUE start_time;
+  VALUE end_time;
+  long count;
+  merge_cursor_t *cursors;
+  long *heap;
+  long heap_size;
+};
+
+static const char *merge_filename(struct each_merged_entry_args *args, long index)
+{
+  VALUE filename = rb_ary_entry(args->filenames, index);
+  return StringValueCStr(filename);
+}
+
+/*
+ * Inflate the next block of a compressed log. Returns 0 at the end of the file.
+ */
+static int merge_next_block(struct each_merged_entry_args *args, long index)
+{
+  merge_cursor_t *cursor = &args->cursors[index];
+  const unsigned char *data = cursor->map.data;
+  long compressed_length = 0;
+  long length = 0;
+  volatile VALUE block = Qnil;
+
+  if (cursor->file_pos >= cursor->map.size)
+  {
+    return 0;
+  }
+  if ((cursor->map.size - cursor->file_pos) < COSMOS5_BLOCK_HEADER_SIZE)
+  {
+    rb_raise(rb_eRuntimeError, "Truncated compressed block");
+  }
+  compressed_length = (long)read_uint32_be(data + cursor->file_pos);
+  length = (long)read_uint32_be(data + cursor->file_pos + 4);
+  cursor->file_pos += COSMOS5_BLOCK_HEADER_SIZE;
+  if (compressed_length > (cursor->map.size - cursor->file_pos))
+  {
+    rb_raise(rb_eRuntimeError, "Truncated compressed block");
+  }
+  block = rb_funcall(rb_path2class("Zlib::Inflate"), id_method_inflate, 1, rb_str_new((const char *)data + cursor->file_pos, compressed_length));
+  StringValue(block);
+  if (RSTRING_LEN(block) != length)
+  {
+    rb_raise(rb_eRuntimeError, "Invalid compressed block length %ld, expected %ld", RSTRING_LEN(block), length);
+  }
+  rb_ary_store(args->blocks, index, block);
+  cursor->file_pos += compressed_length;
+  cursor->data = (const unsigned char *)RSTRING_PTR(block);
+  cursor->pos = 0;
+  cursor->size = length;
+  return 1;
+}
+
+/*
+ * Move a cursor to its next packet entry, processing any declarations on
+ * the way. Returns 0 at the end of the file.
+ */
+static int merge_advance(struct each_merged_entry_args *args, long index)
+{
+  merge_cursor_t *cursor = &args->cursors[index];
+  long length = 0;
+  unsigned int flags = 0;
+  unsigned int entry_type = 0;
+  const unsigned char *entry = NULL;
+
+  while (1)
+  {
+    if (cursor->pos >= cursor->size)
+    {
+      if (!cursor->compressed || !merge_next_block(args, index))
+      {
+        cursor->active = 0;
+        return 0;
+      }
+      continue;
+    }
+    if ((cursor->size - cursor->pos) < 4)
+    {
+      rb_raise(rb_eRuntimeError, "Truncated entry length in %s", merge_filename(args, index));
+    }
+    length = (long)read_uint32_be(cursor->data + cursor->pos);
+    if ((length < COSMOS5_PRIMARY_FIXED_SIZE) || (length > (cursor->size - cursor->pos - 4)))
+    {
+      rb_raise(rb_eRuntimeError, "Invalid entry length %ld in %s", length, merge_filename(args, index));
+    }
+    entry = cursor->data + cursor->pos + 4;
+    cursor->pos += 4 + length;
+    flags = read_uint16_be(entry);
+    entry_type = flags & COSMOS5_ENTRY_TYPE_MASK;
+
+    if ((entry_type == COSMOS5_RAW_PACKET_ENTRY_TYPE_MASK) || (entry_type == COSMOS5_JSON_PACKET_ENTRY_TYPE_MASK))
+    {
+      if (length < (COSMOS5_PRIMARY_FIXED_SIZE + COSMOS5_PACKET_SECONDARY_FIXED_SIZE))
+      {
+        rb_raise(rb_eRuntimeError, "Invalid packet entry length %ld in %s", length, merge_filename(args, index));
+      }
+      cursor->entry = entry;
+      cursor->length = length;
+      cursor->flags = flags;
+      cursor->time = read_uint64_be(entry + 4);
+      cursor->active = 1;
+      return 1;
+    }
+    if (!process_declaration(cursor->reader, flags, entry, length))
+    {
+      rb_raise(rb_eRuntimeError, "Invalid Entry Flags: %u", flags);
+    }
+  }
+}
+
+/* Order by time and then by log index so equal times keep the log order */
+static int merge_less(struct each_merged_entry_args *args, long a, long b)
+{
+  merge_cursor_t *cursor_a = &args->cursors[a];
+  merge_cursor_t *cursor_b = &args->cursors[b];
+  if (cursor_a->time != cursor_b->time)
+  {
+    return cursor_a->time < cursor_b->time;
+  }
+  return a < b;
+}
+
+static void merge_sift_down(struct each_merged_entry_args *args, long position)
+{
+  long *heap = args->heap;
+  long child = 0;
+  long temp = 0;
+
+  while (1)
+  {
+    child = (position * 2) + 1;
+    if (child >= args->heap_size)
+    {
+      return;
+    }
+    if (((child + 1) < args->heap_size) && merge_less(args, heap[child + 1], heap[child]))
+    {
+      child++;
+    }
+    if (!merge_less(args, heap[child], heap[position]))
+    {
+      return;
+    }
+    temp = heap[child];
+    heap[child] = heap[position];
+    heap[position] = temp;
+    position = child;
+  }
+}
+
+static VALUE each_merged_entry_body(VALUE arg)
+{
+  struct each_merged_entry_args *args = (struct each_merged_entry_args *)arg;
+  merge_cursor_t *cursor = NULL;
+  volatile VALUE packet = Qnil;
+  VALUE cmd_or_tlm = Qnil;
+  VALUE yield_args[7];
+  unsigned long long start_time = 0;
+  unsigned long long end_time = 0;
+  long index = 0;
+
+  if (!NIL_P(args->start_time))
+  {
+    start_time = NUM2ULL(args->start_time);
+  }
+  if (!NIL_P(args->end_time))
+  {
+    end_time = NUM2ULL(args->end_time);
+  }
+
+  for (index = 0; index < args->count; index++)
+  {
+    cursor = &args->cursors[index];
+    log_map_open(&cursor->map, rb_ary_entry(args->filenames, index));
+    cursor->compressed = log_map_check_header(&cursor->map);
+    cursor->file_pos = COSMOS5_HEADER_LENGTH;
+    cursor->data = cursor->map.data;
+    cursor->pos = COSMOS5_HEADER_LENGTH;
+    cursor->size = cursor->compressed ? 0 : cursor->map.size;
+    if (merge_advance(args, index))
+    {
+      args->heap[args->heap_size++] = index;
+    }
+  }
+  for (index = (args->heap_size / 2) - 1; index >= 0; index--)
+  {
+    merge_sift_down(args, index);
+  }
+
+  while (args->heap_size > 0)
+  {
+    index = args->heap[0];
+    cursor = &args->cursors[index];
+    if (!NIL_P(args->end_time) && (cursor->time > end_time))
+    {
+      /* Every remaining entry is later */
+      break;
+    }
+    if (NIL_P(args->start_time) || (cursor->time >= start_time))
+    {
+      cmd_or_tlm = ((cursor->flags & COSMOS5_CMD_FLAG_MASK) == COSMOS5_CMD_FLAG_MASK) ? symbol_CMD : symbol_TLM;
+      packet = rb_ary_entry(rb_ivar_get(cursor->reader, id_ivar_packets), (long)read_uint16_be(cursor->entry + 2));
+      if (NIL_P(packet) || (rb_ary_entry(packet, 0) != cmd_or_tlm))
+      {
+        rb_raise(rb_eRuntimeError, "Packet type mismatch, packet:%s, lookup:%s",
+                 rb_id2name(SYM2ID(cmd_or_tlm)),
+                 NIL_P(packet) ? "" : rb_id2name(SYM2ID(rb_ary_entry(packet, 0))));
+      }
+      yield_args[0] = cmd_or_tlm;
+      yield_args[1] = rb_ary_entry(packet, 1);
+      yield_args[2] = rb_ary_entry(packet, 2);
+      yield_args[3] = ULL2NUM(cursor->time);
+      yield_args[4] = ((cursor->flags & COSMOS5_STORED_FLAG_MASK) == COSMOS5_STORED_FLAG_MASK) ? Qtrue : Qfalse;
+      yield_args[5] = rb_str_new((const char *)cursor->entry + COSMOS5_PRIMARY_FIXED_SIZE + COSMOS5_PACKET_SECONDARY_FIXED_SIZE,
+                                 cursor->length - COSMOS5_PRIMARY_FIXED_SIZE - COSMOS5_PACKET_SECONDARY_FIXED_SIZE);
+      yield_args[6] = LONG2FIX(index);
+      rb_yield_values2(7, yield_args);
+    }
+    if (!merge_advance(args, index))
+    {
+      args->heap[0] = args->heap[--args->heap_size];
+    }
+    merge_sift_down(args, 0);
+  }
+
+  return Qnil;
+}
+
+static VALUE each_merged_entry_ensure(VALUE arg)
+{
+  struct each_merged_entry_args *args = (struct each_merged_entry_args *)arg;
+  long index = 0;
+
+  for (index = 0; index < args->count; index++)
+  {
+    log_map_close(&args->cursors[index].map);
+  }
+  xfree(args->cursors);
+  xfree(args->heap);
+  return Qnil;
+}
+
+/*
+ * Yield the contents of every packet entry in multiple log files in time
+ * order using a min heap of the next entry in each file
+ */
+static VALUE packet_log_reader_each_merged_entry(int argc, VALUE *argv, VALUE self)
+{
+  struct each_merged_entry_args args;
+  VALUE filenames = Qnil;
+  VALUE start_time = Qnil;
+  VALUE end_time = Qnil;
+  volatile VALUE reader = Qnil;
+  VALUE filename = Qnil;
+  long index = 0;
+
+  rb_scan_args(argc, argv, "12", &filenames, &start_time, &end_time);
+  rb_need_block();
+
+  rb_funcall(self, id_method_reset, 0);
+  memset(&args, 0, sizeof(args));
+  args.filenames = rb_ary_dup(rb_Array(filenames));
+  args.count = RARRAY_LEN(args.filenames);
+  args.readers = rb_ary_new2(args.count);
+  args.blocks = rb_ary_new2(args.count);
+  args.start_time = start_time;
+  args.end_time = end_time;
+  for (index = 0; index < args.count; index++)
+  {
+    filename = rb_ary_entry(args.filenames, index);
+    FilePathValue(filename);
+    rb_ary_store(args.filenames, index, filename);
+    reader = rb_class_new_instance(0, NULL, cPacketLogReader);
+    rb_ivar_set(reader, id_ivar_filename, filename);
+    rb_ary_push(args.readers, reader);
+  }
+
+  args.cursors = ALLOC_N(merge_cursor_t, args.count > 0 ? args.count : 1);
+  memset(args.cursors, 0, sizeof(merge_cursor_t) * (args.count > 0 ? args.count : 1));
+  args.heap = ALLOC_N(long, args.count > 0 ? args.count : 1);
+  for (index = 0; index < args.count; index++)
+  {
+    args.cursors[index].reader = rb_ary_entry(args.readers, index);
+  }
+  rb_ensure(each_merged_entry_body, (VALUE)&args, each_merged_entry_ensure, (VALUE)&args);
+  RB_GC_GUARD(args.filenames);
+  RB_GC_GUARD(args.readers);
+  RB_GC_GUARD(args.blocks);
+  return Qnil;
+}
+
+/*
+ * Initialize methods for PacketLogReader
+ */
+void Init_packet_log_reader(void)
+{
+  id_ivar_filename = rb_intern("@filename");
+  id_ivar_target_names = rb_intern("@target_names");
+  id_ivar_target_ids = rb_intern("@target_ids");
+  id_ivar_packets = rb_intern("@packets");
+  id_ivar_packet_ids = rb_intern("@packet_ids");
+  id_ivar_redis_offset = rb_intern("@redis_offset");
+  id_method_reset = rb_intern("reset");
+  id_method_inflate = rb_intern("inflate");
+
+  symbol_CMD = ID2SYM(rb_intern("CMD"));
+  symbol_TLM = ID2SYM(rb_intern("TLM"));
+
+  mCosmos = rb_define_module("Cosmos");
+
+  cPacketLogReader = rb_define_class_under(mCosmos, "PacketLogReader", rb_cObject);
+  rb_define_method(cPacketLogReader, "each_entry", packet_log_reader_each_entry, -1);
+  rb_define_method(cPacketLogReader, "each_merged_entry", packet_log_reader_each_merged_entry, -1);
+}
@@ -0,0 +1,808 @@
+/*
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+*/
+
+#include "ruby.h"
+#include "ruby/thread.h"
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "math.h"
+
+VALUE mCosmos = Qnil;
+VALUE cReducerAccumulator = Qnil;
+
+static ID id_ivar_stats = 0;
+static ID id_ivar_size = 0;
+
+/* Must match ReducerAccumulator */
+#define COUNT_INDEX 0
+#define MIN_INDEX 1
+#define MAX_INDEX 2
+#define MEAN_INDEX 3
+#define M2_INDEX 4
+#define INTEGER_INDEX 5
+#define SLOT_SIZE 6
+
+/* Value states filled in by the JSON scan */
+#define VALUE_MISSING 0
+#define VALUE_FLOAT 1
+#define VALUE_INTEGER 2
+
+/*
+ * Everything needed to scan a JSON object without the GVL. The JSON and
+ * the keys are copies so no Ruby objects are touched during the scan.
+ */
+typedef struct
+{
+  char *json;
+  long json_length;
+  char *key_data;
+  long *key_offsets;
+  long *key_lengths;
+  long key_count;
+  long *table;
+  unsigned long table_mask;
+  double *values;
+  char *states;
+  int error;
+} json_scan_t;
+
+/*
+ * Get the statistics for a slot after verifying the slot is in range
+ */
+static double *accumulator_slot(VALUE self, VALUE arg_slot)
+{
+  volatile VALUE stats = rb_ivar_get(self, id_ivar_stats);
+  long size = NUM2LONG(rb_ivar_get(self, id_ivar_size));
+  long slot = NUM2LONG(arg_slot);
+
+  Check_Type(stats, T_STRING);
+  if (RSTRING_LEN(stats) != (size * SLOT_SIZE * (long)sizeof(double)))
+  {
+    rb_raise(rb_eRuntimeError, "ReducerAccumulator stats corrupted");
+  }
+  if ((slot < 0) || (slot >= size))
+  {
+    rb_raise(rb_eIndexError, "Slot %ld outside of 0...%ld", slot, size);
+  }
+  return ((double *)RSTRING_PTR(stats)) + (slot * SLOT_SIZE);
+}
+
+static int is_integer(VALUE value)
+{
+  return FIXNUM_P(value) || RB_TYPE_P(value, T_BIGNUM);
+}
+
+/*
+ * Min or max of a slot as an Integer if every value was an Integer
+ */
+static VALUE accumulator_extreme(VALUE self, VALUE slot, int index)
+{
+  double *stats = accumulator_slot(self, slot);
+  if (stats[COUNT_INDEX] == 0.0)
+  {
+    return Qnil;
+  }
+  if (stats[INTEGER_INDEX] != 0.0)
+  {
+    return rb_dbl2big(stats[index]);
+  }
+  return rb_float_new(stats[index]);
+}
+
+/*
+ * Get the statistics for every slot ready to be modified
+ */
+static double *accumulator_stats(VALUE self, long *size)
+{
+  volatile VALUE stats = rb_ivar_get(self, id_ivar_stats);
+  *size = NUM2LONG(rb_ivar_get(self, id_ivar_size));
+
+  Check_Type(stats, T_STRING);
+  rb_str_modify(stats);
+  if (RSTRING_LEN(stats) != (*size * SLOT_SIZE * (long)sizeof(double)))
+  {
+    rb_raise(rb_eRuntimeError, "ReducerAccumulator stats corrupted");
+  }
+  return (double *)RSTRING_PTR(stats);
+}
+
+static int is_numeric(VALUE value)
+{
+  return FIXNUM_P(value) || RB_FLOAT_TYPE_P(value) || RB_TYPE_P(value, T_BIGNUM) ||
+         (!SPECIAL_CONST_P(value) && RTEST(rb_obj_is_kind_of(value, rb_cNumeric)));
+}
+
+/*
+ * Welford's algorithm
+ */
+static void slot_add(double *stats, double number, int integer)
+{
+  double delta = 0.0;
+
+  stats[COUNT_INDEX] += 1.0;
+  if (!integer)
+  {
+    stats[INTEGER_INDEX] = 0.0;
+  }
+  if (stats[COUNT_INDEX] == 1.0)
+  {
+    stats[MIN_INDEX] = number;
+    stats[MAX_INDEX] = number;
+  }
+  else
+  {
+    if (number < stats[MIN_INDEX])
+    {
+      stats[MIN_INDEX] = number;
+    }
+    if (number > stats[MAX_INDEX])
+    {
+      stats[MAX_INDEX] = number;
+    }
+  }
+  delta = number - stats[MEAN_INDEX];
+  stats[MEAN_INDEX] += delta / stats[COUNT_INDEX];
+  stats[M2_INDEX] += delta * (number - stats[MEAN_INDEX]);
+}
+
+/*
+ * Parallel form of Welford's algorithm (Chan et al.)
+ */
+static void slot_combine(double *stats, double samples, double min, double max, double mean, double stddev, int integer)
+{
+  double count = stats[COUNT_INDEX];
+  double total = count + samples;
+  double delta = 0.0;
+
+  if (samples <= 0.0)
+  {
+    return;
+  }
+  if (!integer)
+  {
+    stats[INTEGER_INDEX] = 0.0;
+  }
+  if (count == 0.0)
+  {
+    stats[MIN_INDEX] = min;
+    stats[MAX_INDEX] = max;
+    stats[MEAN_INDEX] = mean;
+    stats[M2_INDEX] = stddev * stddev * samples;
+  }
+  else
+  {
+    if (min < stats[MIN_INDEX])
+    {
+      stats[MIN_INDEX] = min;
+    }
+    if (max > stats[MAX_INDEX])
+    {
+      stats[MAX_INDEX] = max;
+    }
+    delta = mean - stats[MEAN_INDEX];
+    stats[MEAN_INDEX] += delta * samples / total;
+    stats[M2_INDEX] += (stddev * stddev * samples) + (delta * delta * count * samples / total);
+  }
+  stats[COUNT_INDEX] = total;
+}
+
+/*
+ * Add a value to a slot
+ */
+static VALUE accumulator_add(VALUE self, VALUE slot, VALUE value)
+{
+  double number = NUM2DBL(value);
+
+  rb_str_modify(rb_ivar_get(self, id_ivar_stats));
+  slot_add(accumulator_slot(self, slot), number, is_integer(value));
+  return Qnil;
+}
+
+/*
+ * Merge previously reduced statistics into a slot
+ */
+static VALUE accumulator_combine(VALUE self, VALUE slot, VALUE samples, VALUE min, VALUE max, VALUE mean, VALUE stddev)
+{
+  double values[5];
+
+  values[0] = NUM2DBL(samples);
+  values[1] = NUM2DBL(min);
+  values[2] = NUM2DBL(max);
+  values[3] = NUM2DBL(mean);
+  values[4] = NUM2DBL(stddev);
+  rb_str_modify(rb_ivar_get(self, id_ivar_stats));
+  slot_combine(accumulator_slot(self, slot), values[0], values[1], values[2], values[3], values[4],
+               is_integer(min) && is_integer(max));
+  return Qnil;
+}
+
+/*
+ * Add the numeric values of a Hash to every slot. Keys are the converted
+ * key (or nil) followed by the raw key for each slot.
+ */
+static VALUE accumulator_add_hash(VALUE self, VALUE hash, VALUE keys)
+{
+  double *stats = NULL;
+  long size = 0;
+  long slot = 0;
+  volatile VALUE key = Qnil;
+  volatile VALUE value = Qnil;
+
+  Check_Type(hash, T_HASH);
+  Check_Type(keys, T_ARRAY);
+  stats = accumulator_stats(self, &size);
+  if (RARRAY_LEN(keys) != (size * 2))
+  {
+    rb_raise(rb_eArgError, "Expected %ld keys but got %ld", size * 2, RARRAY_LEN(keys));
+  }
+
+  for (slot = 0; slot < size; slot++)
+  {
+    value = Qnil;
+    key = RARRAY_AREF(keys, slot * 2);
+    if (RTEST(key))
+    {
+      value = rb_hash_lookup(hash, key);
+    }
+    if (!is_numeric(value))
+    {
+      value = rb_hash_lookup(hash, RARRAY_AREF(keys, (slot * 2) + 1));
+      if (!is_numeric(value))
+      {
+        continue;
+      }
+    }
+    slot_add(stats + (slot * SLOT_SIZE), NUM2DBL(value), is_integer(value));
+  }
+  return Qnil;
+}
+
+/*
+ * Merge the reduced values of a Hash into every slot. Keys are the samples,
+ * min, max, mean and stddev keys for each slot.
+ */
+static VALUE accumulator_combine_hash(VALUE self, VALUE hash, VALUE keys)
+{
+  double *stats = NULL;
+  double numbers[5];
+  long size = 0;
+  long slot = 0;
+  int index = 0;
+  volatile VALUE values[5];
+
+  Check_Type(hash, T_HASH);
+  Check_Type(keys, T_ARRAY);
+  stats = accumulator_stats(self, &size);
+  if (RARRAY_LEN(keys) != (size * 5))
+  {
+    rb_raise(rb_eArgError, "Expected %ld keys but got %ld", size * 5, RARRAY_LEN(keys));
+  }
+
+  for (slot = 0; slot < size; slot++)
+  {
+    for (index = 0; index < 5; index++)
+    {
+      values[index] = rb_hash_lookup(hash, RARRAY_AREF(keys, (slot * 5) + index));
+      if (!is_numeric(values[index]))
+      {
+        break;
+      }
+      numbers[index] = NUM2DBL(values[index]);
+    }
+    if (index < 5)
+    {
+      continue;
+    }
+    slot_combine(stats + (slot * SLOT_SIZE), numbers[0], numbers[1], numbers[2], numbers[3], numbers[4],
+                 is_integer(values[1]) && is_integer(values[2]));
+  }
+  return Qnil;
+}
+
+/*
+ * Number of samples in a slot
+ */
+static VALUE accumulator_samples(VALUE self, VALUE slot)
+{
+  return rb_dbl2big(accumulator_slot(self, slot)[COUNT_INDEX]);
+}
+
+/*
+ * Minimum value in a slot
+ */
+static VALUE accumulator_min(VALUE self, VALUE slot)
+{
+  return accumulator_extreme(self, slot, MIN_INDEX);
+}
+
+/*
+ * Maximum value in a slot
+ */
+static VALUE accumulator_max(VALUE self, VALUE slot)
+{
+  return accumulator_extreme(self, slot, MAX_INDEX);
+}
+
+/*
+ * Mean value in a slot
+ */
+static VALUE accumulator_mean(VALUE self, VALUE slot)
+{
+  double *stats = accumulator_slot(self, slot);
+  if (stats[COUNT_INDEX] == 0.0)
+  {
+    return Qnil;
+  }
+  return rb_float_new(stats[MEAN_INDEX]);
+}
+
+/*
+ * Population standard deviation of a slot
+ */
+static VALUE accumulator_stddev(VALUE self, VALUE slot)
+{
+  double *stats = accumulator_slot(self, slot);
+  double variance = 0.0;
+  if (stats[COUNT_INDEX] == 0.0)
+  {
+    return Qnil;
+  }
+  variance = stats[M2_INDEX] / stats[COUNT_INDEX];
+  /* Rounding can leave a tiny negative variance for constant values */
+  if (variance < 0.0)
+  {
+    variance = 0.0;
+  }
+  return rb_float_new(sqrt(variance));
+}
+
+/*
+ * Clear every slot
+ */
+static VALUE accumulator_reset(VALUE self)
+{
+  long size = 0;
+  long slot = 0;
+  double *stats = accumulator_stats(self, &size);
+
+  memset(stats, 0, size * SLOT_SIZE * sizeof(double));
+  for (slot = 0; slot < size; slot++)
+  {
+    stats[(slot * SLOT_SIZE) + INTEGER_INDEX] = 1.0;
+  }
+  return Qnil;
+}
+
+static unsigned long hash_bytes(const char *data, long length)
+{
+  unsigned long hash = 2166136261UL;
+  long index = 0;
+  for (index = 0; index < length; index++)
+  {
+    hash ^= (unsigned char)data[index];
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+/*
+ * Index of a key in the scan keys or -1 if it is not needed
+ */
+static long find_key(json_scan_t *scan, const char *key, long length)
+{
+  unsigned long position = hash_bytes(key, length) & scan->table_mask;
+  long key_index = 0;
+  while ((key_index = scan->table[position]) >= 0)
+  {
+    if ((scan->key_lengths[key_index] == length) &&
+        (memcmp(scan->key_data + scan->key_offsets[key_index], key, length) == 0))
+    {
+      return key_index;
+    }
+    position = (position + 1) & scan->table_mask;
+  }
+  return -1;
+}
+
+static const char *skip_whitespace(const char *position, const char *end)
+{
+  while ((position < end) && ((*position == ' ') || (*position == '\t') || (*position == '\n') || (*position == '\r')))
+  {
+    position++;
+  }
+  return position;
+}
+
+/*
+ * Skip a string starting at its opening quote. Returns NULL if it is not
+ * terminated.
+ */
+static const char *skip_string(const char *position, const char *end)
+{
+  position++;
+  while (position < end)
+  {
+    if (*position == '\\')
+    {
+      position += 2;
+    }
+    else if (*position == '"')
+    {
+      return position + 1;
+    }
+    else
+    {
+      position++;
+    }
+  }
+  return NULL;
+}
+
+/*
+ * Skip any value other than a number. Returns NULL if it is malformed.
+ */
+static const char *skip_value(const char *position, const char *end)
+{
+  long depth = 0;
+
+  if (*position == '"')
+  {
+    return skip_string(position, end);
+  }
+  if ((*position != '{') && (*position != '['))
+  {
+    /* true, false or null */
+    while ((position < end) && (*position >= 'a') && (*position <= 'z'))
+    {
+      position++;
+    }
+    return position;
+  }
+  while (position < end)
+  {
+    switch (*position)
+    {
+    case '"':
+      position = skip_string(position, end);
+      if (position == NULL)
+      {
+        return NULL;
+      }
+      continue;
+    case '{':
+    case '[':
+      depth++;
+      break;
+    case '}':
+    case ']':
+      depth--;
+      if (depth == 0)
+      {
+        return position + 1;
+      }
+      break;
+    default:
+      break;
+    }
+    position++;
+  }
+  return NULL;
+}
+
+/*
+ * Scan the members of a flat JSON object and save the numeric value of
+ * every member named in the keys. Runs without the GVL.
+ */
+static void *scan_json(void *data)
+{
+  json_scan_t *scan = (json_scan_t *)data;
+  const char *position = scan->json;
+  const char *end = scan->json + scan->json_length;
+  const char *key = NULL;
+  const char *value_end = NULL;
+  long key_length = 0;
+  long key_index = 0;
+  double number = 0.0;
+
+  scan->error = 1;
+  position = skip_whitespace(position, end);
+  if ((position >= end) || (*position != '{'))
+  {
+    return NULL;
+  }
+  position = skip_whitespace(position + 1, end);
+  if ((position < end) && (*position == '}'))
+  {
+    scan->error = 0;
+    return NULL;
+  }
+
+  while (position < end)
+  {
+    if (*position != '"')
+    {
+      return NULL;
+    }
+    key = position + 1;
+    position = skip_string(position, end);
+    if (position == NULL)
+    {
+      return NULL;
+    }
+    key_length = (long)(position - key) - 1;
+    position = skip_whitespace(position, end);
+    if ((position >= end) || (*position != ':'))
+    {
+      return NULL;
+    }
+    position = skip_whitespace(position + 1, end);
+    if (position >= end)
+    {
+      return NULL;
+    }
+
+    if ((*position == '-') || ((*position >= '0') && (*position <= '9')))
+    {
+      /* The JSON copy is NUL terminated so strtod stops at the buffer end */
+      number = strtod(position, (char **)&value_end);
+      if (value_end == position)
+      {
+        return NULL;
+      }
+      key_index = find_key(scan, key, key_length);
+      if (key_index >= 0)
+      {
+        scan->values[key_index] = number;
+        scan->states[key_index] = VALUE_INTEGER;
+        for (; position < value_end; position++)
+        {
+          if ((*position == '.') || (*position == 'e') || (*position == 'E'))
+          {
+            scan->states[key_index] = VALUE_FLOAT;
+            break;
+          }
+        }
+      }
+      position = value_end;
+    }
+    else
+    {
+      position = skip_value(position, end);
+      if (position == NULL)
+      {
+        return NULL;
+      }
+    }
+
+    position = skip_whitespace(position, end);
+    if (position >= end)
+    {
+      return NULL;
+    }
+    if (*position == '}')
+    {
+      scan->error = 0;
+      return NULL;
+    }
+    if (*position != ',')
+    {
+      return NULL;
+    }
+    position = skip_whitespace(position + 1, end);
+  }
+  return NULL;
+}
+
+static void json_scan_free(json_scan_t *scan)
+{
+  xfree(scan->json);
+  xfree(scan->key_data);
+  xfree(scan->key_offsets);
+  xfree(scan->key_lengths);
+  xfree(scan->table);
+  xfree(scan->values);
+  xfree(scan->states);
+}
+
+/*
+ * Copy the JSON and keys and scan the JSON without the GVL. nil keys are
+ * never matched.
+ */
+static void json_scan(json_scan_t *scan, VALUE json, VALUE keys)
+{
+  long key_index = 0;
+  long total_key_length = 0;
+  unsigned long table_size = 16;
+  unsigned long position = 0;
+  volatile VALUE key = Qnil;
+
+  memset(scan, 0, sizeof(json_scan_t));
+  scan->key_count = RARRAY_LEN(keys);
+  for (key_index = 0; key_index < scan->key_count; key_index++)
+  {
+    key = RARRAY_AREF(keys, key_index);
+    if (RTEST(key))
+    {
+      total_key_length += RSTRING_LEN(StringValue(key));
+    }
+  }
+  while (table_size < (unsigned long)(scan->key_count * 2))
+  {
+    table_size <<= 1;
+  }
+
+  scan->json_length = RSTRING_LEN(json);
+  scan->json = ALLOC_N(char, scan->json_length + 1);
+  memcpy(scan->json, RSTRING_PTR(json), scan->json_length);
+  scan->json[scan->json_length] = 0;
+  scan->key_data = ALLOC_N(char, total_key_length + 1);
+  scan->key_offsets = ALLOC_N(long, scan->key_count + 1);
+  scan->key_lengths = ALLOC_N(long, scan->key_count + 1);
+  scan->table = ALLOC_N(long, table_size);
+  scan->table_mask = table_size - 1;
+  scan->values = ALLOC_N(double, scan->key_count + 1);
+  scan->states = ALLOC_N(char, scan->key_count + 1);
+  memset(scan->states, VALUE_MISSING, scan->key_count + 1);
+  memset(scan->table, 0xFF, table_size * sizeof(long));
+
+  total_key_length = 0;
+  for (key_index = 0; key_index < scan->key_count; key_index++)
+  {
+    key = RARRAY_AREF(keys, key_index);
+    scan->key_offsets[key_index] = total_key_length;
+    scan->key_lengths[key_index] = 0;
+    if (!RTEST(key))
+    {
+      continue;
+    }
+    scan->key_lengths[key_index] = RSTRING_LEN(key);
+    memcpy(scan->key_data + total_key_length, RSTRING_PTR(key), RSTRING_LEN(key));
+    total_key_length += RSTRING_LEN(key);
+    /* Duplicate keys keep the first index */
+    if (find_key(scan, RSTRING_PTR(key), RSTRING_LEN(key)) >= 0)
+    {
+      continue;
+    }
+    position = hash_bytes(RSTRING_PTR(key), RSTRING_LEN(key)) & scan->table_mask;
+    while (scan->table[position] >= 0)
+    {
+      position = (position + 1) & scan->table_mask;
+    }
+    scan->table[position] = key_index;
+  }
+
+  rb_thread_call_without_gvl(scan_json, scan, NULL, NULL);
+  if (scan->error)
+  {
+    json_scan_free(scan);
+    rb_raise(rb_eArgError, "Invalid JSON object");
+  }
+}
+
+/*
+ * Add the numeric values of a JSON object to every slot. The JSON is parsed
+ * without holding the GVL so other threads can reduce at the same time.
+ */
+static VALUE accumulator_add_json(VALUE self, VALUE json, VALUE keys)
+{
+  json_scan_t scan;
+  double *stats = NULL;
+  long size = 0;
+  long slot = 0;
+  long key_index = 0;
+
+  StringValue(json);
+  Check_Type(keys, T_ARRAY);
+  stats = accumulator_stats(self, &size);
+  if (RARRAY_LEN(keys) != (size * 2))
+  {
+    rb_raise(rb_eArgError, "Expected %ld keys but got %ld", size * 2, RARRAY_LEN(keys));
+  }
+
+  json_scan(&scan, json, keys);
+  /* Get the stats again in case they moved while the GVL was released */
+  stats = accumulator_stats(self, &size);
+  for (slot = 0; slot < size; slot++)
+  {
+    /* Prefer the converted value */
+    key_index = slot * 2;
+    if (scan.states[key_index] == VALUE_MISSING)
+    {
+      key_index++;
+    }
+    if (scan.states[key_index] != VALUE_MISSING)
+    {
+      slot_add(stats + (slot * SLOT_SIZE), scan.values[key_index], scan.states[key_index] == VALUE_INTEGER);
+    }
+  }
+  json_scan_free(&scan);
+  return Qnil;
+}
+
+/*
+ * Merge the reduced values of a JSON object into every slot. The JSON is
+ * parsed without holding the GVL.
+ */
+static VALUE accumulator_combine_json(VALUE self, VALUE json, VALUE keys)
+{
+  json_scan_t scan;
+  double *stats = NULL;
+  double *values = NULL;
+  char *states = NULL;
+  long size = 0;
+  long slot = 0;
+  int index = 0;
+
+  StringValue(json);
+  Check_Type(keys, T_ARRAY);
+  stats = accumulator_stats(self, &size);
+  if (RARRAY_LEN(keys) != (size * 5))
+  {
+    rb_raise(rb_eArgError, "Expected %ld keys but got %ld", size * 5, RARRAY_LEN(keys));
+  }
+
+  json_scan(&scan, json, keys);
+  stats = accumulator_stats(self, &size);
+  for (slot = 0; slot < size; slot++)
+  {
+    values = scan.values + (slot * 5);
+    states = scan.states + (slot * 5);
+    for (index = 0; index < 5; index++)
+    {
+      if (states[index] == VALUE_MISSING)
+      {
+        break;
+      }
+    }
+    if (index < 5)
+    {
+      continue;
+    }
+    slot_combine(stats + (slot * SLOT_SIZE), values[0], values[1], values[2], values[3], values[4],
+                 (states[1] == VALUE_INTEGER) && (states[2] == VALUE_INTEGER));
+  }
+  json_scan_free(&scan);
+  return Qnil;
+}
+
+/*
+ * Initialize methods for ReducerAccumulator
+ */
+void Init_reducer_accumulator(void)
+{
+  id_ivar_stats = rb_intern("@stats");
+  id_ivar_size = rb_intern("@size");
+
+  mCosmos = rb_define_module("Cosmos");
+
+  cReducerAccumulator = rb_define_class_under(mCosmos, "ReducerAccumulator", rb_cObject);
+  rb_define_method(cReducerAccumulator, "add", accumulator_add, 2);
+  rb_define_method(cReducerAccumulator, "combine", accumulator_combine, 6);
+  rb_define_method(cReducerAccumulator, "add_hash", accumulator_add_hash, 2);
+  rb_define_method(cReducerAccumulator, "combine_hash", accumulator_combine_hash, 2);
+  rb_define_method(cReducerAccumulator, "add_json", accumulator_add_json, 2);
+  rb_define_method(cReducerAccumulator, "combine_json", accumulator_combine_json, 2);
+  rb_define_method(cReducerAccumulator, "samples", accumulator_samples, 1);
+  rb_define_method(cReducerAccumulator, "min", accumulator_min, 1);
+  rb_define_method(cReducerAccumulator, "max", accumulator_max, 1);
+  rb_define_method(cReducerAccumulator, "mean", accumulator_mean, 1);
+  rb_define_method(cReducerAccumulator, "stddev", accumulator_stddev, 1);
+  rb_define_method(cReducerAccumulator, "reset", accumulator_reset, 0);
+}
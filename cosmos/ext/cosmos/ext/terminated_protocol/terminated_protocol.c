@@ -0,0 +1,171 @@
+/*
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+*/
+
+#ifdef HAVE_MEMMEM
+#define _GNU_SOURCE 1
+#endif
+
+#include "ruby.h"
+#include "stdio.h"
+#include "string.h"
+
+VALUE mCosmos = Qnil;
+VALUE cBurstProtocol = Qnil;
+VALUE cTerminatedProtocol = Qnil;
+
+static ID id_ivar_read_termination_characters = 0;
+static ID id_ivar_sync_pattern = 0;
+
+/*
+ * Find the first occurrence of pattern in data
+ */
+static const unsigned char *find_pattern(const unsigned char *data, long length, const unsigned char *pattern, long pattern_length)
+{
+#ifdef HAVE_MEMMEM
+  return memmem(data, (size_t)length, pattern, (size_t)pattern_length);
+#else
+  const unsigned char *current = data;
+  const unsigned char *last = data + length - pattern_length;
+
+  while (current <= last)
+  {
+    current = memchr(current, pattern[0], (size_t)(last - current + 1));
+    if (current == NULL)
+    {
+      break;
+    }
+    if (memcmp(current + 1, pattern + 1, (size_t)(pattern_length - 1)) == 0)
+    {
+      return current;
+    }
+    current++;
+  }
+  return NULL;
+#endif
+}
+
+/*
+ * Find the lengths of the complete packets at the start of the data.
+ * Each length includes the read termination characters. Framing stops at
+ * the first packet without termination characters or which doesn't begin
+ * with the sync pattern.
+ *
+ * @param data [String] Data to frame
+ * @param offset [Integer] Index of the first packet in data
+ * @param search_offset [Integer] Number of bytes of the first packet
+ *   already known not to contain the start of the termination characters
+ * @return [Array<Integer>] Length of each complete packet in order
+ */
+static VALUE terminated_protocol_find_frames(int argc, VALUE *argv, VALUE self)
+{
+  volatile VALUE data = Qnil;
+  volatile VALUE termination = rb_ivar_get(self, id_ivar_read_termination_characters);
+  volatile VALUE sync_pattern = rb_ivar_get(self, id_ivar_sync_pattern);
+  volatile VALUE frames = rb_ary_new();
+  long offset = 0;
+  long search_offset = 0;
+  long length = 0;
+  long termination_length = 0;
+  long sync_length = 0;
+  const unsigned char *buffer = NULL;
+  const unsigned char *termination_data = NULL;
+  const unsigned char *sync_data = NULL;
+  const unsigned char *found = NULL;
+
+  switch (argc)
+  {
+  case 1:
+    data = argv[0];
+    break;
+  case 2:
+    data = argv[0];
+    offset = NUM2LONG(argv[1]);
+    break;
+  case 3:
+    data = argv[0];
+    offset = NUM2LONG(argv[1]);
+    search_offset = NUM2LONG(argv[2]);
+    break;
+  default:
+    /* Invalid number of arguments given */
+    rb_raise(rb_eArgError, "wrong number of arguments (%d for 1..3)", argc);
+    break;
+  }
+
+  Check_Type(data, T_STRING);
+  Check_Type(termination, T_STRING);
+  length = RSTRING_LEN(data);
+  if ((offset < 0) || (offset > length))
+  {
+    rb_raise(rb_eIndexError, "offset %ld outside of data length %ld", offset, length);
+  }
+  if (search_offset < 0)
+  {
+    search_offset = 0;
+  }
+
+  termination_length = RSTRING_LEN(termination);
+  if (termination_length <= 0)
+  {
+    return frames;
+  }
+  termination_data = (const unsigned char *)RSTRING_PTR(termination);
+  if (RTEST(sync_pattern))
+  {
+    Check_Type(sync_pattern, T_STRING);
+    sync_data = (const unsigned char *)RSTRING_PTR(sync_pattern);
+    sync_length = RSTRING_LEN(sync_pattern);
+  }
+
+  buffer = (const unsigned char *)RSTRING_PTR(data);
+  while ((length - offset - search_offset) >= termination_length)
+  {
+    if ((sync_length > 0) &&
+        (((length - offset) < sync_length) || (memcmp(buffer + offset, sync_data, (size_t)sync_length) != 0)))
+    {
+      break;
+    }
+
+    found = find_pattern(buffer + offset + search_offset, length - offset - search_offset, termination_data, termination_length);
+    if (found == NULL)
+    {
+      break;
+    }
+
+    rb_ary_push(frames, LONG2NUM((long)(found - (buffer + offset)) + termination_length));
+    offset = (long)(found - buffer) + termination_length;
+    search_offset = 0;
+  }
+
+  return frames;
+}
+
+void Init_terminated_protocol(void)
+{
+  rb_require("cosmos/interfaces/protocols/burst_protocol");
+
+  id_ivar_read_termination_characters = rb_intern("@read_termination_characters");
+  id_ivar_sync_pattern = rb_intern("@sync_pattern");
+
+  mCosmos = rb_define_module("Cosmos");
+  cBurstProtocol = rb_const_get(mCosmos, rb_intern("BurstProtocol"));
+
+  cTerminatedProtocol = rb_define_class_under(mCosmos, "TerminatedProtocol", cBurstProtocol);
+  rb_define_method(cTerminatedProtocol, "find_frames", terminated_protocol_find_frames, -1);
+}
@@ -0,0 +1,172 @@
+/*
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+*/
+
+#ifdef HAVE_RECVMMSG
+#define _GNU_SOURCE 1
+#endif
+
+#include "ruby.h"
+#include "stdio.h"
+#include "string.h"
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+/* Largest possible UDP datagram */
+#define MAX_DATAGRAM_SIZE 65536
+/* Most datagrams returned by one batch */
+#define MAX_BATCH_SIZE 64
+
+VALUE mCosmos = Qnil;
+VALUE cUdpReadWriteSocket = Qnil;
+
+static ID id_ivar_socket = 0;
+static ID id_ivar_batch_buffer = 0;
+static ID id_method_fileno = 0;
+
+/*
+ * Get the preallocated receive buffer with room for count datagrams
+ */
+static char *batch_buffer(VALUE self, long count)
+{
+  volatile VALUE buffer = rb_ivar_get(self, id_ivar_batch_buffer);
+  long size = count * MAX_DATAGRAM_SIZE;
+
+  if (!RB_TYPE_P(buffer, T_STRING) || (RSTRING_LEN(buffer) < size))
+  {
+    buffer = rb_str_buf_new(size);
+    rb_str_set_len(buffer, size);
+    rb_ivar_set(self, id_ivar_batch_buffer, buffer);
+  }
+  return RSTRING_PTR(buffer);
+}
+
+/*
+ * Read the datagrams already waiting on the socket without blocking. Uses a
+ * single recvmmsg call where available.
+ *
+ * @param max_count [Integer] Maximum number of datagrams to read. Limited
+ *   to 64.
+ * @return [Array<String>|nil] Datagrams in the order received or nil if
+ *   there weren't any
+ */
+static VALUE udp_read_write_socket_recv_batch_nonblock(VALUE self, VALUE param_max_count)
+{
+  volatile VALUE datagrams = Qnil;
+  int fd = NUM2INT(rb_funcall(rb_ivar_get(self, id_ivar_socket), id_method_fileno, 0));
+  long max_count = NUM2LONG(param_max_count);
+  long count = 0;
+  long index = 0;
+  char *buffer = NULL;
+#ifdef HAVE_RECVMMSG
+  struct mmsghdr messages[MAX_BATCH_SIZE];
+  struct iovec iovecs[MAX_BATCH_SIZE];
+  int result = 0;
+#else
+  long lengths[MAX_BATCH_SIZE];
+  ssize_t result = 0;
+#endif
+
+  if (max_count < 1)
+  {
+    max_count = 1;
+  }
+  if (max_count > MAX_BATCH_SIZE)
+  {
+    max_count = MAX_BATCH_SIZE;
+  }
+  buffer = batch_buffer(self, max_count);
+
+#ifdef HAVE_RECVMMSG
+  memset(messages, 0, sizeof(struct mmsghdr) * max_count);
+  for (index = 0; index < max_count; index++)
+  {
+    iovecs[index].iov_base = buffer + (index * MAX_DATAGRAM_SIZE);
+    iovecs[index].iov_len = MAX_DATAGRAM_SIZE;
+    messages[index].msg_hdr.msg_iov = &iovecs[index];
+    messages[index].msg_hdr.msg_iovlen = 1;
+  }
+
+  do
+  {
+    result = recvmmsg(fd, messages, (unsigned int)max_count, MSG_DONTWAIT, NULL);
+  } while ((result < 0) && (errno == EINTR));
+  if (result < 0)
+  {
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+    {
+      return Qnil;
+    }
+    rb_sys_fail("recvmmsg");
+  }
+  count = result;
+
+  datagrams = rb_ary_new2(count);
+  for (index = 0; index < count; index++)
+  {
+    rb_ary_push(datagrams, rb_str_new(buffer + (index * MAX_DATAGRAM_SIZE), messages[index].msg_len));
+  }
+#else
+  for (count = 0; count < max_count; count++)
+  {
+    do
+    {
+      result = recvfrom(fd, buffer + (count * MAX_DATAGRAM_SIZE), MAX_DATAGRAM_SIZE, MSG_DONTWAIT, NULL, NULL);
+    } while ((result < 0) && (errno == EINTR));
+    if (result < 0)
+    {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+      {
+        break;
+      }
+      if (count == 0)
+      {
+        rb_sys_fail("recvfrom");
+      }
+      break;
+    }
+    lengths[count] = (long)result;
+  }
+  if (count == 0)
+  {
+    return Qnil;
+  }
+
+  datagrams = rb_ary_new2(count);
+  for (index = 0; index < count; index++)
+  {
+    rb_ary_push(datagrams, rb_str_new(buffer + (index * MAX_DATAGRAM_SIZE), lengths[index]));
+  }
+#endif
+
+  return datagrams;
+}
+
+void Init_udp_sockets(void)
+{
+  id_ivar_socket = rb_intern("@socket");
+  id_ivar_batch_buffer = rb_intern("@batch_buffer");
+  id_method_fileno = rb_intern("fileno");
+
+  mCosmos = rb_define_module("Cosmos");
+
+  cUdpReadWriteSocket = rb_define_class_under(mCosmos, "UdpReadWriteSocket", rb_cObject);
+  rb_define_protected_method(cUdpReadWriteSocket, "recv_batch_nonblock", udp_read_write_socket_recv_batch_nonblock, 1);
+}
@@ -22,7 +22,57 @@ require 'cosmos/ext/cosmos_io' if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT'
 
 # COSMOS specific additions to the Ruby IO and StringIO classes
 module CosmosIO
+  LENGTH_FIELD_FORMATS = {
+    :BIG_ENDIAN => { 1 => 'C', 2 => 'n', 4 => 'N', 8 => 'Q>' },
+    :LITTLE_ENDIAN => { 1 => 'C', 2 => 'v', 4 => 'V', 8 => 'Q<' },
+  }
+
+  # @!method self.read_length_fields(data, offset, length_num_bytes, count = nil, endianness = :BIG_ENDIAN, max_length = nil)
+  #   Parses consecutive length fields each followed by the number of bytes
+  #   the length field indicates. Nothing is copied, the offset and length of
+  #   each field's bytes are returned so the caller can slice only what it
+  #   needs. Parsing stops at the first field which isn't complete.
+  #
+  #   For example:
+  #     data = "\x02\x01\x02\x01\x03\x05"
+  #     CosmosIO.read_length_fields(data, 0, 1)
+  #     # returns [1, 2, 4, 1] because the first field's two bytes start at
+  #     # index 1 and the second field's one byte starts at index 4. The last
+  #     # field is incomplete.
+  #
+  #   @param data [String] Data to parse
+  #   @param offset [Integer] Index of the first length field in data
+  #   @param length_num_bytes [Integer] Number of bytes in each length field.
+  #     Must be 1, 2, 4 or 8.
+  #   @param count [Integer|nil] Maximum number of fields to parse or nil to
+  #     parse every complete field
+  #   @param endianness [Symbol] :BIG_ENDIAN or :LITTLE_ENDIAN length fields
+  #   @param max_length [Integer|nil] Maximum allowed value of a length field
+  #   @return [Array<Integer>] Offset in data followed by the length of the
+  #     bytes of each complete field
+
   if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
+    def self.read_length_fields(data, offset, length_num_bytes, count = nil, endianness = :BIG_ENDIAN, max_length = nil)
+      raise IndexError, "offset #{offset} outside of data length #{data.length}" if offset < 0 or offset > data.length
+
+      endianness = :BIG_ENDIAN unless endianness == :LITTLE_ENDIAN
+      format = LENGTH_FIELD_FORMATS[endianness][length_num_bytes]
+      raise ArgumentError, "Unsupported length field size: #{length_num_bytes}" unless format
+
+      fields = []
+      while (!count or fields.length < (count * 2)) and (data.length - offset) >= length_num_bytes
+        field_length = data[offset, length_num_bytes].unpack(format)[0]
+        raise "Length value received larger than max_length: #{field_length} > #{max_length}" if max_length and field_length > max_length
+
+        offset += length_num_bytes
+        break if field_length > (data.length - offset)
+
+        fields << offset << field_length
+        offset += field_length
+      end
+      fields
+    end
+
     # Reads a length field and then return the String resulting from reading the
     # number of bytes the length field indicates
     #
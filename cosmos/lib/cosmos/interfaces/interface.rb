@@ -248,6 +248,18 @@ module Cosmos
       raise err
     end
 
+    # Retrieves the packets available from the interface. Interfaces which
+    # read several packets with one read of the underlying connection
+    # override this to return them together.
+    # @return [Array<Packet>|nil] Packets constructed from the data or nil if
+    #   the interface requested a disconnect
+    def read_batch
+      packet = read()
+      return nil unless packet
+
+      [packet]
+    end
+
     # Method to send a packet on the interface.
     # @param packet [Packet] The Packet to send out the interface
     def write(packet)
@@ -19,6 +19,8 @@
 
 require 'cosmos/config/config_parser'
 require 'cosmos/interfaces/protocols/protocol'
+require 'cosmos/io/byte_buffer'
+require 'cosmos/ext/burst_protocol' if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT']
 require 'thread'
 
 module Cosmos
@@ -43,8 +45,7 @@ module Cosmos
 
     def reset
       super()
-      @data = ''
-      @data.force_encoding('ASCII-8BIT')
+      @data = ByteBuffer.new
       @sync_state = :SEARCHING
     end
 
@@ -113,68 +114,61 @@ module Cosmos
       super(data)
     end
 
+    # @!method self.find_sync(data, sync_pattern, offset = 0)
+    #   Search for a sync pattern. Implemented in C for speed.
+    #
+    #   @param data [String] Data to search
+    #   @param sync_pattern [String] Sync pattern to find
+    #   @param offset [Integer] Index in data to start searching
+    #   @return [Integer] Index of the first full sync pattern. If there isn't
+    #     one the index of a partial sync pattern at the end of the data or the
+    #     data length if there isn't a partial sync pattern either.
+
+    if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
+      def self.find_sync(data, sync_pattern, offset = 0)
+        index = data.index(sync_pattern, offset)
+        return index if index
+
+        index = data.length - sync_pattern.length + 1
+        index = offset if index < offset
+        while index < data.length
+          return index if sync_pattern.start_with?(data[index..-1])
+
+          index += 1
+        end
+        data.length
+      end
+    end
+
+    # Searches the whole buffer for the sync pattern at once and discards
+    # everything before it with a single copy
+    #
     # @return [Boolean] control code (nil, :STOP)
     def handle_sync_pattern
       if @sync_pattern and @sync_state == :SEARCHING
-        loop do
-          # Make sure we have some data to look for a sync word in
-          return :STOP if @data.length < @sync_pattern.length
-
-          # Find the beginning of the sync pattern
-          sync_index = @data.index(@sync_pattern.getbyte(0).chr)
-          if sync_index
-            # Make sure we have enough data for the whole sync pattern past this index
-            return :STOP if @data.length < (sync_index + @sync_pattern.length)
-
-            # Check for the rest of the sync pattern
-            found = true
-            index = sync_index
-            @sync_pattern.each_byte do |byte|
-              if @data.getbyte(index) != byte
-                found = false
-                break
-              end
-              index += 1
-            end
-
-            if found
-              if sync_index != 0
-                discard_length = @data[0..(sync_index - 1)].length
-                log_discard(discard_length, true)
-                # Delete Data Before Sync Pattern
-                @data.replace(@data[sync_index..-1])
-              end
-              @sync_state = :FOUND
-              return nil
-
-            else # not found
-              log_discard(@data[0..sync_index].length, false)
-              # Delete Data Before and including first character of suspected sync Pattern
-              @data.replace(@data[(sync_index + 1)..-1])
-              next
-            end # if found
-
-          else # sync_index = nil
-            log_discard(@data.length, false)
-            @data.replace('')
-            return :STOP
-          end # unless sync_index.nil?
-        end # end loop
+        sync_index = BurstProtocol.find_sync(@data.buffer, @sync_pattern, @data.read_index) - @data.read_index
+        found = (@data.length - sync_index) >= @sync_pattern.length
+        if sync_index != 0
+          log_discard(sync_index, found)
+          # Delete Data Before Sync Pattern (or the start of one)
+          @data.consume(sync_index)
+        end
+        return :STOP unless found
+
+        @sync_state = :FOUND
       end # if @sync_pattern
       nil
     end
 
     def log_discard(length, found)
       Logger.error("#{@interface ? @interface.name : ""}: Sync #{'not ' unless found}found. Discarding #{length} bytes of data.")
-      if @data.length >= 0
-        Logger.error(sprintf("Starting: 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X\n",
-                             @data.length >= 1 ? @data.getbyte(0) : 0,
-                             @data.length >= 2 ? @data.getbyte(1) : 0,
-                             @data.length >= 3 ? @data.getbyte(2) : 0,
-                             @data.length >= 4 ? @data.getbyte(3) : 0,
-                             @data.length >= 5 ? @data.getbyte(4) : 0,
-                             @data.length >= 6 ? @data.getbyte(5) : 0))
-      end
+      Logger.error(sprintf("Starting: 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X 0x%02X\n",
+                           @data.peek(0) || 0,
+                           @data.peek(1) || 0,
+                           @data.peek(2) || 0,
+                           @data.peek(3) || 0,
+                           @data.peek(4) || 0,
+                           @data.peek(5) || 0))
     end
 
     def reduce_to_single_packet
@@ -184,9 +178,7 @@ module Cosmos
       end
 
       # Reduce to packet data and clear data for next packet
-      packet_data = @data.clone
-      @data.replace('')
-      packet_data
+      @data.take(@data.length)
     end
   end
 end
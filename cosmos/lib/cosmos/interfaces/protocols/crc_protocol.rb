@@ -148,7 +148,7 @@ module Cosmos
       return super(data) if data.length <= 0
 
       crc = BinaryAccessor.read(@bit_offset, @bit_size, :UINT, data, @endianness)
-      calculated_crc = @crc.calc(data[0...(@bit_offset / 8)])
+      calculated_crc = @crc.calc_range(data, 0, crc_range_length(@bit_offset / 8, data.length))
       if calculated_crc != crc
         Logger.error "#{@interface ? @interface.name : ""}: Invalid CRC detected! Calculated 0x#{calculated_crc.to_s(16).upcase} vs found 0x#{crc.to_s(16).upcase}."
         if @bad_strategy == DISCONNECT
@@ -168,7 +168,8 @@ module Cosmos
     def write_packet(packet)
       if @write_item_name
         end_range = packet.get_item(@write_item_name).bit_offset / 8
-        crc = @crc.calc(packet.buffer(false)[0...end_range])
+        buffer = packet.buffer(false)
+        crc = @crc.calc_range(buffer, 0, crc_range_length(end_range, buffer.length))
         packet.write(@write_item_name, crc)
       end
       packet
@@ -189,5 +190,19 @@ module Cosmos
       end
       data
     end
+
+    protected
+
+    # @param end_index [Integer] Index after the last byte to CRC. Negative
+    #   values count back from the end of the data.
+    # @param length [Integer] Length of the data
+    # @return [Integer] Number of bytes to CRC from the start of the data
+    def crc_range_length(end_index, length)
+      end_index += length if end_index < 0
+      return 0 if end_index < 0
+      return length if end_index > length
+
+      end_index
+    end
   end
 end
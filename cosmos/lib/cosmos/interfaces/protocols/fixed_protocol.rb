@@ -73,6 +73,8 @@ module Cosmos
     def identify_and_finish_packet
       packet_data = nil
       identified_packet = nil
+      # Copy the data to identify once rather than for every packet
+      id_data = @data.slice(@discard_leading_bytes) if @data.length >= @discard_leading_bytes
 
       @interface.target_names.each do |target_name|
         target_packets = nil
@@ -94,7 +96,7 @@ module Cosmos
 
         if unique_id_mode
           target_packets.each do |packet_name, packet|
-            if packet.identify?(@data[@discard_leading_bytes..-1])
+            if packet.identify?(id_data)
               identified_packet = packet
               break
             end
@@ -103,7 +105,7 @@ module Cosmos
           # Do a hash lookup to quickly identify the packet
           if target_packets.length > 0
             packet = target_packets.first[1]
-            key = packet.read_id_values(@data[@discard_leading_bytes..-1])
+            key = packet.read_id_values(id_data)
             if @telemetry
               hash = System.telemetry.config.tlm_id_value_hash[target_name]
             else
@@ -127,7 +129,7 @@ module Cosmos
           @packet_name = identified_packet.packet_name
 
           # Get the data from this packet
-          packet_data = @data.slice!(0, identified_packet.defined_length + @discard_leading_bytes)
+          packet_data = @data.take(identified_packet.defined_length + @discard_leading_bytes)
           break
         end
       end
@@ -139,8 +141,7 @@ module Cosmos
         @received_time = nil
         @target_name = nil
         @packet_name = nil
-        packet_data = @data.clone
-        @data.replace('')
+        packet_data = @data.take(@data.length)
       end
 
       return packet_data
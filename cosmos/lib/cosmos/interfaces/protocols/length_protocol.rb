@@ -19,6 +19,7 @@
 
 require 'cosmos/packets/binary_accessor'
 require 'cosmos/interfaces/protocols/burst_protocol'
+require 'cosmos/ext/length_protocol' if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT']
 require 'cosmos/config/config_parser'
 
 module Cosmos
@@ -84,6 +85,51 @@ module Cosmos
       @max_length = Integer(@max_length) if @max_length
     end
 
+    def reset
+      super()
+      @frame_lengths = []
+    end
+
+    # @!method find_frames(data, offset = 0)
+    #   Find the lengths of the complete packets at the start of the data so a
+    #   read containing many packets is framed at once. Implemented in C for
+    #   speed.
+    #
+    #   Framing stops at the first packet which is incomplete, doesn't begin
+    #   with the sync pattern, has a length larger than max_length or has a
+    #   length too short to hold the length field. Those cases are handled by
+    #   reduce_to_single_packet. Only byte aligned length fields of 8, 16, 32
+    #   or 64 bits are framed and an empty Array is returned for any other
+    #   length field.
+    #
+    #   @param data [String] Data to frame
+    #   @param offset [Integer] Index of the first packet in data
+    #   @return [Array<Integer>] Length of each complete packet in order
+
+    if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
+      def find_frames(data, offset = 0)
+        frames = []
+        return frames if (@length_bit_offset % 8) != 0 or ![8, 16, 32, 64].include?(@length_bit_size)
+
+        length_bytes_needed = (@length_bit_offset + @length_bit_size) / 8
+        while (data.length - offset) >= length_bytes_needed
+          break if @sync_pattern and data[offset, @sync_pattern.length] != @sync_pattern
+
+          length = BinaryAccessor.read(@length_bit_offset, @length_bit_size, :UINT,
+                                       data[offset, length_bytes_needed], @length_endianness)
+          break if @max_length and length > @max_length
+
+          packet_length = (length * @length_bytes_per_count) + @length_value_offset
+          break if (packet_length * 8) < (@length_bit_offset + @length_bit_size)
+          break if packet_length > (data.length - offset)
+
+          frames << packet_length
+          offset += packet_length
+        end
+        frames
+      end
+    end
+
     # Called to perform modifications on a command packet before it is send
     #
     # @param packet [Packet] Original packet
@@ -134,6 +180,11 @@ module Cosmos
     end
 
     def reduce_to_single_packet
+      # Frame every complete packet at once and hand them out one at a time.
+      # The packets stay in @data until they are taken.
+      @frame_lengths = find_frames(@data.buffer, @data.read_index) if @frame_lengths.empty?
+      return @data.take(@frame_lengths.shift) unless @frame_lengths.empty?
+
       # Make sure we have at least enough data to reach the length field
       return :STOP if @data.length < @length_bytes_needed
 
@@ -141,7 +192,7 @@ module Cosmos
       length = BinaryAccessor.read(@length_bit_offset,
                                    @length_bit_size,
                                    :UINT,
-                                   @data,
+                                   @data.slice(0, @length_bytes_needed),
                                    @length_endianness)
       raise "Length value received larger than max_length: #{length} > #{@max_length}" if @max_length and length > @max_length
 
@@ -156,10 +207,7 @@ module Cosmos
       return :STOP if @data.length < packet_length
 
       # Reduce to packet data and setup current_data for next packet
-      packet_data = @data[0..(packet_length - 1)]
-      @data.replace(@data[packet_length..-1])
-
-      return packet_data
+      return @data.take(packet_length)
     end
   end
 end
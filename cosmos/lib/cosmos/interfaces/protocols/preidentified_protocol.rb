@@ -18,6 +18,7 @@
 # copyright holder
 
 require 'cosmos/interfaces/protocols/burst_protocol'
+require 'cosmos/core_ext/cosmos_io'
 
 module Cosmos
   # Delineates packets using the COSMOS preidentification system
@@ -97,33 +98,40 @@ module Cosmos
     protected
 
     def read_length_field_followed_by_string(length_num_bytes)
-      # Read bytes for string length
-      return :STOP if @data.length < length_num_bytes
+      strings = read_length_fields_followed_by_strings(length_num_bytes, 1)
+      return strings if strings == :STOP
 
-      string_length = @data[0..(length_num_bytes - 1)]
+      return strings[0]
+    end
 
+    # Read and remove several consecutive length fields each followed by a
+    # String. The fields are all parsed with one call so nothing is removed
+    # unless every String is complete.
+    #
+    # @param length_num_bytes [Integer] Number of bytes in each length field
+    # @param count [Integer] Number of Strings to read
+    # @return [Array<String>|Symbol] The Strings or :STOP if they aren't all
+    #   complete
+    def read_length_fields_followed_by_strings(length_num_bytes, count)
       case length_num_bytes
-      when 1
-        string_length = string_length.unpack('C')[0] # UINT8
-      when 2
-        string_length = string_length.unpack('n')[0] # UINT16
+      when 1, 2
+        max_length = nil
       when 4
-        string_length = string_length.unpack('N')[0] # UINT32
-        raise "Length value received larger than max_length: #{string_length} > #{@max_length}" if @max_length and string_length > @max_length
+        max_length = @max_length
       else
         raise "Unsupported length given to read_length_field_followed_by_string: #{length_num_bytes}"
       end
 
-      # Read String
-      return :STOP if @data.length < (string_length + length_num_bytes)
-
-      next_index = string_length + length_num_bytes
-      string = @data[length_num_bytes..(next_index - 1)]
+      fields = CosmosIO.read_length_fields(@data.buffer, @data.read_index, length_num_bytes, count, :BIG_ENDIAN, max_length)
+      return :STOP if fields.length < (count * 2)
 
       # Remove data from current_data
-      @data.replace(@data[next_index..-1])
-
-      return string
+      strings = []
+      fields.each_slice(2) do |_offset, string_length|
+        @data.consume(length_num_bytes)
+        strings << @data.take(string_length)
+      end
+      return strings
     end
 
     def reduce_to_single_packet
@@ -132,7 +140,7 @@ module Cosmos
         if @reduction_state == :START
           return :STOP if @data.length < @sync_pattern.length
 
-          @data.replace(@data[(@sync_pattern.length)..-1])
+          @data.consume(@sync_pattern.length)
           @reduction_state = :SYNC_REMOVED
         end
       elsif @reduction_state == :START
@@ -143,8 +151,7 @@ module Cosmos
         # Read and remove flags
         return :STOP if @data.length < 1
 
-        flags = @data[0].unpack('C')[0] # byte
-        @data.replace(@data[1..-1])
+        flags = @data.take(1).unpack('C')[0] # byte
         @read_stored = false
         @read_stored = true if (flags & COSMOS4_STORED_FLAG_MASK) != 0
         @read_extra = nil
@@ -168,26 +175,17 @@ module Cosmos
         # Read and remove packet received time
         return :STOP if @data.length < 8
 
-        time_seconds = @data[0..3].unpack('N')[0] # UINT32
-        time_microseconds = @data[4..7].unpack('N')[0] # UINT32
+        time_seconds, time_microseconds = @data.take(8).unpack('NN') # UINT32, UINT32
         @read_received_time = Time.at(time_seconds, time_microseconds).sys
-        @data.replace(@data[8..-1])
         @reduction_state = :TIME_REMOVED
       end
 
       if @reduction_state == :TIME_REMOVED
-        # Read and remove the target name
-        @read_target_name = read_length_field_followed_by_string(1)
-        return :STOP if @read_target_name == :STOP
-
-        @reduction_state = :TARGET_NAME_REMOVED
-      end
-
-      if @reduction_state == :TARGET_NAME_REMOVED
-        # Read and remove the packet name
-        @read_packet_name = read_length_field_followed_by_string(1)
-        return :STOP if @read_packet_name == :STOP
+        # Read and remove the target and packet names
+        names = read_length_fields_followed_by_strings(1, 2)
+        return :STOP if names == :STOP
 
+        @read_target_name, @read_packet_name = names
         @reduction_state = :PACKET_NAME_REMOVED
       end
 
@@ -19,6 +19,7 @@
 
 require 'cosmos/config/config_parser'
 require 'cosmos/interfaces/protocols/burst_protocol'
+require 'cosmos/ext/terminated_protocol' if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT']
 
 module Cosmos
   # Protocol which delineates packets using termination characters at
@@ -53,6 +54,46 @@ module Cosmos
       super(discard_leading_bytes, sync_pattern, fill_fields, allow_empty_data)
     end
 
+    def reset
+      super()
+      @frame_lengths = []
+      @search_offset = 0
+    end
+
+    # @!method find_frames(data, offset = 0, search_offset = 0)
+    #   Find the lengths of the complete packets at the start of the data so a
+    #   read containing many lines is framed at once. Implemented in C for
+    #   speed.
+    #
+    #   Framing stops at the first packet without read termination characters
+    #   or which doesn't begin with the sync pattern.
+    #
+    #   @param data [String] Data to frame
+    #   @param offset [Integer] Index of the first packet in data
+    #   @param search_offset [Integer] Number of bytes of the first packet
+    #     already known not to contain the start of the termination characters
+    #   @return [Array<Integer>] Length of each complete packet including the
+    #     read termination characters
+
+    if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
+      def find_frames(data, offset = 0, search_offset = 0)
+        frames = []
+        return frames if @read_termination_characters.empty?
+
+        loop do
+          break if @sync_pattern and data[offset, @sync_pattern.length] != @sync_pattern
+
+          index = data.index(@read_termination_characters, offset + search_offset)
+          break unless index
+
+          frames << (index - offset + @read_termination_characters.length)
+          offset = index + @read_termination_characters.length
+          search_offset = 0
+        end
+        frames
+      end
+    end
+
     def write_data(data)
       raise "Packet contains termination characters!" if data.index(@write_termination_characters)
 
@@ -66,28 +107,31 @@ module Cosmos
     protected
 
     def reduce_to_single_packet
-      index = @data.index(@read_termination_characters)
-
-      # Reduce to packet data and setup current_data for next packet
-      if index
-        if index > 0
-          if @strip_read_termination
-            packet_data = @data[0..(index - 1)]
-          else
-            packet_data = @data[0..(index + @read_termination_characters.length - 1)]
-          end
-        else # @data begins with the termination characters
-          if @strip_read_termination
-            packet_data = ''
-          else # Keep everything
-            packet_data = @data[0..(@read_termination_characters.length - 1)]
+      # Frame every complete packet at once and hand them out one at a time.
+      # The packets stay in @data until they are taken.
+      if @frame_lengths.empty?
+        @frame_lengths = find_frames(@data.buffer, @data.read_index, @search_offset)
+        if @frame_lengths.empty?
+          # Only search the new data next time. The data can't be discarded
+          # while waiting on the rest of a synced packet.
+          if !@sync_pattern or @sync_state == :FOUND
+            @search_offset = @data.length - @read_termination_characters.length + 1
+            @search_offset = 0 if @search_offset < 0
           end
+          return :STOP
         end
-        @data.replace(@data[(index + @read_termination_characters.length)..-1])
-        return packet_data
+        @search_offset = 0
+      end
+
+      # Reduce to packet data and setup current_data for next packet
+      length = @frame_lengths.shift
+      if @strip_read_termination
+        packet_data = @data.take(length - @read_termination_characters.length)
+        @data.consume(@read_termination_characters.length)
       else
-        return :STOP
+        packet_data = @data.take(length)
       end
+      return packet_data
     end
   end
 end
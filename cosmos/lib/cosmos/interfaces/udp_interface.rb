@@ -76,6 +76,8 @@ module Cosmos
       end
       @write_socket = nil
       @read_socket = nil
+      @read_batch_size = 1
+      @read_datagrams = []
       @read_allowed = false unless @read_port
       @write_allowed = false unless @write_dest_port
       @write_raw_allowed = false unless @write_dest_port
@@ -111,6 +113,7 @@ module Cosmos
           @bind_address
         ) if @write_dest_port
       end
+      @read_datagrams = []
       @thread_sleeper = nil
     end
 
@@ -135,6 +138,7 @@ module Cosmos
       Cosmos.close_socket(@read_socket)
       @write_socket = nil
       @read_socket = nil
+      @read_datagrams = []
       @thread_sleeper.cancel if @thread_sleeper
       @thread_sleeper = nil
     end
@@ -148,9 +152,30 @@ module Cosmos
       return nil
     end
 
+    # Reads every packet from the datagrams received by one batched socket
+    # read. Returns a single packet unless the READ_BATCH_SIZE option is set.
+    def read_batch
+      packets = []
+      loop do
+        packet = read()
+        break unless packet
+
+        packets << packet
+        break if @read_datagrams.empty?
+      end
+      return nil if packets.empty?
+
+      packets
+    end
+
     # Reads from the socket if the read_port is defined
     def read_interface
-      data = @read_socket.read(@read_timeout)
+      if @read_batch_size > 1
+        @read_datagrams = @read_socket.read_batch(@read_batch_size, @read_timeout) if @read_datagrams.empty?
+        data = @read_datagrams.shift
+      else
+        data = @read_socket.read(@read_timeout)
+      end
       Logger.info "#{@name}: Udp read returned 0 bytes (stream closed)" if data.length <= 0
       read_interface_base(data)
       return data
@@ -165,5 +190,16 @@ module Cosmos
       @write_socket.write(data, @write_timeout)
       data
     end
+
+    # Supported Options
+    # READ_BATCH_SIZE - Maximum number of datagrams to receive with one system call - Default: 1
+    # (see Interface#set_option)
+    def set_option(option_name, option_values)
+      super(option_name, option_values)
+      case option_name.upcase
+      when 'READ_BATCH_SIZE'
+        @read_batch_size = Integer(option_values[0])
+      end
+    end
   end
 end
@@ -0,0 +1,229 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require 'cosmos/ext/byte_buffer' if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT']
+
+module Cosmos
+  # Growable byte buffer used by the protocols to reassemble packets from a
+  # stream. Bytes are appended to the end and consumed from the front by
+  # advancing a read index so extracting a packet only copies the packet
+  # bytes. The unread bytes are moved back to the front of the buffer during
+  # an append once at least as many bytes have been consumed, which keeps the
+  # cost of moving data constant per byte.
+  #
+  # All offsets are relative to the first unread byte.
+  class ByteBuffer
+    # @return [String] Binary storage. Bytes before {#read_index} have
+    #   already been consumed.
+    attr_reader :buffer
+    # @return [Integer] Index of the first unread byte in {#buffer}
+    attr_reader :read_index
+
+    # @param data [String] Initial contents
+    def initialize(data = '')
+      @buffer = data.b
+      @read_index = 0
+    end
+
+    # @return [Integer] Number of unread bytes
+    def length
+      @buffer.length - @read_index
+    end
+
+    # @return [Boolean] Whether there are no unread bytes
+    def empty?
+      length <= 0
+    end
+
+    # Discard every byte
+    def clear
+      @buffer.clear
+      @read_index = 0
+      nil
+    end
+
+    # @return [String] Copy of the unread bytes
+    def to_s
+      @buffer[@read_index..-1]
+    end
+    alias to_str to_s
+
+    # String compatible methods for protocols written when the pending data
+    # was a String. They work on the unread bytes like the String did but
+    # copy or move data, so new code should use the methods below instead.
+
+    # @param other [ByteBuffer|String] Buffer or String to compare
+    # @return [Boolean] Whether the unread bytes are equal
+    def ==(other)
+      return to_s == other.to_s if other.is_a?(ByteBuffer)
+      return to_s == other if other.is_a?(String)
+
+      false
+    end
+
+    # Unlike {#==} a String is never eql? to a ByteBuffer, which keeps eql?
+    # symmetric for Hash keys.
+    #
+    # @param other [ByteBuffer] Buffer to compare
+    # @return [Boolean] Whether other is a ByteBuffer with the same unread
+    #   bytes
+    def eql?(other)
+      other.is_a?(ByteBuffer) and to_s.eql?(other.to_s)
+    end
+
+    # @return [Integer] Hash of the unread bytes
+    def hash
+      to_s.hash
+    end
+
+    # @param args (see String#[])
+    # @return [String|Integer|nil] Copy of the unread bytes (see String#[])
+    def [](*args)
+      to_s[*args]
+    end
+
+    # @param pattern [String|Regexp] Bytes to find
+    # @param offset [Integer] Offset to start searching
+    # @return [Integer|nil] Offset of the pattern or nil if it wasn't found
+    def index(pattern, offset = 0)
+      return find(pattern, offset) if pattern.is_a?(String) and offset >= 0
+
+      to_s.index(pattern, offset)
+    end
+
+    # Replace the unread bytes
+    #
+    # @param data [String] New contents
+    # @return [ByteBuffer] self
+    def replace(data)
+      data = data.to_s
+      clear()
+      self << data
+    end
+
+    # Remove and return part of the unread bytes. Removing bytes from the
+    # front only advances the read index.
+    #
+    # @param args (see String#slice!)
+    # @return [String|nil] The removed bytes (see String#slice!)
+    def slice!(*args)
+      if args.length == 2 and args[0] == 0 and args[1].is_a?(Integer) and args[1] >= 0
+        return take([args[1], length].min)
+      end
+
+      data = to_s
+      result = data.slice!(*args)
+      replace(data)
+      result
+    end
+
+    # @!method <<(data)
+    #   Append data to the end of the buffer. Implemented in C for speed.
+    #
+    #   @param data [String] Data to append
+    #   @return [ByteBuffer] self
+
+    # @!method peek(offset)
+    #   @param offset [Integer] Offset of the byte
+    #   @return [Integer|nil] Byte at offset or nil if offset is past the end
+
+    # @!method find(pattern, offset = 0)
+    #   @param pattern [String] Bytes to find
+    #   @param offset [Integer] Offset to start searching
+    #   @return [Integer|nil] Offset of the pattern or nil if it wasn't found
+
+    # @!method consume(length)
+    #   Discard bytes from the front of the buffer without copying them
+    #
+    #   @param length [Integer] Number of bytes to discard
+    #   @return [nil]
+
+    # @!method slice(offset, length = nil)
+    #   Copy bytes without consuming them
+    #
+    #   @param offset [Integer] Offset of the first byte
+    #   @param length [Integer] Number of bytes. Defaults to the rest of the
+    #     unread bytes.
+    #   @return [String] Copy of the bytes
+
+    # @!method take(length)
+    #   Copy and consume bytes from the front of the buffer
+    #
+    #   @param length [Integer] Number of bytes
+    #   @return [String] Copy of the bytes
+
+    if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
+      def <<(data)
+        if @read_index > 0 and @read_index >= length
+          @buffer = @buffer[@read_index..-1]
+          @read_index = 0
+        end
+        @buffer << data
+        self
+      end
+
+      def peek(offset)
+        return nil if offset < 0
+
+        @buffer.getbyte(@read_index + offset)
+      end
+
+      def find(pattern, offset = 0)
+        return nil if offset < 0 or offset > length
+
+        index = @buffer.index(pattern, @read_index + offset)
+        return index - @read_index if index
+
+        nil
+      end
+
+      def consume(length)
+        check_range(0, length)
+        advance(length)
+        nil
+      end
+
+      def slice(offset, length = nil)
+        length = self.length - offset unless length
+        check_range(offset, length)
+        @buffer[@read_index + offset, length]
+      end
+
+      def take(length)
+        check_range(0, length)
+        result = @buffer[@read_index, length]
+        advance(length)
+        result
+      end
+
+      protected
+
+      def check_range(offset, length)
+        if offset < 0 or length < 0 or offset > self.length or length > (self.length - offset)
+          raise IndexError, "Range #{offset}, #{length} outside of the #{self.length} bytes in the buffer"
+        end
+      end
+
+      def advance(length)
+        @read_index += length
+        clear() if @read_index == @buffer.length
+      end
+    end
+  end
+end
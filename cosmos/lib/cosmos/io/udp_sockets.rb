@@ -20,6 +20,7 @@
 require 'socket'
 require 'ipaddr'
 require 'timeout' # for Timeout::Error
+require 'cosmos/ext/udp_sockets' if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT']
 
 # Define needed constants for Windows
 Socket::IP_MULTICAST_IF = 9 unless Socket.const_defined?('IP_MULTICAST_IF')
@@ -123,6 +124,46 @@ module Cosmos
       data
     end
 
+    # Reads every datagram already waiting on the socket, up to max_count,
+    # with a single system call. Waits for the first datagram like {#read}.
+    #
+    # @param max_count [Integer] Maximum number of datagrams to return
+    # @param read_timeout [Float] Time in seconds to wait for the first
+    #   datagram
+    # @return [Array<String>] Datagrams in the order received
+    def read_batch(max_count, read_timeout = nil)
+      loop do
+        datagrams = recv_batch_nonblock(max_count)
+        return datagrams if datagrams
+
+        result = IO.fast_select([@socket], nil, nil, read_timeout)
+        raise Timeout::Error, "Read Timeout" unless result
+      end
+    end
+
+    # @!method recv_batch_nonblock(max_count)
+    #   Reads the datagrams waiting on the socket into a preallocated buffer
+    #   without blocking. Implemented in C with recvmmsg where available.
+    #
+    #   @param max_count [Integer] Maximum number of datagrams to read
+    #   @return [Array<String>|nil] Datagrams or nil if there weren't any
+
+    if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
+      def recv_batch_nonblock(max_count)
+        datagrams = []
+        while datagrams.length < max_count
+          data, _ = @socket.recvfrom_nonblock(65536, exception: false)
+          break if data == :wait_readable
+
+          datagrams << data
+        end
+        return nil if datagrams.empty?
+
+        datagrams
+      end
+      protected :recv_batch_nonblock
+    end
+
     # Defer all methods to the UDPSocket
     def method_missing(method, *args, &block)
       @socket.__send__(method, *args, &block)
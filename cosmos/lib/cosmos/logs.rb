@@ -18,6 +18,9 @@
 # copyright holder
 
 module Cosmos
+  autoload(:ColumnLogReader, 'cosmos/logs/column_log_reader.rb')
+  autoload(:ColumnLogWriter, 'cosmos/logs/column_log_writer.rb')
+  autoload(:LogWriteBuffer, 'cosmos/logs/log_write_buffer.rb')
   autoload(:PacketLogWriter, 'cosmos/logs/packet_log_writer.rb')
   autoload(:PacketLogWriterPair, 'cosmos/logs/packet_log_writer_pair.rb')
   autoload(:PacketLogReader, 'cosmos/logs/packet_log_reader.rb')
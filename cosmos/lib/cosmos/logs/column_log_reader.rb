@@ -0,0 +1,177 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require 'json'
+require 'cosmos/logs/packet_log_constants'
+require 'cosmos/ext/column_log_reader' if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT']
+
+module Cosmos
+  # Reads columns from a file created by {ColumnLogWriter}. Only the bytes
+  # of the requested column range are read from the file.
+  class ColumnLogReader
+    include PacketLogConstants
+
+    # @return [String] Columnar filename
+    attr_reader :filename
+    # @return [String] Target name
+    attr_reader :target_name
+    # @return [String] Packet name
+    attr_reader :packet_name
+    # @return [Integer] Number of packets (rows)
+    attr_reader :count
+
+    # @param filename [String] Columnar file created by {ColumnLogWriter}
+    def initialize(filename)
+      @filename = filename
+      File.open(@filename, 'rb') do |file|
+        header = file.read(COSMOS5_HEADER_LENGTH + 4)
+        if !header or header.length != (COSMOS5_HEADER_LENGTH + 4) or header[0, COSMOS5_HEADER_LENGTH] != COSMOS5_COLUMN_FILE_HEADER
+          raise "COSMOS column file header not found"
+        end
+
+        json_length = header[COSMOS5_HEADER_LENGTH, 4].unpack('N')[0]
+        description = JSON.parse(file.read(json_length))
+        header_length = COSMOS5_HEADER_LENGTH + 4 + json_length
+        @data_offset = ((header_length + COSMOS5_COLUMN_ALIGNMENT - 1) / COSMOS5_COLUMN_ALIGNMENT) * COSMOS5_COLUMN_ALIGNMENT
+        @target_name = description['target_name']
+        @packet_name = description['packet_name']
+        @count = description['count']
+        @time = description['time']
+        @columns = {}
+        description['columns'].each { |column| @columns[column['name']] = column }
+      end
+    end
+
+    # @return [Array<String>] Names of the item columns
+    def column_names
+      @columns.keys
+    end
+
+    # @param name [String] Item name
+    # @return [String] Column type, one of the COSMOS5_COLUMN_TYPES keys
+    def column_type(name)
+      column(name)['type']
+    end
+
+    # @param name [String] Item name
+    # @param first [Integer] Index of the first value to read
+    # @param count [Integer|nil] Number of values to read. Defaults to the
+    #   rest of the column.
+    # @return [Array<Numeric|nil>] Column values. Values missing because the
+    #   packet was too short to hold the item are nil.
+    def read_column(name, first = 0, count = nil)
+      column = column(name)
+      values = read_range(column, first, count)
+      clear_missing(column, first, values) if column['valid_offset']
+      values
+    end
+
+    # @param first (see #read_column)
+    # @param count (see #read_column)
+    # @return [Array<Integer>] Packet times in nanoseconds since the epoch
+    def read_times(first = 0, count = nil)
+      read_range(@time, first, count)
+    end
+
+    # Find the rows within a time range using a binary search of the time
+    # column. Assumes the packets were logged in time order.
+    #
+    # @param start_time_nsec [Integer|nil] Start time in nanoseconds since the epoch
+    # @param end_time_nsec [Integer|nil] End time in nanoseconds since the epoch
+    # @return [Array<Integer>] The first row and number of rows in the range
+    #   suitable for passing to {#read_column}
+    def time_range(start_time_nsec, end_time_nsec)
+      first = start_time_nsec ? lower_bound { |time| time < start_time_nsec } : 0
+      last = end_time_nsec ? lower_bound { |time| time <= end_time_nsec } : @count
+      last = first if last < first
+      return first, last - first
+    end
+
+    # @!method read_values(offset, type, count)
+    #   Read values from the file. Implemented in C by memory mapping only
+    #   the pages holding the values.
+    #
+    #   @param offset [Integer] File offset of the first value
+    #   @param type [String] Column type
+    #   @param count [Integer] Number of values
+    #   @return [Array<Numeric>]
+
+    if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
+      def read_values(offset, type, count)
+        directive, size = COSMOS5_COLUMN_TYPES[type]
+        raise "Unknown column type #{type}" unless directive
+        return [] if count <= 0
+
+        data = File.binread(@filename, count * size, offset)
+        raise "Column data truncated" if !data or data.length != (count * size)
+
+        data.unpack("#{directive}#{count}")
+      end
+    end
+
+    protected
+
+    def column(name)
+      column = @columns[name.to_s.upcase]
+      raise "Column #{name} not found" unless column
+
+      column
+    end
+
+    def read_range(column, first, count)
+      first = 0 if first < 0
+      count = @count - first if !count or (first + count) > @count
+      return [] if count <= 0
+
+      size = COSMOS5_COLUMN_TYPES[column['type']][1]
+      read_values(@data_offset + column['offset'] + (first * size), column['type'], count)
+    end
+
+    # Replace the values whose bit in the column's validity bitmap is clear
+    # with nil
+    def clear_missing(column, first, values)
+      return if values.empty?
+
+      first = 0 if first < 0
+      first_byte = first / 8
+      last_byte = (first + values.length - 1) / 8
+      bitmap = File.binread(@filename, last_byte - first_byte + 1, @data_offset + column['valid_offset'] + first_byte)
+      raise "Column data truncated" if !bitmap or bitmap.length != (last_byte - first_byte + 1)
+
+      bits = bitmap.unpack('b*')[0]
+      bit_offset = first - (first_byte * 8)
+      values.each_index { |index| values[index] = nil if bits[bit_offset + index] == '0' }
+    end
+
+    # @return [Integer] The first row for which the block returns false
+    def lower_bound
+      low = 0
+      high = @count
+      while low < high
+        mid = (low + high) / 2
+        if yield(read_times(mid, 1)[0])
+          low = mid + 1
+        else
+          high = mid
+        end
+      end
+      low
+    end
+  end
+end
@@ -0,0 +1,209 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require 'json'
+require 'tempfile'
+require 'cosmos/logs/packet_log_constants'
+require 'cosmos/logs/packet_log_reader'
+
+module Cosmos
+  # Converts the packets of a COSMOS 5 raw log into a columnar file with a
+  # time column and one typed column per item. Only numeric items which are
+  # not arrays or derived are exported and their RAW values are stored using
+  # the smallest standard integer or float type which holds the item.
+  # Columns with values missing from packets too short to hold the item are
+  # followed by a validity bitmap. The missing values are stored as NaN in
+  # float columns and 0 in integer columns and a single warning summarizes
+  # them once the log is converted.
+  # See {ColumnLogReader} to read the columns.
+  class ColumnLogWriter
+    include PacketLogConstants
+
+    # Number of values packed at once and written to the column temp files
+    BATCH_SIZE = 65536
+
+    # @param log_filename [String] COSMOS 5 raw log file
+    # @param filename [String] Columnar file to create
+    # @param target_name [String] Target name
+    # @param packet_name [String] Packet name
+    # @param item_names [Array<String>|nil] Items to export. Defaults to every
+    #   supported item in the packet.
+    # @return [Integer] Number of packets exported
+    def self.convert(log_filename, filename, target_name, packet_name, item_names = nil)
+      new(target_name, packet_name, item_names).convert(log_filename, filename)
+    end
+
+    # @param item [StructureItem] Item to check
+    # @return [String|nil] Column type for the item or nil if not supported
+    def self.column_type(item)
+      return nil if item.array_size or item.bit_size <= 0 or item.bit_size > 64
+
+      case item.data_type
+      when :INT, :UINT
+        size = [8, 16, 32, 64].find { |bits| item.bit_size <= bits }
+        "#{item.data_type}#{size}"
+      when :FLOAT
+        "FLOAT#{item.bit_size}"
+      end
+    end
+
+    # @param target_name (see .convert)
+    # @param packet_name (see .convert)
+    # @param item_names (see .convert)
+    def initialize(target_name, packet_name, item_names = nil)
+      @target_name = target_name
+      @packet_name = packet_name
+      @item_names = item_names
+    end
+
+    # @param log_filename (see .convert)
+    # @param filename (see .convert)
+    # @return (see .convert)
+    def convert(log_filename, filename)
+      @count = 0
+      @short_count = 0
+      @columns = nil
+      @times = []
+      @time_file = Tempfile.new('column')
+      @time_file.binmode
+      PacketLogReader.new.each_entry(log_filename) do |cmd_or_tlm, target_name, packet_name, time_nsec_since_epoch, _, data|
+        next unless target_name == @target_name and packet_name == @packet_name
+
+        setup_columns(cmd_or_tlm) unless @columns
+        @times << time_nsec_since_epoch
+        short = false
+        @columns.each do |column|
+          item = column[:item]
+          begin
+            column[:values] << BinaryAccessor.read(item.bit_offset, item.bit_size, item.data_type, data, item.endianness)
+          rescue
+            # Packet is too short to hold the item
+            column[:values] << (item.data_type == :FLOAT ? Float::NAN : 0)
+            column[:missing] << @count
+            short = true
+          end
+        end
+        @short_count += 1 if short
+        @count += 1
+        write_batch() if @times.length >= BATCH_SIZE
+      end
+      @columns ||= []
+      write_batch()
+      write_file(filename)
+      warn_missing() if @short_count > 0
+      @count
+    ensure
+      @time_file.close! if @time_file
+      @columns.each { |column| column[:file].close! } if @columns
+    end
+
+    protected
+
+    def setup_columns(cmd_or_tlm)
+      if cmd_or_tlm == :CMD
+        packet = System.commands.packet(@target_name, @packet_name)
+      else
+        packet = System.telemetry.packet(@target_name, @packet_name)
+      end
+      if @item_names
+        items = @item_names.map { |name| packet.get_item(name) }
+      else
+        items = packet.sorted_items.select { |item| ColumnLogWriter.column_type(item) }
+      end
+      @columns = items.map do |item|
+        type = ColumnLogWriter.column_type(item)
+        raise "Item #{item.name} can not be exported to a column" unless type
+
+        file = Tempfile.new('column')
+        file.binmode
+        { item: item, type: type, values: [], missing: [], file: file }
+      end
+    end
+
+    def write_batch
+      @time_file.write(@times.pack("q<#{@times.length}"))
+      @times.clear
+      @columns.each do |column|
+        directive = COSMOS5_COLUMN_TYPES[column[:type]][0]
+        column[:file].write(column[:values].pack("#{directive}#{column[:values].length}"))
+        column[:values].clear
+      end
+    end
+
+    def write_file(filename)
+      offset = 0
+      description = { 'target_name' => @target_name, 'packet_name' => @packet_name, 'count' => @count }
+      description['time'] = { 'type' => 'INT64', 'offset' => offset }
+      offset += align(@time_file.size)
+      description['columns'] = []
+      @columns.each do |column|
+        description['columns'] << { 'name' => column[:item].name, 'type' => column[:type], 'offset' => offset }
+        offset += align(column[:file].size)
+      end
+      bitmaps = []
+      @columns.each_with_index do |column, index|
+        next if column[:missing].empty?
+
+        bitmap = validity_bitmap(column[:missing])
+        description['columns'][index]['valid_offset'] = offset
+        offset += align(bitmap.length)
+        bitmaps << bitmap
+      end
+      json = JSON.generate(description).b
+
+      File.open(filename, 'wb') do |file|
+        header = String.new
+        header << COSMOS5_COLUMN_FILE_HEADER << [json.bytesize].pack('N') << json
+        file.write(header)
+        file.write("\x00" * (align(header.length) - header.length))
+        ([@time_file] + @columns.map { |column| column[:file] }).each do |column_file|
+          column_file.rewind
+          IO.copy_stream(column_file, file)
+          file.write("\x00" * (align(column_file.size) - column_file.size))
+        end
+        bitmaps.each do |bitmap|
+          file.write(bitmap)
+          file.write("\x00" * (align(bitmap.length) - bitmap.length))
+        end
+      end
+    end
+
+    # Log how many packets were too short and how many values of each item
+    # are missing
+    def warn_missing
+      items = @columns.reject { |column| column[:missing].empty? }.map do |column|
+        "#{column[:item].name} (#{column[:missing].length})"
+      end
+      Logger.warn "#{@target_name} #{@packet_name} #{@short_count} of #{@count} packets are too short to hold #{items.join(', ')}"
+    end
+
+    # @param missing [Array<Integer>] Rows without a value
+    # @return [String] One bit per row, least significant bit first, which
+    #   is set if the row has a value
+    def validity_bitmap(missing)
+      bits = '1' * @count
+      missing.each { |row| bits[row] = '0' }
+      [bits].pack('b*')
+    end
+
+    def align(length)
+      ((length + COSMOS5_COLUMN_ALIGNMENT - 1) / COSMOS5_COLUMN_ALIGNMENT) * COSMOS5_COLUMN_ALIGNMENT
+    end
+  end
+end
@@ -0,0 +1,107 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require 'zlib'
+require 'cosmos/logs/packet_log_constants'
+
+module Cosmos
+  # Reads the entries of a compressed COSMOS 5 log file as if it were an
+  # uncompressed file. Blocks are decompressed one at a time as entries are
+  # read so only the blocks which are needed are decompressed.
+  class CompressedLogFile
+    include PacketLogConstants
+
+    # @param file [File] Log file positioned at the start of a block
+    def initialize(file)
+      @file = file
+      @block = String.new
+      @block_index = 0
+    end
+
+    # Read decompressed data
+    #
+    # @param length [Integer] Number of bytes to read
+    # @return [String|nil] Data read or nil at the end of the file
+    def read(length)
+      while (@block.length - @block_index) < length
+        break unless read_block()
+      end
+      return nil if @block_index >= @block.length
+
+      data = @block[@block_index, length]
+      @block_index += data.length
+      data
+    end
+
+    # Position the file at the start of a block
+    #
+    # @param offset [Integer] File offset of a block header
+    # @param whence [Integer] Must be IO::SEEK_SET
+    def seek(offset, whence = IO::SEEK_SET)
+      raise ArgumentError, "Compressed logs only support IO::SEEK_SET" unless whence == IO::SEEK_SET
+
+      @block.clear
+      @block_index = 0
+      @file.seek(offset, whence)
+    end
+
+    # @return [Integer] Compressed file position of the next block
+    def pos
+      @file.pos
+    end
+
+    # @return [Integer] Compressed file size
+    def size
+      @file.size
+    end
+
+    def close
+      @file.close
+    end
+
+    def closed?
+      @file.closed?
+    end
+
+    protected
+
+    # Decompress the next block and append it to any unread data
+    #
+    # @return [Boolean] Whether a block was read
+    def read_block
+      header = @file.read(COSMOS5_BLOCK_HEADER_SIZE)
+      return false if !header or header.length < COSMOS5_BLOCK_HEADER_SIZE
+
+      compressed_length, length = header.unpack(COSMOS5_BLOCK_HEADER_PACK_DIRECTIVE)
+      compressed = @file.read(compressed_length)
+      raise "Truncated compressed block" if !compressed or compressed.length != compressed_length
+
+      data = Zlib::Inflate.inflate(compressed)
+      raise "Invalid compressed block length #{data.length}, expected #{length}" if data.length != length
+
+      if @block_index >= @block.length
+        @block = data
+      else
+        @block = @block[@block_index..-1] << data
+      end
+      @block_index = 0
+      true
+    end
+  end
+end
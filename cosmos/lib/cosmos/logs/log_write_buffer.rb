@@ -0,0 +1,143 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require 'cosmos/ext/log_write_buffer' if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT']
+
+module Cosmos
+  # Write behind buffer for a log file and its optional index file. Entries
+  # are copied into memory and written to the files once flush_size bytes
+  # are buffered. The buffered data and the entry which filled the buffer are
+  # written with a single writev and any buffered index data is written at
+  # the same time so each flush is one system call per file. If a write fails
+  # the bytes which weren't written stay buffered and are written by the next
+  # write or flush.
+  #
+  # The files are written directly so nothing else should write to them
+  # while the buffer is in use. Not thread safe, callers must synchronize.
+  class LogWriteBuffer
+    DEFAULT_FLUSH_SIZE = 65536
+
+    # @return [File] Log file
+    attr_reader :file
+    # @return [File|nil] Index file
+    attr_reader :index_file
+    # @return [Integer] Number of bytes to buffer before writing
+    attr_reader :flush_size
+
+    # @param file [File] Log file to write
+    # @param index_file [File|nil] Index file to write
+    # @param flush_size [Integer] Number of bytes to buffer before writing
+    def initialize(file, index_file = nil, flush_size = DEFAULT_FLUSH_SIZE)
+      @file = file
+      @index_file = index_file
+      @flush_size = Integer(flush_size)
+      # Bypass the IO buffer so data can't be reordered with our writes
+      @file.sync = true
+      @fd = @file.fileno
+      @buffer = String.new(capacity: @flush_size)
+      if @index_file
+        @index_file.sync = true
+        @index_fd = @index_file.fileno
+        @index_buffer = String.new(capacity: @flush_size)
+      else
+        @index_fd = nil
+        @index_buffer = nil
+      end
+      @unsynced = false
+    end
+
+    # @return [Integer] Number of bytes waiting to be written
+    def buffered
+      @buffer.length + (@index_buffer ? @index_buffer.length : 0)
+    end
+
+    # @!method write(data, index_data = nil)
+    #   Buffer data for the log file and optionally the index file. Writes
+    #   both files once the log file buffer reaches flush_size.
+    #   Implemented in C using writev without holding the GVL. The Ruby
+    #   implementation copies data into the buffer before writing.
+    #
+    #   @param data [String] Data to write to the log file
+    #   @param index_data [String|nil] Data to write to the index file
+    #   @return [nil]
+
+    # @!method flush
+    #   Write all buffered data to the files
+    #   @return [nil]
+
+    # @!method sync
+    #   Write all buffered data and fdatasync the files so they are durable
+    #   @return [nil]
+
+    if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
+      def write(data, index_data = nil)
+        if index_data
+          raise ArgumentError, "No index file to write index data" unless @index_buffer
+
+          @index_buffer << index_data
+        end
+        if (@buffer.length + data.length) < @flush_size
+          @buffer << data
+          return nil if !@index_buffer or @index_buffer.length < @flush_size
+
+          data = nil
+        end
+        @buffer << data if data
+        @unsynced = true
+        write_buffers()
+        nil
+      end
+
+      def flush
+        @unsynced = true if buffered() > 0
+        write_buffers()
+        nil
+      end
+
+      def sync
+        return nil if !@unsynced and buffered() == 0
+
+        flush()
+        @file.fdatasync
+        @index_file.fdatasync if @index_file
+        @unsynced = false
+        nil
+      end
+
+      protected
+
+      # Write both buffers. The index buffer is written even if writing the
+      # log file fails just like the C implementation.
+      def write_buffers
+        write_buffer(@file, @buffer)
+      ensure
+        write_buffer(@index_file, @index_buffer) if @index_buffer
+      end
+
+      # Write the buffer to the file removing each chunk as it is written.
+      # If the write fails whatever wasn't written is left in the buffer.
+      def write_buffer(file, buffer)
+        until buffer.empty?
+          written = file.syswrite(buffer)
+          buffer.slice!(0, written)
+        end
+      end
+    end
+  end
+end
@@ -21,6 +21,7 @@ require 'thread'
 require 'cosmos/config/config_parser'
 require 'cosmos/topics/topic'
 require 'cosmos/utilities/s3'
+require 'cosmos/logs/log_write_buffer'
 
 module Cosmos
   # Creates a log. Can automatically cycle the log based on an elasped
@@ -52,6 +53,15 @@ module Cosmos
     # @return [Mutex] Instance mutex protecting file
     attr_reader :mutex
 
+    # @return [Float|nil] Maximum number of seconds data is buffered before
+    #   being written to the log file
+    attr_reader :flush_interval
+
+    # @return [Symbol|Integer] Durability policy. :NONE never syncs the log
+    #   file, :ROTATE syncs when the log file is closed and an Integer
+    #   syncs every that many milliseconds.
+    attr_reader :durability
+
     # The cycle time interval. Cycle times are only checked at this level of
     # granularity.
     CYCLE_TIME_INTERVAL = 10
@@ -68,6 +78,19 @@ module Cosmos
     # Sleeper used to delay cycle thread
     @@cycle_sleeper = nil
 
+    # The flush interval granularity. Buffered data is only checked for flushing
+    # and syncing at this interval.
+    FLUSH_CHECK_INTERVAL = 0.1
+
+    # Array of instances with a flush interval or periodic durability
+    @@flush_instances = []
+
+    # Thread used to flush and sync buffered log writers
+    @@flush_thread = nil
+
+    # Sleeper used to delay flush thread
+    @@flush_sleeper = nil
+
     # @param remote_log_directory [String] The s3 path to store the log files
     # @param logging_enabled [Boolean] Whether to start with logging enabled
     # @param cycle_time [Integer] The amount of time in seconds before creating
@@ -83,6 +106,13 @@ module Cosmos
     #   for more information.
     # @param redis_topic [String] The key of the Redis stream to trim when files are
     #   moved to S3
+    # @param flush_size [Integer] Number of bytes to buffer before writing to
+    #   the log file
+    # @param flush_interval [Float|nil] Maximum number of seconds to buffer
+    #   data before writing to the log file. nil to only flush on size.
+    # @param durability [String|Symbol|Integer] NONE to leave syncing to the
+    #   OS, ROTATE to fdatasync when the log file is closed or the number of
+    #   milliseconds between fdatasync calls
     def initialize(
       remote_log_directory,
       logging_enabled = true,
@@ -90,7 +120,10 @@ module Cosmos
       cycle_size = 1000000000,
       cycle_hour = nil,
       cycle_minute = nil,
-      redis_topic: nil
+      redis_topic: nil,
+      flush_size: LogWriteBuffer::DEFAULT_FLUSH_SIZE,
+      flush_interval: 1.0,
+      durability: :NONE
     )
       @remote_log_directory = remote_log_directory
       @logging_enabled = ConfigParser.handle_true_false(logging_enabled)
@@ -116,6 +149,22 @@ module Cosmos
       @last_offset = nil
       @previous_file_redis_offset = nil
       @redis_topic = redis_topic
+      @buffer = nil
+      @flush_size = Integer(flush_size)
+      @flush_interval = ConfigParser.handle_nil(flush_interval)
+      @flush_interval = Float(@flush_interval) if @flush_interval
+      @durability = ConfigParser.handle_nil(durability)
+      case @durability
+      when nil, 'NONE', :NONE
+        @durability = :NONE
+      when 'ROTATE', :ROTATE
+        @durability = :ROTATE
+      else
+        @durability = Integer(@durability)
+        raise "durability must be NONE, ROTATE or a positive number of milliseconds" if @durability <= 0
+      end
+      @last_flush_time = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      @last_sync_time = @last_flush_time
 
       # This is an optimization to avoid creating a new entry object
       # each time we create an entry which we do a LOT!
@@ -132,6 +181,18 @@ module Cosmos
           end
         end
       end
+
+      if @flush_interval or @durability.is_a?(Integer)
+        @@mutex.synchronize do
+          @@flush_instances << self
+
+          unless @@flush_thread
+            @@flush_thread = Cosmos.safe_thread("Log flush") do
+              flush_thread_body()
+            end
+          end
+        end
+      end
     end
 
     # Starts a new log file by closing the existing log file. New log files are
@@ -156,6 +217,12 @@ module Cosmos
           Cosmos.kill_thread(self, @@cycle_thread) if @@cycle_thread
           @@cycle_thread = nil
         end
+        @@flush_instances.delete(self)
+        if @@flush_instances.length <= 0
+          @@flush_sleeper.cancel if @@flush_sleeper
+          Cosmos.kill_thread(self, @@flush_thread) if @@flush_thread
+          @@flush_thread = nil
+        end
       end
     end
 
@@ -217,6 +284,50 @@ module Cosmos
       end
     end
 
+    def flush_thread_body
+      @@flush_sleeper = Sleeper.new
+      while true
+        @@mutex.synchronize do
+          @@flush_instances.each do |instance|
+            instance.mutex.synchronize do
+              instance.flush_buffer(Process.clock_gettime(Process::CLOCK_MONOTONIC))
+            end
+          end
+        end
+        break if @@flush_sleeper.sleep(FLUSH_CHECK_INTERVAL)
+      end
+    end
+
+    # Flush buffered data if the flush interval has passed and sync the log
+    # file if the durability interval has passed. Errors are logged but not
+    # raised. Data which failed to write stays in the buffer and is written
+    # again by the next write or flush.
+    # Assumes mutex has already been taken
+    #
+    # @param now [Float] Monotonic time in seconds
+    def flush_buffer(now)
+      return unless @buffer
+
+      if @durability.is_a?(Integer) and ((now - @last_sync_time) * 1000) >= @durability
+        write_pending()
+        @buffer.sync
+        @last_sync_time = now
+        @last_flush_time = now
+      elsif @flush_interval and (now - @last_flush_time) >= @flush_interval
+        write_pending()
+        @buffer.flush
+        @last_flush_time = now
+      end
+    rescue => err
+      Logger.error "Error flushing #{@filename} : #{err.formatted}"
+    end
+
+    # Write any data held back from the buffer so a flush or sync includes it.
+    # Subclasses which hold data back must override this.
+    # Assumes mutex has already been taken
+    def write_pending
+    end
+
     # Starting a new log file is a critical operation so the entire method is
     # wrapped with a rescue and handled with handle_critical_exception
     # Assumes mutex has already been taken
@@ -226,6 +337,7 @@ module Cosmos
       # Start log file
       @filename = create_unique_filename()
       @file = File.new(@filename, 'wb')
+      @buffer = LogWriteBuffer.new(@file, nil, @flush_size)
       @file_size = 0
 
       @start_time = Time.now.utc
@@ -253,6 +365,13 @@ module Cosmos
       begin
         if @file
           begin
+            if @buffer
+              if @durability == :NONE
+                @buffer.flush
+              else
+                @buffer.sync
+              end
+            end
             @file.close unless @file.closed?
             Logger.debug "Log File Closed : #{@filename}"
             date = first_timestamp[0..7] # YYYYMMDD
@@ -267,6 +386,7 @@ module Cosmos
           end
 
           @file = nil
+          @buffer = nil
           @file_size = 0
           @filename = nil
         end
@@ -58,5 +58,48 @@ module Cosmos
     COSMOS5_PACKET_SECONDARY_FIXED_SIZE = 10
     COSMOS5_PACKET_PACK_DIRECTIVE = 'NnnQ>'.freeze
     COSMOS5_PACKET_PACK_ITEMS = 4 # Useful for testing
+
+    # Index file entries are the packet entry header followed by the file offset
+    COSMOS5_INDEX_ENTRY_SIZE = 24
+    COSMOS5_INDEX_PACK_DIRECTIVE = 'NnnQ>Q>'.freeze
+    COSMOS5_INDEX_TIME_OFFSET = 8
+    COSMOS5_INDEX_FILE_OFFSET = 16
+
+    # Compressed variant where entries are grouped into zlib compressed blocks.
+    # Each block is [compressed length N][uncompressed length N][deflate data]
+    # and holds complete entries in the format above.
+    COSMOS5_COMPRESSED_FILE_HEADER = 'COSMOS5Z'.freeze
+    COSMOS5_COMPRESSED_INDEX_HEADER = 'COSIDX5Z'.freeze
+    COSMOS5_BLOCK_SIZE = 65536 # Uncompressed bytes per block
+    COSMOS5_BLOCK_HEADER_SIZE = 8
+    COSMOS5_BLOCK_HEADER_PACK_DIRECTIVE = 'NN'.freeze
+    # Compressed index files have an entry per block rather than per packet:
+    # file offset, first time, last time, first packet number, packet count
+    COSMOS5_BLOCK_INDEX_ENTRY_SIZE = 36
+    COSMOS5_BLOCK_INDEX_PACK_DIRECTIVE = 'Q>Q>Q>Q>N'.freeze
+
+    # Optional summary section at the end of the index footer (after the
+    # packet declarations). The header is followed by the length of a JSON
+    # summary of the packets (and optionally items) in the log.
+    COSMOS5_SUMMARY_HEADER = 'COSSUM5_'.freeze
+
+    # Columnar export of a single packet from a log. The header is followed by
+    # a JSON description of the columns and then each column as a contiguous
+    # little endian array aligned to COSMOS5_COLUMN_ALIGNMENT bytes.
+    COSMOS5_COLUMN_FILE_HEADER = 'COSCOL5_'.freeze
+    COSMOS5_COLUMN_ALIGNMENT = 8
+    # Column type => [pack directive, byte size]
+    COSMOS5_COLUMN_TYPES = {
+      'INT8' => ['c', 1],
+      'UINT8' => ['C', 1],
+      'INT16' => ['s<', 2],
+      'UINT16' => ['S<', 2],
+      'INT32' => ['l<', 4],
+      'UINT32' => ['L<', 4],
+      'INT64' => ['q<', 8],
+      'UINT64' => ['Q<', 8],
+      'FLOAT32' => ['e', 4],
+      'FLOAT64' => ['E', 8],
+    }.freeze
   end
 end
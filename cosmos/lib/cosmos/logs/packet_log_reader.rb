@@ -17,11 +17,15 @@
 # enterprise edition license of COSMOS if purchased from the
 # copyright holder
 
+require 'json'
 require 'cosmos/core_ext/io'
 require 'cosmos/packets/packet'
 require 'cosmos/packets/json_packet'
+require 'cosmos/packets/packet_view'
 require 'cosmos/io/buffered_file'
 require 'cosmos/logs/packet_log_constants'
+require 'cosmos/logs/compressed_log_file'
+require 'cosmos/ext/packet_log_reader' if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT']
 
 module Cosmos
   # Reads a packet log of either commands or telemetry.
@@ -49,13 +53,16 @@ module Cosmos
     # @param end_time [Time|nil] Time at which to stop returning packets.
     #   Packets found with a timestamp after this time are ignored. Pass nil
     #   to return all packets.
+    # @param index_filename [String|nil] The index file which accompanies the
+    #   log file. If given the start_time is found with a binary search of the
+    #   index rather than by reading every packet before it.
     # @yieldparam packet [Packet]
     # @return [Boolean] Whether we reached the end_time while reading
-    def each(filename, identify_and_define = true, start_time = nil, end_time = nil)
+    def each(filename, identify_and_define = true, start_time = nil, end_time = nil, index_filename: nil)
       reached_end_time = false
-      open(filename)
+      open(filename, index_filename)
 
-      # seek_to_time(start_time) if start_time
+      seek_to_time(start_time) if start_time and @index_file
 
       while true
         packet = read(identify_and_define)
@@ -79,17 +86,22 @@ module Cosmos
     end
 
     # @param filename [String] The log filename to open
+    # @param index_filename [String|nil] The index file which accompanies the
+    #   log file. The target and packet declarations are loaded from the index
+    #   so {#seek_to_time} and {#read_at_offset} can be used immediately.
     # @return [Boolean, Exception] Returns true if successfully changed to configuration specified in log,
     #    otherwise returns false and potentially an Exception class if an error occurred.  If no error occurred
     #    false indicates that the requested configuration was simply not found.
-    def open(filename)
+    def open(filename, index_filename = nil)
       close()
       reset()
       @filename = filename
       @file = BufferedFile.open(@filename, 'rb')
       @max_read_size = @file.size
       @max_read_size = MAX_READ_SIZE if @max_read_size > MAX_READ_SIZE
-      return read_file_header()
+      result = read_file_header()
+      open_index(index_filename) if index_filename
+      return result
     rescue => err
       close()
       raise err
@@ -98,6 +110,80 @@ module Cosmos
     # Closes the current log file
     def close
       @file.close if @file and !@file.closed?
+      @index_file.close if @index_file and !@index_file.closed?
+    end
+
+    # Position the log file at the first packet at or after the given time
+    # using a binary search of the index file. Assumes packets were logged in
+    # time order which is how the LogMicroservice writes them. For compressed
+    # logs the file is positioned at the start of the block containing the
+    # time so packets before the time may still be read.
+    #
+    # @param time [Time] Time to seek to
+    # @return [Boolean] Whether a packet at or after the time was found. If
+    #   not the file is positioned at the last packet.
+    def seek_to_time(time)
+      raise "seek_to_time requires an index file" unless @index_file
+      return false if @index_count == 0
+
+      # Compressed logs are searched by block using the block's last time
+      time_item, offset_item = @compressed ? [2, 0] : [3, 4]
+      time_nsec_since_epoch = time.to_nsec_from_epoch
+      low = 0
+      high = @index_count
+      while low < high
+        mid = (low + high) / 2
+        if index_entry(mid)[time_item] < time_nsec_since_epoch
+          low = mid + 1
+        else
+          high = mid
+        end
+      end
+
+      found = (low < @index_count)
+      low = @index_count - 1 unless found
+      @file.seek(index_entry(low)[offset_item], IO::SEEK_SET)
+      return found
+    rescue => err
+      close()
+      raise err
+    end
+
+    # Yields back a {PacketView} for each RAW packet found in the log file.
+    # Items are only decoded when read from the view and the view is reused
+    # for every packet so call {PacketView#retain} to keep one. JSON packets
+    # are yielded as a {JsonPacket}.
+    #
+    # @param filename (see #each)
+    # @param start_time (see #each)
+    # @param end_time (see #each)
+    # @param index_filename (see #each)
+    # @yieldparam packet [PacketView|JsonPacket]
+    # @return (see #each)
+    def each_view(filename, start_time = nil, end_time = nil, index_filename: nil)
+      reached_end_time = false
+      open(filename, index_filename)
+
+      seek_to_time(start_time) if start_time and @index_file
+
+      view = PacketView.new
+      while true
+        packet = read_view(view)
+        break unless packet
+
+        time = packet.packet_time
+        if time
+          next if start_time and time < start_time
+          if end_time and time > end_time
+            reached_end_time = true
+            break
+          end
+        end
+        yield packet
+      end
+      reached_end_time
+    ensure # No implicit return value in the ensure block
+      close()
     end
 
     # Read a packet from the log file
@@ -105,131 +191,282 @@ module Cosmos
     # @param identify_and_define (see #each)
     # @return [Packet]
     def read(identify_and_define = true)
-      # Read entry length
-      length = @file.read(4)
-      return nil if !length or length.length <= 0
+      read_entry(identify_and_define, nil)
+    end
 
-      length = length.unpack('N')[0]
-      entry = @file.read(length)
-      flags = entry[0..1].unpack('n')[0]
+    # Read a packet from the log file into a view without building a Packet
+    #
+    # @param view [PacketView] View to update with the packet
+    # @return [PacketView|JsonPacket|nil] The view, a JsonPacket for JSON
+    #   entries or nil at the end of the file
+    def read_view(view = PacketView.new)
+      read_entry(false, view)
+    end
 
-      cmd_or_tlm = :TLM
-      cmd_or_tlm = :CMD if flags & COSMOS5_CMD_FLAG_MASK == COSMOS5_CMD_FLAG_MASK
-      stored = false
-      stored = true if flags & COSMOS5_STORED_FLAG_MASK == COSMOS5_STORED_FLAG_MASK
-      id = false
-      id = true if flags & COSMOS5_ID_FLAG_MASK == COSMOS5_ID_FLAG_MASK
+    # @!method each_entry(filename, offsets = false)
+    #   Yields the raw contents of each packet entry in the log file without
+    #   building Packet objects. Target and packet declarations are processed
+    #   as they are found. Implemented in C using a memory mapped file so
+    #   the entry headers are parsed without going through the interpreter.
+    #   Compressed logs are supported but offsets are not.
+    #
+    #   @param filename [String] The log file to read
+    #   @param offsets [Boolean] Whether to yield the file offset and length
+    #     of the packet data instead of a copy of the data
+    #   @yieldparam cmd_or_tlm [Symbol] :CMD or :TLM
+    #   @yieldparam target_name [String] Target name (shared between entries)
+    #   @yieldparam packet_name [String] Packet name (shared between entries)
+    #   @yieldparam time_nsec_since_epoch [Integer] Packet time
+    #   @yieldparam stored [Boolean] Whether the packet was stored telemetry
+    #   @yieldparam data [String] Packet data (RAW buffer or JSON). When
+    #     offsets is true this is instead two parameters: the file offset and
+    #     length of the packet data.
+    #   @return [nil]
+    if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
+      def each_entry(filename, offsets = false)
+        open(filename)
+        raise "Entry offsets are not available for compressed logs" if offsets and @compressed
 
-      if flags & COSMOS5_ENTRY_TYPE_MASK == COSMOS5_JSON_PACKET_ENTRY_TYPE_MASK
-        packet_index, time_nsec_since_epoch = entry[2..11].unpack('nQ>')
-        json_data = entry[12..-1]
-        lookup_cmd_or_tlm, target_name, packet_name, id = @packets[packet_index]
-        if cmd_or_tlm != lookup_cmd_or_tlm
-          raise "Packet type mismatch, packet:#{cmd_or_tlm}, lookup:#{lookup_cmd_or_tlm}"
-        end
+        while true
+          length = @file.read(4)
+          break if !length or length.length <= 0
 
-        return JsonPacket.new(cmd_or_tlm, target_name, packet_name, time_nsec_since_epoch, stored, json_data)
-      elsif flags & COSMOS5_ENTRY_TYPE_MASK == COSMOS5_RAW_PACKET_ENTRY_TYPE_MASK
-        packet_index, time_nsec_since_epoch = entry[2..11].unpack('nQ>')
-        packet_data = entry[12..-1]
-        lookup_cmd_or_tlm, target_name, packet_name, id = @packets[packet_index]
-        if cmd_or_tlm != lookup_cmd_or_tlm
-          raise "Packet type mismatch, packet:#{cmd_or_tlm}, lookup:#{lookup_cmd_or_tlm}"
+          length = length.unpack('N')[0]
+          entry = @file.read(length)
+          raise "Truncated entry in #{@filename}" if !entry or entry.length != length
+
+          flags = entry[0..1].unpack('n')[0]
+          entry_type = flags & COSMOS5_ENTRY_TYPE_MASK
+          if entry_type == COSMOS5_RAW_PACKET_ENTRY_TYPE_MASK or entry_type == COSMOS5_JSON_PACKET_ENTRY_TYPE_MASK
+            cmd_or_tlm = :TLM
+            cmd_or_tlm = :CMD if flags & COSMOS5_CMD_FLAG_MASK == COSMOS5_CMD_FLAG_MASK
+            stored = (flags & COSMOS5_STORED_FLAG_MASK == COSMOS5_STORED_FLAG_MASK)
+            packet_index, time_nsec_since_epoch = entry[2..11].unpack('nQ>')
+            lookup_cmd_or_tlm, target_name, packet_name, _ = @packets[packet_index]
+            if cmd_or_tlm != lookup_cmd_or_tlm
+              raise "Packet type mismatch, packet:#{cmd_or_tlm}, lookup:#{lookup_cmd_or_tlm}"
+            end
+
+            if offsets
+              data_length = length - COSMOS5_PRIMARY_FIXED_SIZE - COSMOS5_PACKET_SECONDARY_FIXED_SIZE
+              yield cmd_or_tlm, target_name, packet_name, time_nsec_since_epoch, stored, @file.pos - data_length, data_length
+            else
+              yield cmd_or_tlm, target_name, packet_name, time_nsec_since_epoch, stored, entry[12..-1]
+            end
+          elsif !process_declaration(flags, length, entry)
+            raise "Invalid Entry Flags: #{flags}"
+          end
         end
+        nil
+      ensure
+        close()
+      end
+    end
 
-        received_time = Time.from_nsec_from_epoch(time_nsec_since_epoch)
-        if identify_and_define
-          packet = identify_and_define_packet_data(cmd_or_tlm, target_name, packet_name, received_time, packet_data)
-        else
-          # Build Packet
-          packet = Packet.new(target_name, packet_name, :BIG_ENDIAN, nil, packet_data)
+    # @!method each_merged_entry(filenames, start_time_nsec = nil, end_time_nsec = nil)
+    #   Yields the packet entries of multiple log files in time order. Each
+    #   log is read sequentially and the next entry of every log is kept in a
+    #   min heap so the logs are never loaded into memory. Entries with the
+    #   same time are yielded in the order of the filenames. Implemented in C
+    #   using memory mapped files. Compressed logs are supported.
+    #
+    #   @param filenames [Array<String>] The log files to read. Each log
+    #     must be in time order which is how the LogMicroservice writes them.
+    #   @param start_time_nsec [Integer|nil] Skip packets before this time
+    #   @param end_time_nsec [Integer|nil] Stop at the first packet after this time
+    #   @yieldparam (see #each_entry)
+    #   @yieldparam log_index [Integer] Index into filenames of the log
+    #     containing the entry
+    #   @return [nil]
+    if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
+      def each_merged_entry(filenames, start_time_nsec = nil, end_time_nsec = nil)
+        reset()
+        readers = []
+        heads = []
+        filenames.each do |filename|
+          reader = PacketLogReader.new
+          readers << reader
+          reader.open(filename)
+          heads << reader.next_entry
         end
-        packet.set_received_time_fast(received_time)
-        packet.cmd_or_tlm = cmd_or_tlm
-        packet.stored = stored
-        packet.received_count += 1
-        return packet
-      elsif flags & COSMOS5_ENTRY_TYPE_MASK == COSMOS5_TARGET_DECLARATION_ENTRY_TYPE_MASK
-        target_name_length = length - COSMOS5_PRIMARY_FIXED_SIZE - COSMOS5_TARGET_DECLARATION_SECONDARY_FIXED_SIZE
-        target_name_length -= COSMOS5_ID_FIXED_SIZE if id
-        target_name = entry[2..(target_name_length + 1)]
-        if id
-          id = entry[(target_name_length + 3)..(target_name_length + 34)]
-          @target_ids << id
+        while true
+          # Linear search for the earliest entry, ties go to the first log
+          log_index = nil
+          heads.each_with_index do |head, index|
+            log_index = index if head and (!log_index or head[3] < heads[log_index][3])
+          end
+          break unless log_index
+
+          entry = heads[log_index]
+          break if end_time_nsec and entry[3] > end_time_nsec
+
+          yield(*entry, log_index) unless start_time_nsec and entry[3] < start_time_nsec
+          heads[log_index] = readers[log_index].next_entry
         end
-        @target_names << target_name
-        return read(identify_and_define)
-      elsif flags & COSMOS5_ENTRY_TYPE_MASK == COSMOS5_PACKET_DECLARATION_ENTRY_TYPE_MASK
-        target_index = entry[2..3].unpack('n')[0]
-        target_name = @target_names[target_index]
-        packet_name_length = length - COSMOS5_PRIMARY_FIXED_SIZE - COSMOS5_PACKET_DECLARATION_SECONDARY_FIXED_SIZE
-        packet_name_length -= COSMOS5_ID_FIXED_SIZE if id
-        packet_name = entry[4..(packet_name_length + 3)]
-        if id
-          id = entry[(packet_name_length + 4)..-1]
-          @packet_ids << id
+        nil
+      ensure
+        readers.each { |reader| reader.close } if readers
+      end
+    end
+
+    # Returns the file offset of every packet in the log file. These offsets
+    # map directly to the parameter needed by {#read_at_offset}. If an index
+    # file is given the offsets are read from it rather than the log.
+    #
+    # @param filename [String] The log filename to analyze
+    # @param index_filename [String|nil] The index file which accompanies the
+    #   log file
+    # @return [Array<Integer>] File offset of each packet entry
+    def packet_offsets(filename, index_filename = nil)
+      offsets = []
+      if index_filename
+        open(filename, index_filename)
+        raise "Packet offsets are not available for compressed logs" if @compressed
+
+        @index_file.seek(COSMOS5_HEADER_LENGTH, IO::SEEK_SET)
+        remaining = @index_count
+        while remaining > 0
+          count = remaining > 10000 ? 10000 : remaining
+          offsets.concat(@index_file.read(count * COSMOS5_INDEX_ENTRY_SIZE).unpack("x#{COSMOS5_INDEX_FILE_OFFSET}Q>" * count))
+          remaining -= count
         end
-        @packets << [cmd_or_tlm, target_name, packet_name, id]
-        return read(identify_and_define)
-      elsif flags & COSMOS5_ENTRY_TYPE_MASK == COSMOS5_OFFSET_MARKER_ENTRY_TYPE_MASK
-        @redis_offset = entry[2..-1]
-        return read(identify_and_define)
       else
-        raise "Invalid Entry Flags: #{flags}"
+        # Each entry has a 4 byte length, flags and the packet secondary header before the data
+        header_length = 4 + COSMOS5_PRIMARY_FIXED_SIZE + COSMOS5_PACKET_SECONDARY_FIXED_SIZE
+        each_entry(filename, true) do |_, _, _, _, _, offset, _|
+          offsets << (offset - header_length)
+        end
       end
-    rescue => err
+      return offsets
+    ensure
       close()
-      raise err
     end
 
-    # TODO: Currently not used
-    # Returns an analysis of the log file by reading all the packets and
-    # returning information about each packet. This information maps directly
-    # to the parameters need by the {#read_at_offset} method and thus should be
-    # called before using {#read_at_offset}.
+    # Read the summary from an index file without reading the log or the
+    # index entries. Only the index footer is read.
     #
-    # @param filename [String] The filename to analyze
-    # @param progress_callback [Proc] Callback that should receive a single
-    #   floating point parameter which is the percentage done
-    # @return [Array<Array<Integer, Integer, String, String, Time, Time>] Array
-    #   of arrays for each packet found in the log file consisting of:
-    #   [File position, length, target name, packet name, time formatted,
-    #   received time].
-    # def packet_offsets(filename, progress_callback = nil)
-    #   open(filename)
-    #   offsets = []
-    #   filesize = size().to_f
-
-    #   while true
-    #     current_pos = @file.pos
-    #     packet = read(false)
-    #     break unless packet
-    #     offsets << current_pos
-    #     if progress_callback
-    #       break if progress_callback.call(current_pos / filesize)
-    #     end
-    #   end
-
-    #   return offsets
-    # ensure
-    #   close()
-    # end
+    # @param index_filename [String] The index file which accompanies a log
+    # @return [Hash|nil] The summary or nil if the index has none. See
+    #   {.parse_summary}.
+    def summary(index_filename)
+      footer = File.open(index_filename, 'rb') do |file|
+        header = file.read(COSMOS5_HEADER_LENGTH)
+        raise "COSMOS index file header not found" unless header == COSMOS5_INDEX_HEADER or header == COSMOS5_COMPRESSED_INDEX_HEADER
+
+        size = file.size
+        file.seek(size - 4, IO::SEEK_SET)
+        footer_length = file.read(4).unpack('N')[0]
+        file.seek(size - footer_length, IO::SEEK_SET)
+        file.read(footer_length)
+      end
+      PacketLogReader.parse_summary(footer)
+    end
+
+    # Parse the summary section of an index footer
+    #
+    # @param footer [String] The index footer including the footer length at
+    #   the end. This is the last footer length bytes of the index file.
+    # @return [Hash|nil] 'packets' => Array of Hashes with the 'cmd_or_tlm',
+    #   'target_name', 'packet_name', 'count', 'min_time' and 'max_time' of
+    #   each packet in the log. Each packet also has 'items' => { name =>
+    #   [min, max] } if the log was written with summary_items. Returns nil if
+    #   the index has no summary.
+    def self.parse_summary(footer)
+      position = 0
+      2.times do # Skip the target and packet declarations
+        count = footer[position, 2].unpack('n')[0]
+        position += 2
+        fields = CosmosIO.read_length_fields(footer, position, 4, count)
+        raise "Truncated index footer" if fields.length < (count * 2)
+        position = fields[-2] + fields[-1] if count > 0
+      end
+      return nil unless footer[position, COSMOS5_HEADER_LENGTH] == COSMOS5_SUMMARY_HEADER
+
+      length = footer[position + COSMOS5_HEADER_LENGTH, 4].unpack('N')[0]
+      JSON.parse(footer[position + COSMOS5_HEADER_LENGTH + 4, length], :allow_nan => true)
+    end
 
-    # TODO: Currently not used
     # Reads a packet from the opened log file. Should only be used in
-    # conjunction with {#packet_offsets}.
+    # conjunction with {#packet_offsets} on a log file opened with its index
+    # file so that the target and packet declarations are known.
     #
     # @param file_offset [Integer] Byte offset into the log file to start
     #   reading
     # @param identify_and_define (see #each)
     # @return [Packet]
-    # def read_at_offset(file_offset, identify_and_define = true)
-    #   @file.seek(file_offset, IO::SEEK_SET)
-    #   return read(identify_and_define)
-    # rescue => err
-    #   close()
-    #   raise err
-    # end
+    def read_at_offset(file_offset, identify_and_define = true)
+      raise "read_at_offset is not supported for compressed logs" if @compressed
+
+      @file.seek(file_offset, IO::SEEK_SET)
+      return read(identify_and_define)
+    rescue => err
+      close()
+      raise err
+    end
+
+    # Split a log file into chunks of whole packets using the offsets in its
+    # index file. Each chunk can be read independently with {#each_in_chunk}
+    # so a large log can be shared between worker processes. Chunks hold
+    # roughly the same number of bytes and are returned in file order.
+    # Compressed logs are not supported.
+    #
+    # @param filename [String] The log filename to split
+    # @param index_filename [String] The index file which accompanies the
+    #   log file
+    # @param count [Integer] Maximum number of chunks. Fewer are returned if
+    #   the log has fewer packets.
+    # @return [Array<Range>] File offsets of each chunk. Each range starts at
+    #   the first packet entry of the chunk and excludes the byte after the
+    #   last packet entry.
+    def chunks(filename, index_filename, count)
+      open(filename, index_filename)
+      raise "Chunks are not available for compressed logs" if @compressed
+      return [] if @index_count == 0
+
+      first_offset = index_entry(0)[4]
+      length, _, _, _, last_offset = index_entry(@index_count - 1)
+      # Each entry has a 4 byte length before it
+      bytes = last_offset + 4 + length - first_offset
+
+      boundaries = [0]
+      (1...count).each do |chunk|
+        boundaries << first_index_at_offset(first_offset + (bytes * chunk / count))
+      end
+      boundaries << @index_count
+      boundaries.uniq.each_cons(2).map do |first, last|
+        length, _, _, _, offset = index_entry(last - 1)
+        index_entry(first)[4]...(offset + 4 + length)
+      end
+    ensure
+      close()
+    end
+
+    # Yields back each packet in a chunk of a log file. The target and packet
+    # declarations are loaded from the index so the chunk is read without
+    # reading anything before it.
+    #
+    # @param filename [String] The log file to read
+    # @param index_filename [String] The index file which accompanies the
+    #   log file
+    # @param chunk [Range] File offsets of the chunk returned by {#chunks}
+    # @param identify_and_define (see #each)
+    # @yieldparam packet [Packet]
+    # @return [nil]
+    def each_in_chunk(filename, index_filename, chunk, identify_and_define = true)
+      open(filename, index_filename)
+      raise "each_in_chunk is not supported for compressed logs" if @compressed
+
+      @file.seek(chunk.begin, IO::SEEK_SET)
+      while @file.pos < chunk.end
+        packet = read(identify_and_define)
+        break unless packet
+
+        yield packet
+      end
+      nil
+    ensure
+      close()
+    end
 
     # TODO: Currently not used
     # Read the first packet from the log file and reset the file position back
@@ -271,12 +508,15 @@ module Cosmos
     #   raise err
     # end
 
-    # @return [Integer] The size of the log file being processed
+    # @return [Integer] The size of the log file being processed. For
+    #   compressed logs this is the compressed size.
     def size
-      @file.stat.size
+      @file.size
     end
 
-    # @return [Integer] The current file position in the log file
+    # @return [Integer] The current file position in the log file. For
+    #   compressed logs this is the compressed position of the next block to
+    #   decompress so it can be compared with {#size}.
     def bytes_read
       @file.pos
     end
@@ -291,7 +531,216 @@ module Cosmos
       @target_ids = []
       @packets = []
       @packet_ids = []
+      @packet_definitions = []
       @redis_offset = nil
+      @index_file = nil
+      @index_count = 0
+      @index_declarations = false
+      @compressed = false
+    end
+
+    # Read the next packet entry from the open log without building a Packet
+    #
+    # @return [Array|nil] The values yielded by {#each_entry} or nil at the
+    #   end of the file
+    def next_entry
+      while true
+        length = @file.read(4)
+        return nil if !length or length.length <= 0
+
+        length = length.unpack('N')[0]
+        entry = @file.read(length)
+        raise "Truncated entry in #{@filename}" if !entry or entry.length != length
+
+        flags = entry[0..1].unpack('n')[0]
+        entry_type = flags & COSMOS5_ENTRY_TYPE_MASK
+        if entry_type == COSMOS5_RAW_PACKET_ENTRY_TYPE_MASK or entry_type == COSMOS5_JSON_PACKET_ENTRY_TYPE_MASK
+          cmd_or_tlm = :TLM
+          cmd_or_tlm = :CMD if flags & COSMOS5_CMD_FLAG_MASK == COSMOS5_CMD_FLAG_MASK
+          stored = (flags & COSMOS5_STORED_FLAG_MASK == COSMOS5_STORED_FLAG_MASK)
+          packet_index, time_nsec_since_epoch = entry[2..11].unpack('nQ>')
+          lookup_cmd_or_tlm, target_name, packet_name, _ = @packets[packet_index]
+          if cmd_or_tlm != lookup_cmd_or_tlm
+            raise "Packet type mismatch, packet:#{cmd_or_tlm}, lookup:#{lookup_cmd_or_tlm}"
+          end
+
+          return [cmd_or_tlm, target_name, packet_name, time_nsec_since_epoch, stored, entry[12..-1]]
+        elsif !process_declaration(flags, length, entry)
+          raise "Invalid Entry Flags: #{flags}"
+        end
+      end
+    end
+
+    # Read a packet entry as a Packet or into the given PacketView
+    def read_entry(identify_and_define, view)
+      # Read entry length
+      length = @file.read(4)
+      return nil if !length or length.length <= 0
+
+      length = length.unpack('N')[0]
+      entry = @file.read(length)
+      flags = entry[0..1].unpack('n')[0]
+
+      cmd_or_tlm = :TLM
+      cmd_or_tlm = :CMD if flags & COSMOS5_CMD_FLAG_MASK == COSMOS5_CMD_FLAG_MASK
+      stored = false
+      stored = true if flags & COSMOS5_STORED_FLAG_MASK == COSMOS5_STORED_FLAG_MASK
+      id = false
+      id = true if flags & COSMOS5_ID_FLAG_MASK == COSMOS5_ID_FLAG_MASK
+
+      if flags & COSMOS5_ENTRY_TYPE_MASK == COSMOS5_JSON_PACKET_ENTRY_TYPE_MASK
+        packet_index, time_nsec_since_epoch = entry[2..11].unpack('nQ>')
+        json_data = entry[12..-1]
+        lookup_cmd_or_tlm, target_name, packet_name, id = @packets[packet_index]
+        if cmd_or_tlm != lookup_cmd_or_tlm
+          raise "Packet type mismatch, packet:#{cmd_or_tlm}, lookup:#{lookup_cmd_or_tlm}"
+        end
+
+        return JsonPacket.new(cmd_or_tlm, target_name, packet_name, time_nsec_since_epoch, stored, json_data)
+      elsif flags & COSMOS5_ENTRY_TYPE_MASK == COSMOS5_RAW_PACKET_ENTRY_TYPE_MASK
+        packet_index, time_nsec_since_epoch = entry[2..11].unpack('nQ>')
+        packet_data = entry[12..-1]
+        lookup_cmd_or_tlm, target_name, packet_name, id = @packets[packet_index]
+        if cmd_or_tlm != lookup_cmd_or_tlm
+          raise "Packet type mismatch, packet:#{cmd_or_tlm}, lookup:#{lookup_cmd_or_tlm}"
+        end
+
+        return view.set(packet_definition(packet_index), cmd_or_tlm, time_nsec_since_epoch, stored, packet_data) if view
+
+        received_time = Time.from_nsec_from_epoch(time_nsec_since_epoch)
+        if identify_and_define
+          packet = identify_and_define_packet_data(cmd_or_tlm, target_name, packet_name, received_time, packet_data)
+        else
+          # Build Packet
+          packet = Packet.new(target_name, packet_name, :BIG_ENDIAN, nil, packet_data)
+        end
+        packet.set_received_time_fast(received_time)
+        packet.cmd_or_tlm = cmd_or_tlm
+        packet.stored = stored
+        packet.received_count += 1
+        return packet
+      elsif process_declaration(flags, length, entry)
+        return read_entry(identify_and_define, view)
+      else
+        raise "Invalid Entry Flags: #{flags}"
+      end
+    rescue => err
+      close()
+      raise err
+    end
+
+    # Open an index file and load the target and packet declarations from its
+    # footer. Only the footer is read, index entries are read on demand.
+    def open_index(index_filename)
+      @index_file = File.open(index_filename, 'rb')
+      header = @index_file.read(COSMOS5_HEADER_LENGTH)
+      if header == COSMOS5_INDEX_HEADER
+        raise "Index file is for an uncompressed log" if @compressed
+      elsif header == COSMOS5_COMPRESSED_INDEX_HEADER
+        raise "Index file is for a compressed log" unless @compressed
+      else
+        raise "COSMOS index file header not found"
+      end
+
+      size = @index_file.size
+      @index_file.seek(size - 4, IO::SEEK_SET)
+      footer_length = @index_file.read(4).unpack('N')[0]
+      footer_start = size - footer_length
+      @index_file.seek(footer_start, IO::SEEK_SET)
+      footer = @index_file.read(footer_length - 4)
+      position = 0
+      2.times do # Target declarations followed by packet declarations
+        count = footer[position, 2].unpack('n')[0]
+        position += 2
+        fields = CosmosIO.read_length_fields(footer, position, 4, count)
+        raise "Truncated index footer" if fields.length < (count * 2)
+        fields.each_slice(2) do |offset, length|
+          process_declaration(footer[offset, 2].unpack('n')[0], length, footer[offset, length])
+        end
+        position = fields[-2] + fields[-1] if count > 0
+      end
+      # Declarations in the log itself are now redundant
+      @index_declarations = true
+      @index_count = (footer_start - COSMOS5_HEADER_LENGTH) / index_entry_size()
+    end
+
+    # @return [Integer] Size of each index file entry
+    def index_entry_size
+      @compressed ? COSMOS5_BLOCK_INDEX_ENTRY_SIZE : COSMOS5_INDEX_ENTRY_SIZE
+    end
+
+    # @param offset [Integer] Log file offset
+    # @return [Integer] Index of the first index entry at or after the offset
+    def first_index_at_offset(offset)
+      low = 0
+      high = @index_count
+      while low < high
+        mid = (low + high) / 2
+        if index_entry(mid)[4] < offset
+          low = mid + 1
+        else
+          high = mid
+        end
+      end
+      low
+    end
+
+    # @param index [Integer] Index entry number
+    # @return [Array] Length, flags, packet index, time and file offset. For
+    #   compressed logs file offset, first time, last time, first packet number
+    #   and packet count of a block.
+    def index_entry(index)
+      @index_file.seek(COSMOS5_HEADER_LENGTH + (index * index_entry_size()), IO::SEEK_SET)
+      if @compressed
+        @index_file.read(COSMOS5_BLOCK_INDEX_ENTRY_SIZE).unpack(COSMOS5_BLOCK_INDEX_PACK_DIRECTIVE)
+      else
+        @index_file.read(COSMOS5_INDEX_ENTRY_SIZE).unpack(COSMOS5_INDEX_PACK_DIRECTIVE)
+      end
+    end
+
+    # Process target declaration, packet declaration and offset marker entries
+    #
+    # @param flags [Integer] Entry flags
+    # @param length [Integer] Entry length
+    # @param entry [String] Entry data including the flags
+    # @return [Boolean] Whether the entry was a declaration or offset marker
+    def process_declaration(flags, length, entry)
+      cmd_or_tlm = :TLM
+      cmd_or_tlm = :CMD if flags & COSMOS5_CMD_FLAG_MASK == COSMOS5_CMD_FLAG_MASK
+      id = false
+      id = true if flags & COSMOS5_ID_FLAG_MASK == COSMOS5_ID_FLAG_MASK
+
+      if flags & COSMOS5_ENTRY_TYPE_MASK == COSMOS5_TARGET_DECLARATION_ENTRY_TYPE_MASK
+        return true if @index_declarations
+
+        target_name_length = length - COSMOS5_PRIMARY_FIXED_SIZE - COSMOS5_TARGET_DECLARATION_SECONDARY_FIXED_SIZE
+        target_name_length -= COSMOS5_ID_FIXED_SIZE if id
+        target_name = entry[2..(target_name_length + 1)]
+        if id
+          id = entry[(target_name_length + 2)..(target_name_length + 33)]
+          @target_ids << id
+        end
+        @target_names << target_name
+        return true
+      elsif flags & COSMOS5_ENTRY_TYPE_MASK == COSMOS5_PACKET_DECLARATION_ENTRY_TYPE_MASK
+        return true if @index_declarations
+
+        target_index = entry[2..3].unpack('n')[0]
+        target_name = @target_names[target_index]
+        packet_name_length = length - COSMOS5_PRIMARY_FIXED_SIZE - COSMOS5_PACKET_DECLARATION_SECONDARY_FIXED_SIZE
+        packet_name_length -= COSMOS5_ID_FIXED_SIZE if id
+        packet_name = entry[4..(packet_name_length + 3)]
+        if id
+          id = entry[(packet_name_length + 4)..-1]
+          @packet_ids << id
+        end
+        @packets << [cmd_or_tlm, target_name, packet_name, id]
+        return true
+      elsif flags & COSMOS5_ENTRY_TYPE_MASK == COSMOS5_OFFSET_MARKER_ENTRY_TYPE_MASK
+        @redis_offset = entry[2..-1]
+        return true
+      end
+      return false
     end
 
     # This is best effort. May return unidentified/undefined packets
@@ -320,12 +769,37 @@ module Cosmos
       packet
     end
 
+    # Packet definition used by views of the packet at the given index.
+    # Looked up once per log file and never modified.
+    def packet_definition(packet_index)
+      definition = @packet_definitions[packet_index]
+      return definition if definition
+
+      cmd_or_tlm, target_name, packet_name, _ = @packets[packet_index]
+      begin
+        if cmd_or_tlm == :CMD
+          definition = System.commands.packet(target_name, packet_name)
+        else
+          definition = System.telemetry.packet(target_name, packet_name)
+        end
+      rescue
+        # Could not find a definition for this packet
+        Logger.instance.error "Unknown packet #{target_name} #{packet_name}"
+        definition = Packet.new(target_name, packet_name)
+      end
+      @packet_definitions[packet_index] = definition
+    end
+
     # Should return if successfully switched to requested configuration
     def read_file_header
       header = @file.read(COSMOS5_HEADER_LENGTH)
       if header and header.length == COSMOS5_HEADER_LENGTH
         if header == COSMOS5_FILE_HEADER
           # Found COSMOS 5 File Header - That's all we need to do
+        elsif header == COSMOS5_COMPRESSED_FILE_HEADER
+          # Entries follow in compressed blocks
+          @compressed = true
+          @file = CompressedLogFile.new(@file)
         elsif header == COSMOS4_FILE_HEADER
           raise "COSMOS 4 log file must be converted to COSMOS 5"
         elsif header == COSMOS2_FILE_HEADER
@@ -337,9 +811,5 @@ module Cosmos
         raise "Failed to read at least #{COSMOS5_HEADER_LENGTH} bytes from packet log"
       end
     end
-
-    def seek_to_time(time)
-      raise "TODO: Implement me - Use index file or offsets"
-    end
   end
 end
@@ -19,6 +19,8 @@
 
 require 'cosmos/logs/log_writer'
 require 'cosmos/logs/packet_log_constants'
+require 'zlib'
+require 'json'
 
 module Cosmos
   # Creates a packet log. Can automatically cycle the log based on an elasped
@@ -42,6 +44,16 @@ module Cosmos
     #   for more information.
     # @param redis_topic [String] The key of the Redis stream to trim when files are
     #   moved to S3
+    # @param flush_size (see LogWriter#initialize)
+    # @param flush_interval (see LogWriter#initialize)
+    # @param durability (see LogWriter#initialize)
+    # @param compress [Boolean] Whether to write the compressed log variant
+    #   where entries are grouped into zlib compressed blocks
+    # @param summary_items [Boolean] Whether to add the minimum and maximum
+    #   of every numeric item to the index summary. RAW packets use the RAW
+    #   value of items in the packet definition and JSON packets use every
+    #   numeric value in the JSON. Each JSON packet is parsed again to do
+    #   this, which roughly doubles the JSON cost of logging DECOM data.
     def initialize(
       remote_log_directory,
       label,
@@ -50,7 +62,12 @@ module Cosmos
       cycle_size = 1_000_000_000,
       cycle_hour = nil,
       cycle_minute = nil,
-      redis_topic: nil
+      redis_topic: nil,
+      flush_size: LogWriteBuffer::DEFAULT_FLUSH_SIZE,
+      flush_interval: 1.0,
+      durability: :NONE,
+      compress: false,
+      summary_items: false
     )
       super(
         remote_log_directory,
@@ -59,9 +76,21 @@ module Cosmos
         cycle_size,
         cycle_hour,
         cycle_minute,
-        redis_topic: redis_topic
+        redis_topic: redis_topic,
+        flush_size: flush_size,
+        flush_interval: flush_interval,
+        durability: durability
       )
       @label = label
+      @compress = ConfigParser.handle_true_false(compress)
+      @summary_items = ConfigParser.handle_true_false(summary_items)
+      @packet_summaries = []
+      @summary_definitions = {}
+      @block = String.new
+      @block_first_time = nil
+      @block_last_time = nil
+      @block_packet_count = 0
+      @packet_count = 0
       @index_file = nil
       @index_filename = nil
       @cmd_packet_table = {}
@@ -109,13 +138,21 @@ module Cosmos
     # Assumes mutex has already been taken
     def start_new_file
       super
-      @file.write(COSMOS5_FILE_HEADER)
-      @file_size += COSMOS5_FILE_HEADER.length
 
       # Start index log file
       @index_filename = create_unique_filename('.idx'.freeze)
       @index_file = File.new(@index_filename, 'wb')
-      @index_file.write(COSMOS5_INDEX_HEADER)
+      # Buffer the index file along with the log file
+      @buffer = LogWriteBuffer.new(@file, @index_file, @flush_size)
+      if @compress
+        @buffer.write(COSMOS5_COMPRESSED_FILE_HEADER, COSMOS5_COMPRESSED_INDEX_HEADER)
+      else
+        @buffer.write(COSMOS5_FILE_HEADER, COSMOS5_INDEX_HEADER)
+      end
+      @file_size += COSMOS5_HEADER_LENGTH
+      @block.clear
+      @block_packet_count = 0
+      @packet_count = 0
 
       @cmd_packet_table = {}
       @tlm_packet_table = {}
@@ -123,6 +160,7 @@ module Cosmos
       @target_indexes = {}
       @target_dec_entries = []
       @packet_dec_entries = []
+      @packet_summaries = []
       Logger.debug "Index Log File Opened : #{@index_filename}"
     rescue => err
       Logger.error "Error starting new log file: #{err.formatted}"
@@ -132,7 +170,10 @@ module Cosmos
 
     # Closing a log file isn't critical so we just log an error
     def close_file(take_mutex = true)
-      write_entry(:OFFSET_MARKER, nil, nil, nil, nil, nil, nil, nil) if @file
+      if @file
+        write_entry(:OFFSET_MARKER, nil, nil, nil, nil, nil, nil, nil)
+        write_pending()
+      end
       super
 
       @mutex.lock if take_mutex
@@ -140,6 +181,7 @@ module Cosmos
         if @index_file
           begin
             write_index_file_footer()
+            @index_file.fdatasync unless @durability == :NONE
             @index_file.close unless @index_file.closed?
             Logger.debug "Index Log File Closed : #{@index_filename}"
             date = first_timestamp[0..7] # YYYYMMDD
@@ -261,31 +303,161 @@ module Cosmos
         @index_entry << [length, flags, packet_index, time_nsec_since_epoch].pack(COSMOS5_PACKET_PACK_DIRECTIVE)
         @entry << @index_entry << data
         @index_entry << [@file_size].pack('Q>')
-        @index_file.write(@index_entry)
         @first_time = time_nsec_since_epoch if !@first_time or time_nsec_since_epoch < @first_time
         @last_time = time_nsec_since_epoch if !@last_time or time_nsec_since_epoch > @last_time
+        update_summary(packet_index, entry_type, cmd_or_tlm, target_name, packet_name, time_nsec_since_epoch, data)
       else
         raise "Unknown entry_type: #{entry_type}"
       end
-      @file.write(@entry)
+      if @compress
+        @block << @entry
+        if entry_type == :RAW_PACKET or entry_type == :JSON_PACKET
+          @block_first_time = time_nsec_since_epoch if !@block_first_time or time_nsec_since_epoch < @block_first_time
+          @block_last_time = time_nsec_since_epoch if !@block_last_time or time_nsec_since_epoch > @block_last_time
+          @block_packet_count += 1
+        end
+        # Blocks are also limited to the flush size so entries aren't held
+        # back from the buffer longer than uncompressed entries would be
+        write_block() if @block.length >= COSMOS5_BLOCK_SIZE or @block.length >= @flush_size
+      else
+        # Count the entry first as it stays buffered even if the write fails
+        @file_size += @entry.length
+        if entry_type == :RAW_PACKET or entry_type == :JSON_PACKET
+          @buffer.write(@entry, @index_entry)
+        else
+          @buffer.write(@entry)
+        end
+      end
+    end
+
+    # Seal the current block so the flush interval and durability policy
+    # cover compressed entries too. This can write blocks smaller than
+    # COSMOS5_BLOCK_SIZE which compress less well.
+    def write_pending
+      write_block() if @compress
+    end
+
+    # Compress the current block and write it along with its index entry.
+    # Blocks without packets (e.g. the final offset marker) are not indexed.
+    def write_block
+      return if @block.empty?
+
+      compressed = Zlib::Deflate.deflate(@block, Zlib::BEST_SPEED)
+      @entry.clear
+      @entry << [compressed.length, @block.length].pack(COSMOS5_BLOCK_HEADER_PACK_DIRECTIVE) << compressed
+      indexed = (@block_packet_count > 0)
+      if indexed
+        @index_entry.clear
+        @index_entry << [@file_size, @block_first_time, @block_last_time, @packet_count, @block_packet_count].pack(COSMOS5_BLOCK_INDEX_PACK_DIRECTIVE)
+      end
+      # The block is done even if the write fails as it stays buffered
       @file_size += @entry.length
+      @packet_count += @block_packet_count
+      @block.clear
+      @block_first_time = nil
+      @block_last_time = nil
+      @block_packet_count = 0
+      if indexed
+        @buffer.write(@entry, @index_entry)
+      else
+        @buffer.write(@entry)
+      end
+    end
+
+    # Track the packet count and time range (and optionally the item ranges)
+    # of each packet for the index summary
+    def update_summary(packet_index, entry_type, cmd_or_tlm, target_name, packet_name, time_nsec_since_epoch, data)
+      summary = @packet_summaries[packet_index]
+      unless summary
+        # Count, min time, max time and item ranges
+        summary = [0, time_nsec_since_epoch, time_nsec_since_epoch, {}]
+        @packet_summaries[packet_index] = summary
+      end
+      summary[0] += 1
+      summary[1] = time_nsec_since_epoch if time_nsec_since_epoch < summary[1]
+      summary[2] = time_nsec_since_epoch if time_nsec_since_epoch > summary[2]
+      return unless @summary_items
+
+      items = summary[3]
+      if entry_type == :RAW_PACKET
+        summary_definition(cmd_or_tlm, target_name, packet_name).each do |item|
+          begin
+            value = BinaryAccessor.read(item.bit_offset, item.bit_size, item.data_type, data, item.endianness)
+          rescue
+            next # Packet is too short to hold the item
+          end
+          update_item_range(items, item.name, value)
+        end
+      else
+        JSON.parse(data, :allow_nan => true).each do |name, value|
+          update_item_range(items, name, value) if Numeric === value
+        end
+      end
+    end
+
+    def update_item_range(items, name, value)
+      return if Float === value and !value.finite?
+
+      range = items[name]
+      if range
+        range[0] = value if value < range[0]
+        range[1] = value if value > range[1]
+      else
+        items[name] = [value, value]
+      end
+    end
+
+    # @return [Array<PacketItem>] Numeric items in the packet definition
+    def summary_definition(cmd_or_tlm, target_name, packet_name)
+      key = "#{cmd_or_tlm}__#{target_name}__#{packet_name}"
+      items = @summary_definitions[key]
+      return items if items
+
+      begin
+        if cmd_or_tlm == :CMD
+          packet = System.commands.packet(target_name, packet_name)
+        else
+          packet = System.telemetry.packet(target_name, packet_name)
+        end
+        items = packet.sorted_items.select do |item|
+          (item.data_type == :INT or item.data_type == :UINT or item.data_type == :FLOAT) and !item.array_size and item.bit_size > 0
+        end
+      rescue
+        items = [] # No packet def
+      end
+      @summary_definitions[key] = items
     end
 
     def write_index_file_footer
-      footer_length = 4 # Includes length of length field at end
-      @index_file.write([@target_dec_entries.length].pack('n'))
-      footer_length += 2
+      footer = String.new
+      footer << [@target_dec_entries.length].pack('n')
       @target_dec_entries.each do |target_dec_entry|
-        @index_file.write(target_dec_entry)
-        footer_length += target_dec_entry.length
+        footer << target_dec_entry
       end
-      @index_file.write([@packet_dec_entries.length].pack('n'))
-      footer_length += 2
+      footer << [@packet_dec_entries.length].pack('n')
       @packet_dec_entries.each do |packet_dec_entry|
-        @index_file.write(packet_dec_entry)
-        footer_length += packet_dec_entry.length
+        footer << packet_dec_entry
+      end
+      packets = []
+      [@cmd_packet_table, @tlm_packet_table].each_with_index do |packet_table, table_index|
+        packet_table.each do |target_name, target_table|
+          target_table.each do |packet_name, packet_index|
+            count, min_time, max_time, items = @packet_summaries[packet_index]
+            next unless count
+
+            packet = { 'cmd_or_tlm' => (table_index == 0 ? 'CMD' : 'TLM'), 'target_name' => target_name, 'packet_name' => packet_name,
+                       'count' => count, 'min_time' => min_time, 'max_time' => max_time }
+            packet['items'] = items if @summary_items
+            packets << packet
+          end
+        end
       end
-      @index_file.write([footer_length].pack('N'))
+      # Binary so the length is the byte count of any non-ASCII names
+      summary = JSON.generate({ 'packets' => packets }).b
+      footer << COSMOS5_SUMMARY_HEADER << [summary.bytesize].pack('N') << summary
+      footer_length = footer.length + 4 # Includes length of length field at end
+      footer << [footer_length].pack('N')
+      @index_file.write(footer)
     end
 
     def s3_filename
@@ -47,10 +47,11 @@ module Cosmos
       @entry.clear
       @entry << "#{time_nsec_since_epoch}\t"
       @entry << "#{data}\n"
-      @file.write(@entry)
       @file_size += @entry.length
       @first_time = time_nsec_since_epoch if !@first_time or time_nsec_since_epoch < @first_time
       @last_time = time_nsec_since_epoch if !@last_time or time_nsec_since_epoch > @last_time
+      # The entry stays buffered even if the write fails
+      @buffer.write(@entry)
     end
 
     def s3_filename
@@ -31,6 +31,7 @@ module Cosmos
 
     def initialize(*args)
       super(*args)
+      @decom_histograms = {}
       Topic.update_topic_offsets(@topics)
       System.telemetry.limits_change_callback = method(:limits_change_callback)
     end
@@ -69,8 +70,13 @@ module Cosmos
 
       TelemetryDecomTopic.write_packet(packet, scope: @scope)
       diff = Process.clock_gettime(Process::CLOCK_MONOTONIC) - start # seconds as a float
-      metric_labels = { "packet" => packet_name, "target" => target_name }
-      @metric.add_sample(name: DECOM_METRIC_NAME, value: diff, labels: metric_labels)
+      decom_histogram(target_name, packet_name).record(diff)
+    end
+
+    # Get the decom duration histogram for a packet, registering it on first use
+    def decom_histogram(target_name, packet_name)
+      target_histograms = (@decom_histograms[target_name] ||= {})
+      target_histograms[packet_name] ||= @metric.histogram(name: DECOM_METRIC_NAME, labels: { "packet" => packet_name, "target" => target_name })
     end
 
     # Called when an item in any packet changes limits states.
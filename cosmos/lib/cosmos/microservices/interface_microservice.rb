@@ -234,6 +234,137 @@ module Cosmos
     end
   end
 
+  # Optional pipeline which moves telemetry identification and publishing
+  # off the interface read thread. The read thread pushes each packet onto a
+  # bounded queue for the decode thread, which identifies it and pushes a
+  # copy of the topic entry onto a bounded queue for the publish thread. The
+  # publish thread writes everything waiting on its queue to Redis with a
+  # single round trip.
+  #
+  # When a queue is full the thread pushing to it blocks, so a slow Redis
+  # eventually stops the interface reads. If drop is set the read thread
+  # instead discards packets which don't fit and counts them.
+  class InterfacePipeline
+    # Maximum number of topic entries written with one round trip
+    DEFAULT_BATCH_SIZE = 100
+    # Time from a packet being read until it is decoded or from being
+    # decoded until it is published
+    LATENCY_METRIC_NAME = 'interface_pipeline_latency_seconds'
+    QUEUE_DEPTH_METRIC_NAME = 'interface_pipeline_queue_depth'
+    DROPPED_METRIC_NAME = 'interface_pipeline_dropped_packets'
+
+    # @return [Integer] Number of packets dropped because the decode queue was full
+    attr_reader :dropped_count
+
+    # @param interface [Interface] Interface the packets are read from
+    # @param tlm [InterfaceMicroservice] Microservice which identifies the packets
+    # @param metric [Metric] Metric to report latency, queue depth and drops
+    # @param queue_size [Integer] Maximum number of packets waiting in each queue
+    # @param drop [Boolean] Whether to drop packets instead of blocking the
+    #   read thread when the decode queue is full
+    # @param batch_size [Integer] Maximum number of entries written at once
+    def initialize(interface, tlm, metric, queue_size:, drop: false, batch_size: DEFAULT_BATCH_SIZE, scope:)
+      @interface = interface
+      @tlm = tlm
+      @metric = metric
+      @drop = drop
+      @batch_size = batch_size
+      @scope = scope
+      @decode_queue = SizedQueue.new(queue_size)
+      @publish_queue = SizedQueue.new(queue_size)
+      @decode_latency = metric.histogram(name: LATENCY_METRIC_NAME, labels: { 'stage' => 'decode' })
+      @publish_latency = metric.histogram(name: LATENCY_METRIC_NAME, labels: { 'stage' => 'publish' })
+      @dropped_count = 0
+      @decode_thread = nil
+      @publish_thread = nil
+    end
+
+    def start
+      @decode_thread = Thread.new do
+        decode_run()
+      rescue Exception => err
+        Logger.error "#{@interface.name}: Pipeline decode thread died: #{err.formatted}"
+        raise err
+      end
+      @publish_thread = Thread.new do
+        publish_run()
+      rescue Exception => err
+        Logger.error "#{@interface.name}: Pipeline publish thread died: #{err.formatted}"
+        raise err
+      end
+    end
+
+    # Queue a packet read from the interface. The received time is set here
+    # so it doesn't include the time spent waiting to be decoded.
+    #
+    # @param packet [Packet] Unidentified packet
+    # @return [Boolean] Whether the packet was queued or dropped
+    def push(packet)
+      packet.received_time = Time.now.sys unless packet.received_time
+      item = [packet, Process.clock_gettime(Process::CLOCK_MONOTONIC)]
+      if @drop
+        begin
+          @decode_queue.push(item, true)
+        rescue ThreadError # Queue full
+          @dropped_count += 1
+          Logger.warn "#{@interface.name}: Pipeline full, dropping packets" if @dropped_count == 1
+          return false
+        end
+      else
+        @decode_queue.push(item)
+      end
+      true
+    end
+
+    # Finish publishing the queued packets and stop the threads
+    def stop
+      @decode_queue.close
+      @decode_thread.join if @decode_thread
+      @publish_thread.join if @publish_thread
+    end
+
+    protected
+
+    def decode_run
+      while (item = @decode_queue.pop)
+        packet, read_time = item
+        begin
+          packet = @tlm.identify_packet(packet)
+          # Copy the buffer since the current value table packet is reused
+          entry = TelemetryTopic.build_entry(packet, true, scope: @scope)
+          decode_time = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+          @decode_latency.record(decode_time - read_time)
+          @publish_queue.push([entry, decode_time])
+        rescue => err
+          Logger.error "#{@interface.name}: Error decoding packet: #{err.formatted}"
+        end
+      end
+    ensure
+      @publish_queue.close
+    end
+
+    def publish_run
+      batch = []
+      while (item = @publish_queue.pop)
+        batch << item
+        # Only this thread pops so anything waiting can be taken without blocking
+        batch << @publish_queue.pop while batch.length < @batch_size and !@publish_queue.empty?
+        begin
+          TelemetryTopic.write_entries(batch.map { |entry, _| entry })
+          publish_time = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+          batch.each { |_, decode_time| @publish_latency.record(publish_time - decode_time) }
+          InterfaceStatusModel.set(@interface.as_json, scope: @scope)
+        rescue => err
+          Logger.error "#{@interface.name}: Error publishing #{batch.length} packets: #{err.formatted}"
+        end
+        batch.clear
+        @metric.add_sample(name: QUEUE_DEPTH_METRIC_NAME, value: @decode_queue.length, labels: { 'stage' => 'decode' })
+        @metric.add_sample(name: QUEUE_DEPTH_METRIC_NAME, value: @publish_queue.length, labels: { 'stage' => 'publish' })
+        @metric.add_sample(name: DROPPED_METRIC_NAME, value: @dropped_count, labels: {})
+      end
+    end
+  end
+
   class InterfaceMicroservice < Microservice
     UNKNOWN_BYTES_TO_PRINT = 16
 
@@ -264,6 +395,16 @@ module Cosmos
         RouterStatusModel.set(@interface.as_json, scope: @scope)
       end
 
+      @pipeline = nil
+      queue_size = @interface.options['PIPELINE_QUEUE_SIZE']
+      if queue_size and @interface_or_router == 'INTERFACE'
+        overflow = @interface.options['PIPELINE_OVERFLOW']
+        @pipeline = InterfacePipeline.new(@interface, self, @metric,
+                                          queue_size: Integer(queue_size[0]),
+                                          drop: (overflow and overflow[0].to_s.upcase == 'DROP'),
+                                          scope: @scope)
+      end
+
       @interface_thread_sleeper = Sleeper.new
       @cancel_thread = false
       @connection_failed_messages = []
@@ -295,6 +436,7 @@ module Cosmos
         else
           Logger.info "#{@interface.name}: Starting connection maintenance"
         end
+        @pipeline.start if @pipeline
         while true
           break if @cancel_thread
 
@@ -319,14 +461,26 @@ module Cosmos
           when 'CONNECTED'
             if @interface.read_allowed?
               begin
-                packet = @interface.read
-                if packet
-                  handle_packet(packet)
-                  @count += 1
+                if @pipeline
+                  packets = @interface.read_batch
+                  if packets
+                    packets.each { |packet| @pipeline.push(packet) }
+                    @count += packets.length
+                  else
+                    Logger.info "#{@interface.name}: Internal disconnect requested (returned nil)"
+                    handle_connection_lost()
+                    break if @cancel_thread
+                  end
                 else
-                  Logger.info "#{@interface.name}: Internal disconnect requested (returned nil)"
-                  handle_connection_lost()
-                  break if @cancel_thread
+                  packet = @interface.read
+                  if packet
+                    handle_packet(packet)
+                    @count += 1
+                  else
+                    Logger.info "#{@interface.name}: Internal disconnect requested (returned nil)"
+                    handle_connection_lost()
+                    break if @cancel_thread
+                  end
                 end
               rescue Exception => err
                 handle_connection_lost(err)
@@ -344,6 +498,7 @@ module Cosmos
         # Try to do clean disconnect because we're going down
         disconnect(false)
       end
+      @pipeline.stop if @pipeline
       if @interface_or_router == 'INTERFACE'
         InterfaceStatusModel.set(@interface.as_json, scope: @scope)
       else
@@ -354,6 +509,16 @@ module Cosmos
 
     def handle_packet(packet)
       InterfaceStatusModel.set(@interface.as_json, scope: @scope)
+      packet = identify_packet(packet)
+      TelemetryTopic.write_packet(packet, scope: @scope)
+    end
+
+    # Identify a packet read from the interface and update the current value
+    # table
+    #
+    # @param packet [Packet] Packet read from the interface
+    # @return [Packet] Identified packet ready to write to the telemetry topic
+    def identify_packet(packet)
       packet.received_time = Time.now.sys unless packet.received_time
 
       if packet.stored
@@ -402,9 +567,8 @@ module Cosmos
         Logger.warn "#{@interface.name} #{packet.target_name} packet length: #{packet.length} starting with: #{prefix}"
       end
 
-      # Write to stream
       packet.received_count += 1
-      TelemetryTopic.write_packet(packet, scope: @scope)
+      packet
     end
 
     def handle_connection_failed(connect_error)
@@ -34,6 +34,17 @@ module Cosmos
           @cycle_time = option[1].to_i
         when 'CYCLE_SIZE' # Maximum size of a log file
           @cycle_size = option[1].to_i
+        when 'FLUSH_SIZE' # Bytes buffered before writing a log file
+          @flush_size = option[1].to_i
+        when 'FLUSH_INTERVAL' # Maximum seconds data is buffered, NONE to only flush on size
+          @flush_interval = ConfigParser.handle_nil(option[1])
+          @flush_interval = @flush_interval.to_f if @flush_interval
+        when 'DURABILITY' # NONE, ROTATE or milliseconds between fdatasync
+          @durability = option[1]
+        when 'COMPRESS' # Write zlib compressed log files
+          @compress = ConfigParser.handle_true_false(option[1])
+        when 'SUMMARY_ITEMS' # Add item minimums and maximums to the index summary. DECOM logs parse every packet's JSON again.
+          @summary_items = ConfigParser.handle_true_false(option[1])
         else
           Logger.error("Unknown option passed to microservice #{@name}: #{option}")
         end
@@ -44,6 +55,11 @@ module Cosmos
       # These settings limit the log file to 10 minutes or 50MB of data, whichever comes first
       @cycle_time = 600 unless @cycle_time # 10 minutes
       @cycle_size = 50_000_000 unless @cycle_size # ~50 MB
+      @flush_size = LogWriteBuffer::DEFAULT_FLUSH_SIZE unless @flush_size
+      @flush_interval = 1.0 unless defined?(@flush_interval) # Allow NONE to disable
+      @durability = :NONE unless @durability
+      @compress = false unless @compress
+      @summary_items = false unless @summary_items
     end
 
     def run
@@ -71,8 +87,13 @@ module Cosmos
         rt_label = "#{scope}__#{target_name}__#{packet_name}__rt__#{type}"
         stored_label = "#{scope}__#{target_name}__#{packet_name}__stored__#{type}"
         plws[topic] = {
-          :RT => PacketLogWriter.new(remote_log_directory, rt_label, true, @cycle_time, @cycle_size, redis_topic: topic),
-          :STORED => PacketLogWriter.new(remote_log_directory, stored_label, true, @cycle_time, @cycle_size, redis_topic: topic)
+          :RT => PacketLogWriter.new(remote_log_directory, rt_label, true, @cycle_time, @cycle_size, redis_topic: topic,
+                                     flush_size: @flush_size, flush_interval: @flush_interval, durability: @durability, compress: @compress,
+                                     summary_items: @summary_items),
+          :STORED => PacketLogWriter.new(remote_log_directory, stored_label, true, @cycle_time, @cycle_size, redis_topic: topic,
+                                         flush_size: @flush_size, flush_interval: @flush_interval, durability: @durability, compress: @compress,
+                                         summary_items: @summary_items),
+          :HISTOGRAM => @metric.histogram(name: "log_duration_seconds", labels: { "packet" => packet_name, "target" => target_name, "raw_or_decom" => @raw_or_decom.to_s, "cmd_or_tlm" => @cmd_or_tlm.to_s })
         }
       end
       return plws
@@ -96,8 +117,7 @@ module Cosmos
       plws[topic][rt_or_stored].write(packet_type, @cmd_or_tlm, target_name, packet_name, msg_hash["time"].to_i, rt_or_stored == :STORED, msg_hash[data_key], nil, msg_id)
       @count += 1
       diff = Process.clock_gettime(Process::CLOCK_MONOTONIC) - start # seconds as a float
-      metric_labels = { "packet" => packet_name, "target" => target_name, "raw_or_decom" => @raw_or_decom.to_s, "cmd_or_tlm" => @cmd_or_tlm.to_s }
-      @metric.add_sample(name: "log_duration_seconds", value: diff, labels: metric_labels)
+      plws[topic][:HISTOGRAM].record(diff)
     rescue => err
       @error = err
       Logger.error("#{@name} error: #{err.formatted}")
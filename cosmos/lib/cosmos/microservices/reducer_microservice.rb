@@ -21,6 +21,7 @@ require 'cosmos/microservices/microservice'
 require 'cosmos/topics/topic'
 require 'cosmos/packets/json_packet'
 require 'cosmos/utilities/s3_file_cache'
+require 'cosmos/utilities/reducer_accumulator'
 require 'cosmos/models/reducer_model'
 require 'rufus-scheduler'
 
@@ -38,6 +39,21 @@ module Cosmos
     HOUR_FILE_SECS = 3600 * 24
     DAY_ENTRY_SECS = 3600 * 24
     DAY_FILE_SECS = 3600 * 24 * 30
+    # Number of packets whose files are reduced at the same time
+    DEFAULT_WORKER_COUNT = 4
+    # Suffixes of the reduced values written for every item
+    REDUCED_SUFFIXES = %w(_SAMPLES _MIN _MAX _AVG _STDDEV)
+    # Type, entry seconds and file seconds of each tier updated by a cascade
+    CASCADE_TIERS = [
+      ['minute', MINUTE_ENTRY_SECS, MINUTE_FILE_SECS],
+      ['hour', HOUR_ENTRY_SECS, HOUR_FILE_SECS],
+      ['day', DAY_ENTRY_SECS, DAY_FILE_SECS],
+    ]
+
+    # Running minute, hour and day reductions of a single packet
+    Cascade = Struct.new(:plan, :keys, :tiers, :last_file)
+    # Reduction in progress for one tier of a Cascade
+    CascadeTier = Struct.new(:type, :entry_seconds, :file_seconds, :accumulator, :entry_time, :previous_time)
 
     # @param name [String] Microservice name formatted as <SCOPE>__REDUCER__<TARGET>
     #   where <SCOPE> and <TARGET> are variables representing the scope name and target name
@@ -45,6 +61,21 @@ module Cosmos
       super(name, is_plugin: false)
       @target_name = name.split('__')[-1]
       @packet_logs = {}
+      @packet_logs_mutex = Mutex.new
+      @worker_count = DEFAULT_WORKER_COUNT
+      @cascade = false
+      @cascades = {}
+      @cascades_mutex = Mutex.new
+      (@config['options'] || []).each do |option|
+        case option[0].upcase
+        when 'WORKER_COUNT' # Number of packets reduced in parallel
+          @worker_count = option[1].to_i
+        when 'CASCADE' # Reduce decom data to minutes, hours and days in one pass
+          @cascade = ConfigParser.handle_true_false(option[1])
+        else
+          Logger.error("Unknown option passed to microservice #{@name}: #{option}")
+        end
+      end
     end
 
     def run
@@ -93,149 +124,256 @@ module Cosmos
 
     def reduce_minute
       metric(MINUTE_METRIC) do
-        ReducerModel
-          .all_files(type: :DECOM, target: @target_name, scope: @scope)
-          .each do |file|
+        files = ReducerModel.all_files(type: :DECOM, target: @target_name, scope: @scope)
+        reduce_files(files) do |file|
+          if @cascade
+            cascade_file(file)
+          else
             process_file(file, 'minute', MINUTE_ENTRY_SECS, MINUTE_FILE_SECS)
-            ReducerModel.rm_file(file)
           end
+        end
       end
     end
 
     def reduce_hour
       metric(HOUR_METRIC) do
-        ReducerModel
-          .all_files(type: :MINUTE, target: @target_name, scope: @scope)
-          .each do |file|
-            process_file(file, 'hour', HOUR_ENTRY_SECS, HOUR_FILE_SECS)
-            ReducerModel.rm_file(file)
-          end
+        files = ReducerModel.all_files(type: :MINUTE, target: @target_name, scope: @scope)
+        reduce_files(files) do |file|
+          # Cascades reduce the hours from the decom data
+          process_file(file, 'hour', HOUR_ENTRY_SECS, HOUR_FILE_SECS) unless @cascade
+        end
       end
     end
 
     def reduce_day
       metric(DAY_METRIC) do
-        ReducerModel
-          .all_files(type: :HOUR, target: @target_name, scope: @scope)
-          .each do |file|
-            process_file(file, 'day', DAY_ENTRY_SECS, DAY_FILE_SECS)
-            ReducerModel.rm_file(file)
+        files = ReducerModel.all_files(type: :HOUR, target: @target_name, scope: @scope)
+        reduce_files(files) do |file|
+          # Cascades reduce the days from the decom data
+          process_file(file, 'day', DAY_ENTRY_SECS, DAY_FILE_SECS) unless @cascade
+        end
+      end
+    end
+
+    # Reduce files using up to @worker_count threads. Each packet's files are
+    # written to the same PacketLogWriter so they are reduced in time order
+    # by a single worker while different packets are reduced in parallel.
+    # Files are removed from the ReducerModel once the block returns.
+    #
+    # @param files [Array<String>] S3 keys of the files to reduce sorted by time
+    # @yieldparam file [String] S3 key of the file to reduce
+    def reduce_files(files)
+      return if files.empty?
+
+      queue = Queue.new
+      files.group_by { |file| file.split('__')[4] }.each_value { |packet_files| queue << packet_files }
+      queue.close
+
+      workers = [@worker_count, queue.length].min.clamp(1, queue.length)
+      threads = Array.new(workers) do
+        Thread.new do
+          while (packet_files = queue.pop)
+            packet_files.each do |file|
+              yield file
+              ReducerModel.rm_file(file)
+            end
           end
+        end
       end
+      threads.each(&:join)
     end
 
     def process_file(filename, type, entry_seconds, file_seconds)
       file = S3File.new(filename)
       file.retrieve
 
-      # Determine if we already have a PacketLogWriter created
-      start_time, end_time, scope, target_name, packet_name, _ =
-        filename.split('__')
-      if @target_name != target_name
-        raise "Target name in file #{filename} does not match microservice target name #{@target_name}"
-      end
-      plw = @packet_logs["#{scope}__#{target_name}__#{packet_name}__#{type}"]
-      unless plw
-        # Create a new PacketLogWriter for this reduced data
-        # e.g. DEFAULT/reduced_minute_logs/tlm/INST/HEALTH_STATUS/20220101/
-        # 20220101204857274290500__20220101205857276524900__DEFAULT__INST__HEALTH_STATUS__reduced__minute.bin
-        remote_log_directory = "#{scope}/reduced_#{type}_logs/tlm/#{target_name}/#{packet_name}"
-        rt_label = "#{scope}__#{target_name}__#{packet_name}__reduced__#{type}"
-        plw = PacketLogWriter.new(remote_log_directory, rt_label)
-        @packet_logs["#{scope}__#{target_name}__#{packet_name}__#{type}"] = plw
-      end
+      scope, target_name, packet_name = split_filename(filename)
+      plw = packet_log_writer(scope, target_name, packet_name, type)
 
-      reduced = {}
-      data_keys = nil
+      plan = nil
+      keys = nil
+      accumulator = nil
       entry_time = nil
       current_time = nil
       previous_time = nil
       plr = Cosmos::PacketLogReader.new
-      plr.each(file.local_path) do |packet|
-        # Ignore anything except numbers like STRING or BLOCK items
-        data = packet.read_all(:RAW).select { |key, value| value.is_a?(Numeric) }
-        converted_data = packet.read_all(:CONVERTED).select { |key, value| value.is_a?(Numeric) }
-        # Merge in the converted data which overwrites the raw
-        data.merge!(converted_data)
+      plr.each_entry(file.local_path) do |_, _, _, time_nsec_since_epoch, _, json_data|
+        # The items are fixed by the first packet so each gets a slot
+        unless plan
+          plan, keys = reduction_plan(type, JSON.parse(json_data))
+          accumulator = ReducerAccumulator.new(plan.length)
+        end
 
         previous_time = current_time
-        current_time = packet.packet_time.to_f
+        current_time = time_nsec_since_epoch / Time::NSEC_PER_SECOND.to_f
         entry_time ||= current_time
-        data_keys ||= data.keys
-
-        # Determine if we've rolled over a entry boundary
-        # We have to use current % entry_seconds < previous % entry_seconds because
-        # we don't know the data rates. We also have to check for current - previous >= entry_seconds
-        # in case the data rate is so slow we don't have multiple samples per entry
-        if previous_time &&
-             (
-               (current_time % entry_seconds < previous_time % entry_seconds) ||
-                 (current_time - previous_time >= entry_seconds)
-             )
+
+        if entry_boundary?(current_time, previous_time, entry_seconds)
           Logger.debug("Reducer: Roll over entry boundary cur_time:#{current_time}")
 
-          reduce(type, data_keys, reduced)
-          plw.write(
-            :JSON_PACKET,
-            :TLM,
-            target_name,
-            packet_name,
-            entry_time * Time::NSEC_PER_SECOND,
-            false,
-            JSON.generate(reduced.as_json),
-          )
+          write_reduced(plw, target_name, packet_name, entry_time, reduce(plan, accumulator))
           # Reset all our sample variables
           entry_time = current_time
-          reduced = {}
-
-          # Check to see if we should start a new log file
-          # We compare the current entry_time to see if it will push us over
-          if plw.first_time &&
-               (entry_time - plw.first_time.to_f) >= file_seconds
-            Logger.debug("Reducer: (1) start new file! old filename: #{plw.filename}")
-            plw.start_new_file # Automatically closes the current file
-          end
+          accumulator.reset
+          check_new_file(plw, entry_time, file_seconds)
         end
 
-        # Update statistics for this packet's values
-        data.each do |key, value|
-          if type == 'minute'
-            reduced["#{key}__VALS"] ||= []
-            reduced["#{key}__VALS"] << value
-            reduced["#{key}_MIN"] ||= value
-            reduced["#{key}_MIN"] = value if value < reduced["#{key}_MIN"]
-            reduced["#{key}_MAX"] ||= value
-            reduced["#{key}_MAX"] = value if value > reduced["#{key}_MAX"]
-          else
-            reduced[key] ||= value
-            reduced[key] = value if key.match(/_MIN$/) && value < reduced[key]
-            reduced[key] = value if key.match(/_MAX$/) && value > reduced[key]
-            if key.match(/_AVG$/)
-              reduced["#{key}__VALS"] ||= []
-              reduced["#{key}__VALS"] << value
-            end
-            if key.match(/_STDDEV$/)
-              reduced["#{key}__VALS"] ||= []
-              reduced["#{key}__VALS"] << value
-            end
-            if key.match(/_SAMPLES$/)
-              reduced["#{key}__VALS"] ||= []
-              reduced["#{key}__VALS"] << value
-            end
-          end
+        # Update statistics for this packet's values. The JSON is parsed
+        # without the GVL so other workers keep running.
+        if type == 'minute'
+          accumulator.add_json(json_data, keys)
+        else
+          accumulator.combine_json(json_data, keys)
         end
       end
       file.delete # Remove the local copy
 
       # See if this last entry should go in a new file
-      if plw.first_time &&
-        (entry_time - plw.first_time.to_f) >= file_seconds
-        Logger.debug("Reducer: (2) start new file! old filename: #{plw.filename}")
-        plw.start_new_file # Automatically closes the current file
-      end
+      check_new_file(plw, entry_time, file_seconds)
 
       # Write out the final data now that the file is done
-      reduce(type, data_keys, reduced)
+      write_reduced(plw, target_name, packet_name, entry_time, reduce(plan, accumulator))
+      true
+    rescue => e
+      if file.local_path and File.exist?(file.local_path)
+        Logger.error("Reducer Error: #{filename}:#{File.size(file.local_path)} bytes: \n#{e.formatted}")
+      else
+        Logger.error("Reducer Error: #{filename}:(Not Retrieved): \n#{e.formatted}")
+      end
+      false
+    end
+
+    # Reduce a decom file into the minute, hour and day tiers at once. Each
+    # packet's accumulators carry over between files so hour and day entries
+    # are reduced directly from the decom values. A checkpoint is saved after
+    # every file so a restart continues where it left off. The checkpoint
+    # records the file it was taken after so a file which was reduced but not
+    # yet removed from the ReducerModel is not reduced twice. Entries are never
+    # skipped by time so stored packets older than the checkpoint are kept.
+    #
+    # @param filename [String] S3 key of the decom file
+    # @return [Boolean] Whether the file was reduced
+    def cascade_file(filename)
+      scope, target_name, packet_name = split_filename(filename)
+      cascade = @cascades_mutex.synchronize do
+        @cascades[packet_name] ||= load_cascade(scope, target_name, packet_name)
+      end
+      if cascade.last_file == filename
+        Logger.debug("Reducer: Skipping #{filename} which was reduced before the checkpoint")
+        return true
+      end
+
+      file = S3File.new(filename)
+      file.retrieve
+
+      plr = Cosmos::PacketLogReader.new
+      plr.each_entry(file.local_path) do |_, _, _, time_nsec_since_epoch, _, json_data|
+        # The items are fixed by the first packet so each gets a slot
+        unless cascade.plan
+          cascade.plan, cascade.keys = reduction_plan('minute', JSON.parse(json_data))
+          cascade.tiers.each { |tier| tier.accumulator = ReducerAccumulator.new(cascade.plan.length) }
+        end
+
+        current_time = time_nsec_since_epoch / Time::NSEC_PER_SECOND.to_f
+        cascade.tiers.each do |tier|
+          if entry_boundary?(current_time, tier.previous_time, tier.entry_seconds)
+            plw = packet_log_writer(scope, target_name, packet_name, tier.type)
+            write_reduced(plw, target_name, packet_name, tier.entry_time, reduce(cascade.plan, tier.accumulator))
+            tier.entry_time = current_time
+            tier.accumulator.reset
+            check_new_file(plw, tier.entry_time, tier.file_seconds)
+          end
+          tier.entry_time ||= current_time
+          tier.previous_time = current_time
+          tier.accumulator.add_json(json_data, cascade.keys)
+        end
+      end
+      file.delete # Remove the local copy
+      cascade.last_file = filename
+
+      ReducerModel.set_checkpoint(cascade_checkpoint(cascade), packet: packet_name, target: target_name, scope: scope)
+      true
+    rescue => e
+      if file and file.local_path and File.exist?(file.local_path)
+        Logger.error("Reducer Error: #{filename}:#{File.size(file.local_path)} bytes: \n#{e.formatted}")
+      else
+        Logger.error("Reducer Error: #{filename}:(Not Retrieved): \n#{e.formatted}")
+      end
+      false
+    end
+
+    # @param cascade [Cascade] Cascade to save
+    # @return [Hash] Checkpoint which can be restored by {#load_cascade}
+    def cascade_checkpoint(cascade)
+      {
+        'plan' => cascade.plan,
+        'keys' => cascade.keys,
+        'last_file' => cascade.last_file,
+        'tiers' => cascade.tiers.map do |tier|
+          {
+            'entry_time' => tier.entry_time,
+            'previous_time' => tier.previous_time,
+            'stats' => tier.accumulator ? tier.accumulator.dump : nil,
+          }
+        end,
+      }
+    end
+
+    # @return [Cascade] Cascade restored from the last checkpoint or a new
+    #   cascade if there is no checkpoint
+    def load_cascade(scope, target_name, packet_name)
+      tiers = CASCADE_TIERS.map { |type, entry_seconds, file_seconds| CascadeTier.new(type, entry_seconds, file_seconds) }
+      cascade = Cascade.new(nil, nil, tiers, nil)
+      checkpoint = ReducerModel.get_checkpoint(packet: packet_name, target: target_name, scope: scope)
+      return cascade unless checkpoint and checkpoint['plan']
+
+      cascade.plan = checkpoint['plan'].map { |names| names.map(&:freeze).freeze }
+      cascade.keys = checkpoint['keys'].map { |key| key ? key.freeze : nil }
+      cascade.last_file = checkpoint['last_file']
+      tiers.zip(checkpoint['tiers']) do |tier, saved|
+        tier.entry_time = saved['entry_time']
+        tier.previous_time = saved['previous_time']
+        tier.accumulator = ReducerAccumulator.new(cascade.plan.length)
+        tier.accumulator.load(saved['stats']) if saved['stats']
+      end
+      cascade
+    end
+
+    # @return [Array<String>] Scope, target name and packet name of a file
+    def split_filename(filename)
+      _, _, scope, target_name, packet_name, _ = filename.split('__')
+      if @target_name != target_name
+        raise "Target name in file #{filename} does not match microservice target name #{@target_name}"
+      end
+      return scope, target_name, packet_name
+    end
+
+    # @return [PacketLogWriter] Writer for the reduced data of a packet
+    def packet_log_writer(scope, target_name, packet_name, type)
+      @packet_logs_mutex.synchronize do
+        @packet_logs["#{scope}__#{target_name}__#{packet_name}__#{type}"] ||= begin
+          # Create a new PacketLogWriter for this reduced data
+          # e.g. DEFAULT/reduced_minute_logs/tlm/INST/HEALTH_STATUS/20220101/
+          # 20220101204857274290500__20220101205857276524900__DEFAULT__INST__HEALTH_STATUS__reduced__minute.bin
+          remote_log_directory = "#{scope}/reduced_#{type}_logs/tlm/#{target_name}/#{packet_name}"
+          rt_label = "#{scope}__#{target_name}__#{packet_name}__reduced__#{type}"
+          PacketLogWriter.new(remote_log_directory, rt_label)
+        end
+      end
+    end
+
+    # Determine if we've rolled over a entry boundary
+    # We have to use current % entry_seconds < previous % entry_seconds because
+    # we don't know the data rates. We also have to check for current - previous >= entry_seconds
+    # in case the data rate is so slow we don't have multiple samples per entry
+    def entry_boundary?(current_time, previous_time, entry_seconds)
+      return false unless previous_time
+
+      (current_time % entry_seconds < previous_time % entry_seconds) ||
+        (current_time - previous_time >= entry_seconds)
+    end
+
+    def write_reduced(plw, target_name, packet_name, entry_time, reduced)
       plw.write(
         :JSON_PACKET,
         :TLM,
@@ -245,67 +383,71 @@ module Cosmos
         false,
         JSON.generate(reduced.as_json),
       )
-      true
-    rescue => e
-      if file.local_path and File.exist?(file.local_path)
-        Logger.error("Reducer Error: #{filename}:#{File.size(file.local_path)} bytes: \n#{e.formatted}")
-      else
-        Logger.error("Reducer Error: #{filename}:(Not Retrieved): \n#{e.formatted}")
+    end
+
+    # Check to see if we should start a new log file
+    # We compare the current entry_time to see if it will push us over
+    def check_new_file(plw, entry_time, file_seconds)
+      if plw.first_time &&
+           (entry_time - plw.first_time.to_f) >= file_seconds
+        Logger.debug("Reducer: start new file! old filename: #{plw.filename}")
+        plw.start_new_file # Automatically closes the current file
       end
-      false
     end
 
-    def reduce(type, data_keys, reduced)
-      # We've collected all the values so calculate the AVG and STDDEV
+    # Determine the items to reduce. Minute reductions reduce every numeric
+    # item (STRING or BLOCK items are ignored) using the converted value if
+    # it is numeric and the raw value otherwise. Hour and day reductions
+    # combine the existing reduced values of each item.
+    #
+    # @param type [String] 'minute', 'hour' or 'day'
+    # @param json_hash [Hash] Parsed JSON of the first packet in the file
+    # @return [Array<Array<String>>, Array<String|nil>] Item name followed
+    #   by the reduced value names (in REDUCED_SUFFIXES order) for each
+    #   accumulator slot and the keys to read from each packet
+    def reduction_plan(type, json_hash)
+      keys = []
       if type == 'minute'
-        data_keys.each do |key|
-          reduced["#{key}_SAMPLES"] = reduced["#{key}__VALS"].length
-          reduced["#{key}_AVG"], reduced["#{key}_STDDEV"] =
-            Math.stddev_population(reduced["#{key}__VALS"])
+        names = []
+        json_hash.each_key do |key|
+          name, suffix = key.split('__')
+          next if suffix and suffix != 'C'
+          next unless json_hash[key].is_a?(Numeric)
 
-          # Remove the raw values as they're only used for AVG / STDDEV calculation
-          reduced.delete("#{key}__VALS")
+          names << name
+        end
+        names.uniq!
+        names.each do |name|
+          converted_key = "#{name}__C"
+          keys << (json_hash.key?(converted_key) ? converted_key.freeze : nil)
+          keys << name
         end
       else
-        # Sort so we calculate the average first, then samples, then stddev
-        data_keys.sort.each do |key|
-          base_name = key.split('_')[0..-2].join('_')
-          case key
-          when /_AVG$/
-            weighted_sum = 0
-            samples = reduced["#{base_name}_SAMPLES__VALS"]
-            reduced["#{key}__VALS"].each_with_index do |val, i|
-              weighted_sum += (val * samples[i])
-            end
-            reduced[key] = weighted_sum / samples.sum
-          when /_SAMPLES$/
-            reduced[key] = reduced["#{base_name}_SAMPLES__VALS"].sum
-          when /_STDDEV$/
-            # Do the STDDEV calc last so we can use the previously calculated AVG
-            # See https://math.stackexchange.com/questions/1547141/aggregating-standard-deviation-to-a-summary-point
-            samples = reduced["#{base_name}_SAMPLES__VALS"]
-            avg = reduced["#{base_name}_AVG__VALS"]
-            s2 = 0
-            reduced["#{key}__VALS"].each_with_index do |val, i|
-              # puts "i:#{i} val:#{val} samples[i]:#{samples[i]} avg[i]:#{avg[i]}"
-              s2 += (samples[i] * avg[i]**2 + val**2)
-            end
+        names = json_hash.keys.select { |key| key.end_with?('_SAMPLES') }.map { |key| key[0..-9] }
+      end
+      plan = names.map do |name|
+        [name].concat(REDUCED_SUFFIXES.map { |suffix| "#{name}#{suffix}".freeze }).freeze
+      end
+      keys.concat(plan.flat_map { |reduced_names| reduced_names[1..-1] }) unless type == 'minute'
+      return plan, keys
+    end
 
-            # Note: For very large numbers with very small deviations this sqrt can fail.
-            # If so then just set the stddev to 0.
-            begin
-              reduced[key] =
-                Math.sqrt(s2 / samples.sum - reduced["#{base_name}_AVG"])
-            rescue Exception
-              reduced[key] = 0.0
-            end
-          end
-        end
-        data_keys.each do |key|
-          # Remove the raw values as they're only used for AVG / STDDEV calculation
-          reduced.delete("#{key}__VALS")
-        end
+    # @param plan [Array<Array<String>>] Plan from {#reduction_plan}
+    # @param accumulator [ReducerAccumulator] Statistics for each slot
+    # @return [Hash] Reduced values for every item with samples
+    def reduce(plan, accumulator)
+      reduced = {}
+      plan.each_with_index do |names, slot|
+        samples = accumulator.samples(slot)
+        next if samples == 0
+
+        reduced[names[1]] = samples
+        reduced[names[2]] = accumulator.min(slot)
+        reduced[names[3]] = accumulator.max(slot)
+        reduced[names[4]] = accumulator.mean(slot)
+        reduced[names[5]] = accumulator.stddev(slot)
       end
+      reduced
     end
   end
 end
@@ -24,6 +24,16 @@ module Cosmos
     VALUE_TYPES = [:RAW, :CONVERTED, :FORMATTED, :WITH_UNITS]
     # Stores telemetry item overrides which are returned on every request to get_item
     @overrides = {}
+    # Process local cache of parsed packet hashes keyed by scope__target__packet.
+    # Each entry is [monotonic fetch time, parsed hash].
+    @cache = {}
+    # Maximum age in seconds of a cached packet hash before it is fetched again.
+    # A value of 0 (the default) disables the cache.
+    @cache_timeout = ENV['COSMOS_CVT_CACHE_TIMEOUT'].to_f
+
+    class << self
+      attr_accessor :cache_timeout
+    end
 
     def self.build_json_from_packet(packet)
       json_hash = {}
@@ -40,14 +50,47 @@ module Cosmos
 
     # Delete the current value table for a target
     def self.del(target_name:, packet_name:, scope:)
+      invalidate(target_name: target_name, packet_name: packet_name, scope: scope)
       EphemeralStore.hdel("#{scope}__tlm__#{target_name}", packet_name)
     end
 
     # Set the current value table for a target, packet
     def self.set(hash, target_name:, packet_name:, scope:)
+      invalidate(target_name: target_name, packet_name: packet_name, scope: scope)
       EphemeralStore.hset("#{scope}__tlm__#{target_name}", packet_name, JSON.generate(hash.as_json))
     end
 
+    # Remove a packet from the process local cache so the next request
+    # fetches it from the current value table
+    def self.invalidate(target_name:, packet_name:, scope:)
+      @cache.delete("#{scope}__#{target_name}__#{packet_name}")
+    end
+
+    # Remove all packets from the process local cache
+    def self.clear_cache
+      @cache = {}
+    end
+
+    # Get the parsed current value table hash for a target, packet. If the
+    # cache is enabled the hash is reused until it is older than cache_timeout.
+    #
+    # @return [Hash, nil] Parsed packet hash or nil if the packet does not exist
+    def self.get_packet_hash(target_name:, packet_name:, scope:)
+      if @cache_timeout > 0
+        key = "#{scope}__#{target_name}__#{packet_name}"
+        now = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+        entry = @cache[key]
+        return entry[1] if entry and (now - entry[0]) < @cache_timeout
+      end
+      packet = EphemeralStore.hget("#{scope}__tlm__#{target_name}", packet_name)
+      return nil unless packet
+      hash = JSON.parse(packet)
+      # Hash assignment is atomic under the GVL so concurrent requests at
+      # worst fetch the same packet twice
+      @cache[key] = [now, hash] if @cache_timeout > 0
+      hash
+    end
+
     # Set an item in the current value table
     def self.set_item(target_name, packet_name, item_name, value, type:, scope:)
       case type
@@ -64,6 +107,7 @@ module Cosmos
       end
       hash = JSON.parse(EphemeralStore.hget("#{scope}__tlm__#{target_name}", packet_name))
       hash[field] = value
+      invalidate(target_name: target_name, packet_name: packet_name, scope: scope)
       EphemeralStore.hset("#{scope}__tlm__#{target_name}", packet_name, JSON.generate(hash.as_json))
     end
 
@@ -86,7 +130,8 @@ module Cosmos
       else
         raise "Unknown type '#{type}' for #{target_name} #{packet_name} #{item_name}"
       end
-      hash = JSON.parse(EphemeralStore.hget("#{scope}__tlm__#{target_name}", packet_name))
+      hash = get_packet_hash(target_name: target_name, packet_name: packet_name, scope: scope)
+      raise "Packet '#{target_name} #{packet_name}' does not exist" unless hash
       hash.values_at(*types).each do |result|
         return result if result
       end
@@ -106,9 +151,9 @@ module Cosmos
 
       lookups.each do |target_packet_key, target_name, packet_name, packet_values|
         unless packet_lookup[target_packet_key]
-          packet = EphemeralStore.hget("#{scope}__tlm__#{target_name}", packet_name)
+          packet = get_packet_hash(target_name: target_name, packet_name: packet_name, scope: scope)
           raise "Packet '#{target_name} #{packet_name}' does not exist" unless packet
-          packet_lookup[target_packet_key] = JSON.parse(packet)
+          packet_lookup[target_packet_key] = packet
         end
         hash = packet_lookup[target_packet_key]
         item_result = []
@@ -61,5 +61,19 @@ module Cosmos
     def self.all_files(type:, target:, scope:)
       Store.smembers("#{scope}__#{target}__reducer__#{type.downcase}").sort
     end
+
+    # Save the state of a cascaded reduction for a packet. Checkpoints are
+    # stored in a Redis hash named SCOPE__TARGET__reducer__checkpoint keyed
+    # by packet name.
+    def self.set_checkpoint(checkpoint, packet:, target:, scope:)
+      Store.hset("#{scope}__#{target}__reducer__checkpoint", packet, JSON.generate(checkpoint))
+    end
+
+    def self.get_checkpoint(packet:, target:, scope:)
+      checkpoint = Store.hget("#{scope}__#{target}__reducer__checkpoint", packet)
+      return nil unless checkpoint
+
+      JSON.parse(checkpoint)
+    end
   end
 end
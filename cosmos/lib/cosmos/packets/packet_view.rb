@@ -0,0 +1,151 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require 'cosmos/packets/packet'
+
+module Cosmos
+  # Read only view of a packet buffer using a shared packet definition. Items
+  # are only decoded when read and the definition is never modified so a
+  # view is much cheaper than building or updating a {Packet}.
+  #
+  # Views returned by {PacketLogReader#each_view} are reused for every entry
+  # so call {#retain} to keep one beyond the current iteration.
+  class PacketView
+    # @return [Packet] Packet definition used to decode items
+    attr_reader :packet
+    # @return [Symbol] :CMD or :TLM
+    attr_reader :cmd_or_tlm
+    # @return [String] Packet data
+    attr_reader :buffer
+    # @return [Integer] Received time in nanoseconds since the epoch
+    attr_reader :received_time_nsec
+    # @return [Boolean] Whether the packet was stored telemetry
+    attr_reader :stored
+
+    # @param packet [Packet|nil] Packet definition
+    # @param cmd_or_tlm [Symbol] :CMD or :TLM
+    # @param received_time_nsec [Integer|nil] Received time in nanoseconds
+    #   since the epoch
+    # @param stored [Boolean] Whether the packet was stored telemetry
+    # @param buffer [String|nil] Packet data
+    def initialize(packet = nil, cmd_or_tlm = :TLM, received_time_nsec = nil, stored = false, buffer = nil)
+      set(packet, cmd_or_tlm, received_time_nsec, stored, buffer)
+    end
+
+    # Point the view at a new buffer
+    #
+    # @param (see #initialize)
+    # @return [PacketView] self
+    def set(packet, cmd_or_tlm, received_time_nsec, stored, buffer)
+      @packet = packet
+      @cmd_or_tlm = cmd_or_tlm
+      @received_time_nsec = received_time_nsec
+      @stored = stored
+      @buffer = buffer
+      @received_time = nil
+      @defined_packet = nil
+      @item_buffer = nil
+      self
+    end
+
+    # @return [String] Target name
+    def target_name
+      @packet.target_name
+    end
+
+    # @return [String] Packet name
+    def packet_name
+      @packet.packet_name
+    end
+
+    # @return [Time|nil] Received time
+    def received_time
+      if !@received_time and @received_time_nsec
+        @received_time = Time.from_nsec_from_epoch(@received_time_nsec)
+        @received_time.freeze
+      end
+      @received_time
+    end
+
+    # (see Packet#packet_time)
+    def packet_time
+      item = @packet.items['PACKET_TIME'.freeze]
+      if item
+        return read_item(item, :CONVERTED)
+      else
+        return received_time()
+      end
+    end
+
+    # Read an item by name
+    #
+    # @param name [String] Name of the item to read
+    # @param value_type (see Packet#read_item)
+    # @return (see Packet#read_item)
+    def read(name, value_type = :CONVERTED)
+      read_item(@packet.get_item(name), value_type)
+    end
+
+    # Read an item. Derived items may depend on the packet state (like the
+    # received time) so they are read from a full packet built by
+    # {#to_packet}. All other items are decoded directly from the buffer.
+    #
+    # @param item [PacketItem] Item from the packet definition
+    # @param value_type (see Packet#read_item)
+    # @return (see Packet#read_item)
+    def read_item(item, value_type = :CONVERTED)
+      if item.data_type == :DERIVED
+        @defined_packet ||= to_packet()
+        @defined_packet.read_item(item, value_type)
+      else
+        @packet.read_item(item, value_type, item_buffer())
+      end
+    end
+
+    # @return [PacketView] Copy of the view which is not changed when the
+    #   original is reused
+    def retain
+      PacketView.new(@packet, @cmd_or_tlm, @received_time_nsec, @stored, @buffer)
+    end
+
+    # @return [Packet] A new packet holding a copy of the buffer
+    def to_packet
+      packet = @packet.clone
+      packet.buffer = @buffer
+      packet.set_received_time_fast(received_time())
+      packet.cmd_or_tlm = @cmd_or_tlm
+      packet.stored = @stored
+      packet
+    end
+
+    protected
+
+    # Short buffers are zero filled to the defined length like Packet#buffer=
+    def item_buffer
+      return @item_buffer if @item_buffer
+
+      @item_buffer = @buffer
+      if @buffer.length < @packet.defined_length
+        Logger.instance.error "#{target_name()} #{packet_name()} received with actual packet length of #{@buffer.length} but defined length of #{@packet.defined_length}"
+        @item_buffer = @buffer + (Packet::ZERO_STRING * (@packet.defined_length - @buffer.length))
+      end
+      @item_buffer
+    end
+  end
+end
@@ -29,6 +29,8 @@ module Cosmos
     attr_reader :write_socket
 
     FAST_READ = (RUBY_VERSION > "2.1")
+    # Maximum number of bytes returned by a single read
+    READ_BUFFER_SIZE = 65535
 
     # @param write_socket [Socket] Socket to write
     # @param read_socket [Socket] Socket to read
@@ -51,6 +53,11 @@ module Cosmos
       @write_mutex = Mutex.new
       @pipe_reader, @pipe_writer = IO.pipe
       @connected = false
+
+      # Reads go into the same buffer every time and only the bytes read are
+      # copied out, which avoids allocating a full sized String per read
+      @read_buffer = String.new(capacity: READ_BUFFER_SIZE)
+      @read_select = [@read_socket, @pipe_reader]
     end
 
     # @return [String] Returns a binary string of data from the socket
@@ -61,13 +68,13 @@ module Cosmos
       if FAST_READ
         begin
           while true # Loop until we get some data
-            data = @read_socket.read_nonblock(65535, exception: false)
+            data = read_buffer_nonblock()
             raise EOFError, 'end of file reached' unless data
 
             if data == :wait_readable
               # Wait for the socket to be ready for reading or for the timeout
               begin
-                result = IO.fast_select([@read_socket, @pipe_reader], nil, nil, @read_timeout)
+                result = IO.fast_select(@read_select, nil, nil, @read_timeout)
                 # If select returns something it means the socket is now available for
                 # reading so retry the read. If it returns nil it means we timed out.
                 # If the pipe is present that means we closed the socket
@@ -127,7 +134,7 @@ module Cosmos
       # No read mutex is needed because reads happen serially
       begin
         if FAST_READ
-          data = @read_socket.read_nonblock(65535, exception: false)
+          data = read_buffer_nonblock()
           raise EOFError, 'end of file reached' unless data
 
           data = '' if data == :wait_readable
@@ -191,5 +198,19 @@ module Cosmos
       @pipe_writer.write('.')
       @connected = false
     end
+
+    protected
+
+    # Reads the available data into the reused read buffer
+    #
+    # @return [String|Symbol|nil] Copy of the data read, :wait_readable if
+    #   there was no data or nil at end of file
+    def read_buffer_nonblock
+      result = @read_socket.read_nonblock(READ_BUFFER_SIZE, @read_buffer, exception: false)
+      return result unless result.equal?(@read_buffer)
+
+      # Copy only the bytes read so the buffer keeps its capacity for the next read
+      String.new(capacity: @read_buffer.length) << @read_buffer
+    end
   end # class TcpipSocketStream
 end # module Cosmos
@@ -22,15 +22,33 @@ require 'cosmos/topics/topic'
 module Cosmos
   class TelemetryTopic < Topic
     def self.write_packet(packet, scope:)
+      topic, msg_hash = build_entry(packet, scope: scope)
+      Topic.write_topic(topic, msg_hash)
+    end
+
+    # Build the topic entry for a packet without writing it
+    #
+    # @param packet [Packet] Identified telemetry packet
+    # @param copy_buffer [Boolean] Whether to copy the packet buffer so later
+    #   updates to the packet don't change the entry
+    # @return [Array(String, Hash)] Topic and msg_hash
+    def self.build_entry(packet, copy_buffer = false, scope:)
       msg_hash = {
         :time => packet.received_time.to_nsec_from_epoch,
         :stored => packet.stored,
         :target_name => packet.target_name,
         :packet_name => packet.packet_name,
         :received_count => packet.received_count,
-        :buffer => packet.buffer(false),
+        :buffer => packet.buffer(copy_buffer),
       }
-      Topic.write_topic("#{scope}__TELEMETRY__{#{packet.target_name}}__#{packet.packet_name}", msg_hash)
+      return "#{scope}__TELEMETRY__{#{packet.target_name}}__#{packet.packet_name}", msg_hash
+    end
+
+    # Write entries from build_entry with a single round trip
+    #
+    # @param entries [Array<Array(String, Hash)>] Entries in the order to write
+    def self.write_entries(entries)
+      Topic.write_topics(entries)
     end
   end
 end
@@ -88,6 +88,7 @@ module Cosmos
         (0..255).each do |index|
           @table << [compute_table_entry(index, @bit_size)].pack(pack)
         end
+        build_engine()
       else
         (0..255).each do |index|
           @table << (compute_table_entry(index, @bit_size) & filter_mask)
@@ -104,6 +105,41 @@ module Cosmos
     #     to use the default seed set in the constructor.
     #   @return [Integer] The CRC value
 
+    # @!method update(state, data, offset = 0, length = nil)
+    #   Continues a CRC calculation across more data so the CRC of data which
+    #   arrives in pieces can be calculated without joining it. Pass the
+    #   returned state to the next update and finally to {#finalize}.
+    #   Implemented in C for speed.
+    #
+    #   @param state [Integer|nil] State returned by the previous update or
+    #     a seed value to start the calculation. Pass nil to use the default
+    #     seed set in the constructor.
+    #   @param data [String] String buffer of binary data
+    #   @param offset [Integer] Index of the first byte in data
+    #   @param length [Integer|nil] Number of bytes. Defaults to the rest of
+    #     the data.
+    #   @return [Integer] The updated CRC state
+
+    # @!method finalize(state)
+    #   @param state [Integer] State returned by {#update}
+    #   @return [Integer] The CRC value
+
+    # @!method calc_range(data, offset, length)
+    #   Calculates the CRC across part of the data buffer without copying it.
+    #   Implemented in C for speed.
+    #
+    #   @param data [String] String buffer of binary data
+    #   @param offset [Integer] Index of the first byte in data
+    #   @param length [Integer] Number of bytes
+    #   @return [Integer] The CRC value
+
+    # @!method build_engine
+    #   Caches the configuration and lookup tables in a C struct. Reflected
+    #   CRCs use bit reversed tables so no per byte bit reversal is needed.
+    #   32 and 64-bit CRCs process 8 bytes per step with slicing-by-8 tables
+    #   and the standard reflected CRC-32 uses carry-less multiply folding
+    #   when the processor supports it. Implemented in C.
+
     # Bit reverse the 8 bit value
     # @param value [Integer]
     # @return [Integer] Bit reversed value
@@ -135,44 +171,43 @@ module Cosmos
     end
 
     if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
-      def calc(data, seed = @seed)
-        crc = seed
+      def calc(data, seed = nil)
+        finalize(update(seed, data))
+      end
 
-        case @bit_size
-        when 16
-          right_shift = 8
-          filter_mask = 0xFFFF
-          final_bit_reverse = method(:bit_reverse_16)
-        when 32
-          right_shift = 24
-          filter_mask = 0xFFFFFFFF
-          final_bit_reverse = method(:bit_reverse_32)
-        when 64
-          right_shift = 56
-          filter_mask = 0xFFFFFFFFFFFFFFFF
-          final_bit_reverse = method(:bit_reverse_64)
+      def calc_range(data, offset, length)
+        finalize(update(nil, data, offset, length))
+      end
+
+      def update(state, data, offset = 0, length = nil)
+        crc = state || @seed
+        length = data.length - offset unless length
+        if offset < 0 or length < 0 or offset > data.length or length > (data.length - offset)
+          raise IndexError, "Range #{offset}, #{length} outside of the #{data.length} bytes of data"
         end
 
-        if @reflect
-          data.each_byte do |byte|
-            crc = ((crc << 8) & filter_mask) ^ @table[(crc >> right_shift) ^ bit_reverse_8(byte)]
-          end
+        filter_mask = (1 << @bit_size) - 1
+        right_shift = @bit_size - 8
+        (offset...(offset + length)).each do |index|
+          byte = data.getbyte(index)
+          byte = bit_reverse_8(byte) if @reflect
+          crc = ((crc << 8) & filter_mask) ^ @table[(crc >> right_shift) ^ byte]
+        end
+        crc
+      end
+
+      def finalize(state)
+        crc = state
+        crc ^= (1 << @bit_size) - 1 if @xor
+        return crc unless @reflect
 
-          if @xor
-            return final_bit_reverse.call(crc ^ filter_mask)
-          else
-            return final_bit_reverse.call(crc)
-          end
+        case @bit_size
+        when 16
+          bit_reverse_16(crc)
+        when 32
+          bit_reverse_32(crc)
         else
-          data.each_byte do |byte|
-            crc = ((crc << 8) & filter_mask) ^ @table[(crc >> right_shift) ^ byte]
-          end
-
-          if @xor
-            return crc ^ filter_mask
-          else
-            return crc
-          end
+          bit_reverse_64(crc)
         end
       end
     end
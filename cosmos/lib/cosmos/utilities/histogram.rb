@@ -0,0 +1,159 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require 'cosmos/ext/histogram' if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT']
+
+module Cosmos
+  # Fixed memory latency histogram using logarithmic buckets. Each power of
+  # two is split into SUB_BUCKET_COUNT linear buckets so every recorded value
+  # is accurate to about 3%. Values are recorded in seconds and stored as
+  # nanoseconds from 1 ns up to about 73 minutes (larger values are clamped).
+  #
+  # Recording never allocates. The C implementation runs while holding the
+  # GVL so concurrent threads may record into the same histogram without a
+  # lock. The Ruby implementation takes a mutex to record and reset.
+  class Histogram
+    # Number of linear buckets per power of two (must be a power of two)
+    SUB_BUCKET_BITS = 5
+    SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS
+    # Largest recordable value in nanoseconds
+    MAX_NSEC = (1 << 42) - 1
+    # Number of buckets needed to cover 0 to MAX_NSEC
+    BUCKET_COUNT = ((42 - SUB_BUCKET_BITS) * SUB_BUCKET_COUNT) + SUB_BUCKET_COUNT
+    # Index of the total count in @counts
+    COUNT_INDEX = 0
+    # Index of the maximum value in nanoseconds in @counts
+    MAX_INDEX = 1
+    # Index of the first bucket in @counts
+    BUCKET_OFFSET = 2
+    NSEC_PER_SECOND = 1_000_000_000.0
+
+    # @return [String|Array] Count, max and bucket counts. A binary String of
+    #   native 64 bit integers when using the C extension.
+    attr_reader :counts
+
+    def initialize
+      if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT']
+        @counts = "\x00" * ((BUCKET_COUNT + BUCKET_OFFSET) * 8)
+      else
+        @counts = Array.new(BUCKET_COUNT + BUCKET_OFFSET, 0)
+        @mutex = Mutex.new
+      end
+    end
+
+    # @!method record(value)
+    #   Record a value. Implemented in C for speed.
+    #
+    #   @param value [Float] Value in seconds
+    #   @return [nil]
+
+    # @!method count
+    #   @return [Integer] Number of values recorded
+
+    # @!method max
+    #   @return [Float] Largest value recorded in seconds
+
+    # @!method percentile(percentile)
+    #   Value at the given percentile. The result is the midpoint of the
+    #   bucket containing the value.
+    #
+    #   @param percentile [Float] Percentile from 0 to 100
+    #   @return [Float] Value in seconds (0.0 if nothing has been recorded)
+
+    # @!method reset
+    #   Clear all recorded values
+    #   @return [nil]
+
+    # @!method snapshot_and_reset
+    #   Copy the recorded values and clear them in one step so values recorded
+    #   by other threads while a snapshot is reported aren't lost
+    #   @return [Histogram] Histogram holding the values which were cleared
+
+    if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
+      def record(value)
+        nsec = (value * NSEC_PER_SECOND).to_i
+        nsec = 0 if nsec < 0
+        nsec = MAX_NSEC if nsec > MAX_NSEC
+        index = BUCKET_OFFSET + bucket_index(nsec)
+        @mutex.synchronize do
+          @counts[index] += 1
+          @counts[COUNT_INDEX] += 1
+          @counts[MAX_INDEX] = nsec if nsec > @counts[MAX_INDEX]
+        end
+        nil
+      end
+
+      def count
+        @counts[COUNT_INDEX]
+      end
+
+      def max
+        @counts[MAX_INDEX] / NSEC_PER_SECOND
+      end
+
+      def percentile(percentile)
+        total = @counts[COUNT_INDEX]
+        return 0.0 if total == 0
+
+        target = ((percentile / 100.0) * total).ceil
+        target = 1 if target < 1
+        cumulative = 0
+        BUCKET_COUNT.times do |index|
+          cumulative += @counts[BUCKET_OFFSET + index]
+          return bucket_value(index) / NSEC_PER_SECOND if cumulative >= target
+        end
+        max()
+      end
+
+      def reset
+        @mutex.synchronize { @counts.fill(0) }
+        nil
+      end
+
+      def snapshot_and_reset
+        snapshot = Histogram.new
+        @mutex.synchronize do
+          snapshot.counts.replace(@counts)
+          @counts.fill(0)
+        end
+        snapshot
+      end
+
+      protected
+
+      # @param nsec [Integer] Value in nanoseconds
+      # @return [Integer] Bucket holding the value
+      def bucket_index(nsec)
+        return nsec if nsec < (SUB_BUCKET_COUNT << 1)
+
+        shift = nsec.bit_length - SUB_BUCKET_BITS - 1
+        (shift * SUB_BUCKET_COUNT) + (nsec >> shift)
+      end
+
+      # @param index [Integer] Bucket index
+      # @return [Float] Midpoint of the bucket in nanoseconds
+      def bucket_value(index)
+        return index.to_f if index < (SUB_BUCKET_COUNT << 1)
+
+        shift = (index >> SUB_BUCKET_BITS) - 1
+        ((index - (shift * SUB_BUCKET_COUNT)) << shift) + ((1 << shift) / 2.0)
+      end
+    end
+  end
+end
@@ -18,6 +18,7 @@
 # copyright holder
 
 require 'cosmos/models/metric_model'
+require 'cosmos/utilities/histogram'
 require 'thread'
 
 module Cosmos
@@ -36,6 +37,7 @@ module Cosmos
     # items = {"name|labels" => [value_array], ...}
 
     attr_reader :items
+    attr_reader :histograms
     attr_accessor :size
     attr_reader :scope
     attr_reader :microservice
@@ -46,6 +48,7 @@ module Cosmos
       end
 
       @items = {}
+      @histograms = {}
       @scope = scope
       @microservice = microservice
       @size = 5000
@@ -84,6 +87,29 @@ module Cosmos
       end
     end
 
+    def histogram(name:, labels:)
+      # register a fixed memory latency histogram for a name and label set
+      # and return it so the caller can hold onto it and record values
+      # without building a key or allocating anything per sample.
+      #    histogram = @metric.histogram(name: "decom_duration_seconds", labels: {"target"=>"INST"})
+      #    histogram.record(0.0012)
+      # registering the same name and labels again returns the same
+      # histogram. histograms are reported with the 50, 99 and 99.9
+      # percentiles and the max value. each histogram is reset after it is
+      # output so every report only covers the values recorded since the
+      # previous output, like the add_sample window.
+      # internal:
+      # the key is built the same way as the add_sample key and looked up in
+      # the histograms hash. callers record into the histogram without
+      # taking @mutex so output takes a snapshot of each histogram and resets
+      # it in one step. values recorded while output is running are kept for
+      # the next output.
+      @mutex.synchronize do
+        key = "#{name}|" + labels.map { |k, v| "#{k}=#{v}" }.join(',')
+        @histograms[key] ||= Histogram.new
+      end
+    end
+
     def percentile(sorted_values, percentile)
       # get the percentile out of an ordered array
       len = sorted_values.length
@@ -131,6 +157,30 @@ module Cosmos
             Logger.error("failed attempt to update metric, #{key}, #{name} #{@scope}")
           end
         end
+        @histograms.each do |key, histogram|
+          histogram = histogram.snapshot_and_reset
+          next if histogram.count == 0
+
+          label_list = []
+          name, labels = key.split('|')
+          metric_labels = labels.nil? ? {} : labels.split(',').map { |x| x.split('=') }.map { |k, v| { k => v } }.reduce({}, :merge)
+          for percentile_value in [50, 99, 99.9, 'max']
+            labels = metric_labels.clone.merge({ 'scope' => @scope, 'microservice' => @microservice })
+            labels['percentile'] = percentile_value
+            if percentile_value == 'max'
+              labels['metric__value'] = histogram.max
+            else
+              labels['metric__value'] = histogram.percentile(percentile_value)
+            end
+            label_list.append(labels)
+          end
+          begin
+            metric = MetricModel.new(name: @microservice, scope: @scope, metric_name: name, label_list: label_list)
+            metric.create(force: true)
+          rescue RuntimeError
+            Logger.error("failed attempt to update metric, #{key}, #{name} #{@scope}")
+          end
+        end
       end
     end
 
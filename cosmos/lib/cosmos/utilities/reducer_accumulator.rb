@@ -0,0 +1,320 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require 'json'
+require 'cosmos/ext/reducer_accumulator' if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT']
+
+module Cosmos
+  # Fixed memory running statistics for a set of items identified by slot
+  # number. Each slot tracks the sample count, min, max, mean and the sum of
+  # squared differences from the mean (M2) so the population standard
+  # deviation is available without keeping the individual values.
+  #
+  # Raw values are added with {#add} using Welford's algorithm. Statistics
+  # which were already reduced (e.g. minute data being reduced to hours) are
+  # merged with {#combine} using the parallel form of the same algorithm so
+  # the combined standard deviation is exact.
+  #
+  # Min and max are returned as Integers if every value given to the slot was
+  # an Integer. Integers are held as doubles so they are exact up to 2**53.
+  class ReducerAccumulator
+    # Index of each value within a slot
+    COUNT_INDEX = 0
+    MIN_INDEX = 1
+    MAX_INDEX = 2
+    MEAN_INDEX = 3
+    M2_INDEX = 4
+    INTEGER_INDEX = 5
+    # Number of values held per slot
+    SLOT_SIZE = 6
+
+    # @return [Integer] Number of slots
+    attr_reader :size
+    # @return [String|Array] Statistics for every slot. A binary String of
+    #   native doubles when using the C extension.
+    attr_reader :stats
+
+    # @param size [Integer] Number of slots
+    def initialize(size)
+      @size = size
+      if RUBY_ENGINE == 'ruby' and !ENV['COSMOS_NO_EXT']
+        @stats = "\x00" * (size * SLOT_SIZE * 8)
+      else
+        @stats = Array.new(size * SLOT_SIZE, 0)
+      end
+      reset()
+    end
+
+    # @return [Array<Float>] Statistics for every slot which can be saved
+    #   (e.g. as JSON) and restored with {#load}
+    def dump
+      if @stats.is_a?(String)
+        @stats.unpack('d*')
+      else
+        @stats.map(&:to_f)
+      end
+    end
+
+    # @param values [Array<Numeric>] Statistics returned by {#dump}
+    def load(values)
+      if values.length != @size * SLOT_SIZE
+        raise ArgumentError, "Expected #{@size * SLOT_SIZE} values but got #{values.length}"
+      end
+
+      if @stats.is_a?(String)
+        @stats = values.pack('d*')
+      else
+        @stats = values.each_with_index.map do |value, index|
+          case index % SLOT_SIZE
+          when COUNT_INDEX, INTEGER_INDEX
+            value.to_i
+          else
+            value.to_f
+          end
+        end
+      end
+      nil
+    end
+
+    # @!method add(slot, value)
+    #   Add a value to a slot. Implemented in C for speed.
+    #
+    #   @param slot [Integer] Slot number
+    #   @param value [Numeric] Value to add
+    #   @return [nil]
+
+    # @!method combine(slot, samples, min, max, mean, stddev)
+    #   Merge previously reduced statistics into a slot
+    #
+    #   @param slot [Integer] Slot number
+    #   @param samples [Integer] Number of samples in the reduced statistics
+    #   @param min [Numeric] Minimum value
+    #   @param max [Numeric] Maximum value
+    #   @param mean [Numeric] Mean value
+    #   @param stddev [Numeric] Population standard deviation
+    #   @return [nil]
+
+    # @!method add_hash(hash, keys)
+    #   Add the numeric values from a Hash to every slot. Each slot has two
+    #   keys: the converted value key (or nil) and the raw value key. The raw
+    #   value is used when the converted value is missing or not numeric and
+    #   slots without a numeric value are left unchanged.
+    #
+    #   @param hash [Hash] Values such as a {JsonPacket#json_hash}
+    #   @param keys [Array<String|nil>] Two keys for each slot
+    #   @return [nil]
+
+    # @!method combine_hash(hash, keys)
+    #   Merge reduced statistics from a Hash into every slot. Each slot has
+    #   the samples, min, max, mean and stddev keys in that order. Slots
+    #   without all five numeric values are left unchanged.
+    #
+    #   @param hash [Hash] Values such as a {JsonPacket#json_hash}
+    #   @param keys [Array<String>] Five keys for each slot
+    #   @return [nil]
+
+    # @!method add_json(json, keys)
+    #   Same as {#add_hash} but takes a JSON object. The C extension parses
+    #   the numeric values without holding the GVL so several threads can
+    #   reduce at once.
+    #
+    #   @param json [String] JSON object such as a JSON_PACKET log entry
+    #   @param keys (see #add_hash)
+    #   @return [nil]
+
+    # @!method combine_json(json, keys)
+    #   Same as {#combine_hash} but takes a JSON object which the C extension
+    #   parses without holding the GVL
+    #
+    #   @param json [String] JSON object such as a JSON_PACKET log entry
+    #   @param keys (see #combine_hash)
+    #   @return [nil]
+
+    # @!method samples(slot)
+    #   @return [Integer] Number of samples in the slot
+
+    # @!method min(slot)
+    #   @return [Numeric|nil] Minimum value or nil if the slot is empty
+
+    # @!method max(slot)
+    #   @return [Numeric|nil] Maximum value or nil if the slot is empty
+
+    # @!method mean(slot)
+    #   @return [Float|nil] Mean value or nil if the slot is empty
+
+    # @!method stddev(slot)
+    #   @return [Float|nil] Population standard deviation or nil if the slot
+    #     is empty
+
+    # @!method reset
+    #   Clear every slot
+    #   @return [nil]
+
+    if RUBY_ENGINE != 'ruby' or ENV['COSMOS_NO_EXT']
+      def add(slot, value)
+        offset = slot_offset(slot)
+        count = @stats[offset + COUNT_INDEX] + 1
+        float = value.to_f
+        @stats[offset + COUNT_INDEX] = count
+        @stats[offset + INTEGER_INDEX] = 0 unless value.is_a?(Integer)
+        if count == 1
+          @stats[offset + MIN_INDEX] = float
+          @stats[offset + MAX_INDEX] = float
+        else
+          @stats[offset + MIN_INDEX] = float if float < @stats[offset + MIN_INDEX]
+          @stats[offset + MAX_INDEX] = float if float > @stats[offset + MAX_INDEX]
+        end
+        delta = float - @stats[offset + MEAN_INDEX]
+        @stats[offset + MEAN_INDEX] += delta / count
+        @stats[offset + M2_INDEX] += delta * (float - @stats[offset + MEAN_INDEX])
+        nil
+      end
+
+      def combine(slot, samples, min, max, mean, stddev)
+        return nil if samples <= 0
+
+        offset = slot_offset(slot)
+        count = @stats[offset + COUNT_INDEX]
+        total = count + samples
+        mean = mean.to_f
+        m2 = stddev.to_f * stddev.to_f * samples
+        @stats[offset + INTEGER_INDEX] = 0 unless min.is_a?(Integer) and max.is_a?(Integer)
+        if count == 0
+          @stats[offset + MIN_INDEX] = min.to_f
+          @stats[offset + MAX_INDEX] = max.to_f
+          @stats[offset + MEAN_INDEX] = mean
+          @stats[offset + M2_INDEX] = m2
+        else
+          @stats[offset + MIN_INDEX] = min.to_f if min < @stats[offset + MIN_INDEX]
+          @stats[offset + MAX_INDEX] = max.to_f if max > @stats[offset + MAX_INDEX]
+          delta = mean - @stats[offset + MEAN_INDEX]
+          @stats[offset + MEAN_INDEX] += delta * samples / total
+          @stats[offset + M2_INDEX] += m2 + (delta * delta * count * samples / total)
+        end
+        @stats[offset + COUNT_INDEX] = total
+        nil
+      end
+
+      def add_hash(hash, keys)
+        check_key_count(keys, 2)
+        @size.times do |slot|
+          value = nil
+          converted_key = keys[slot * 2]
+          value = hash[converted_key] if converted_key
+          value = hash[keys[(slot * 2) + 1]] unless value.is_a?(Numeric)
+          add(slot, value) if value.is_a?(Numeric)
+        end
+        nil
+      end
+
+      def combine_hash(hash, keys)
+        check_key_count(keys, 5)
+        @size.times do |slot|
+          values = keys[slot * 5, 5].map { |key| hash[key] }
+          combine(slot, *values) if values.all? { |value| value.is_a?(Numeric) }
+        end
+        nil
+      end
+
+      def add_json(json, keys)
+        add_hash(parse_json(json), keys)
+      end
+
+      def combine_json(json, keys)
+        combine_hash(parse_json(json), keys)
+      end
+
+      def samples(slot)
+        @stats[slot_offset(slot) + COUNT_INDEX]
+      end
+
+      def min(slot)
+        extreme(slot, MIN_INDEX)
+      end
+
+      def max(slot)
+        extreme(slot, MAX_INDEX)
+      end
+
+      def mean(slot)
+        offset = slot_offset(slot)
+        return nil if @stats[offset + COUNT_INDEX] == 0
+
+        @stats[offset + MEAN_INDEX]
+      end
+
+      def stddev(slot)
+        offset = slot_offset(slot)
+        count = @stats[offset + COUNT_INDEX]
+        return nil if count == 0
+
+        variance = @stats[offset + M2_INDEX] / count
+        # Rounding can leave a tiny negative variance for constant values
+        variance = 0.0 if variance < 0.0
+        Math.sqrt(variance)
+      end
+
+      def reset
+        @size.times do |slot|
+          offset = slot * SLOT_SIZE
+          @stats[offset + COUNT_INDEX] = 0
+          @stats[offset + MIN_INDEX] = 0.0
+          @stats[offset + MAX_INDEX] = 0.0
+          @stats[offset + MEAN_INDEX] = 0.0
+          @stats[offset + M2_INDEX] = 0.0
+          @stats[offset + INTEGER_INDEX] = 1
+        end
+        nil
+      end
+
+      protected
+
+      def slot_offset(slot)
+        raise IndexError, "Slot #{slot} outside of 0...#{@size}" if slot < 0 or slot >= @size
+
+        slot * SLOT_SIZE
+      end
+
+      def parse_json(json)
+        hash = JSON.parse(json)
+        raise ArgumentError, "Invalid JSON object" unless hash.is_a?(Hash)
+
+        hash
+      rescue JSON::ParserError
+        raise ArgumentError, "Invalid JSON object"
+      end
+
+      def check_key_count(keys, keys_per_slot)
+        if keys.length != @size * keys_per_slot
+          raise ArgumentError, "Expected #{@size * keys_per_slot} keys but got #{keys.length}"
+        end
+      end
+
+      def extreme(slot, index)
+        offset = slot_offset(slot)
+        return nil if @stats[offset + COUNT_INDEX] == 0
+
+        value = @stats[offset + index]
+        return value.to_i if @stats[offset + INTEGER_INDEX] == 1
+
+        value
+      end
+    end
+  end
+end
@@ -21,6 +21,7 @@ require 'fileutils'
 require 'tmpdir'
 require 'cosmos'
 require 'cosmos/utilities/s3'
+require 'cosmos/logs/packet_log_reader'
 
 class S3File
   attr_reader :s3_path
@@ -174,6 +175,8 @@ class S3FileCache
     end
 
     @cached_files = S3FileCollection.new
+    @summaries = {}
+    @summary_mutex = Mutex.new
 
     @thread = Thread.new do
       while true
@@ -194,7 +197,15 @@ class S3FileCache
     end
   end
 
-  def reserve_file(cmd_or_tlm, target_name, packet_name, start_time_nsec, end_time_nsec, type = :DECOM, timeout = 60, scope:)
+  # @param item_name [String|nil] Only reserve files whose index summary
+  #   shows the item may have a value between min_value and max_value.
+  #   Files without a summary of the item are always reserved. RAW logs
+  #   summarize RAW values and DECOM logs summarize their JSON keys so use
+  #   names like TEMP1__C for converted values.
+  # @param min_value [Numeric|nil] Minimum item value of interest
+  # @param max_value [Numeric|nil] Maximum item value of interest
+  def reserve_file(cmd_or_tlm, target_name, packet_name, start_time_nsec, end_time_nsec, type = :DECOM, timeout = 60, scope:,
+                   item_name: nil, min_value: nil, max_value: nil)
     # Cosmos::Logger.debug "reserve_file #{cmd_or_tlm}:#{target_name}:#{packet_name} start:#{start_time_nsec / 1_000_000_000} end:#{end_time_nsec / 1_000_000_000} type:#{type} timeout:#{timeout}"
     # Get List of Files from S3
     total_resp = []
@@ -228,6 +239,10 @@ class S3FileCache
     total_resp.each_with_index do |item, index|
       s3_path = item.key
       if file_in_time_range(s3_path, start_time_nsec, end_time_nsec)
+        if item_name and File.extname(s3_path) != '.idx'
+          summary = file_summary(s3_path)
+          next if summary and !summary_in_range?(summary, cmd_or_tlm, target_name, packet_name, start_time_nsec, end_time_nsec, item_name, min_value, max_value)
+        end
         file = @cached_files.add(s3_path, item.size, index)
         files << file
       end
@@ -258,6 +273,51 @@ class S3FileCache
     end
   end
 
+  # Read the summary of a log file from the footer of its index file. Only
+  # the footer is requested from S3 so neither file is downloaded. Summaries
+  # are cached since log files never change once they are in S3.
+  #
+  # @param s3_path [String] S3 path of the log file
+  # @return [Hash|nil] See PacketLogReader.parse_summary. nil if the log
+  #   has no index or the index has no summary.
+  def file_summary(s3_path)
+    @summary_mutex.synchronize do
+      return @summaries[s3_path] if @summaries.key?(s3_path)
+    end
+
+    index_path = s3_path.sub(/\.bin(\.gz)?\z/, '.idx')
+    summary = nil
+    begin
+      footer_length = @rubys3_client.get_object(bucket: 'logs', key: index_path, range: 'bytes=-4').body.read.unpack('N')[0]
+      footer = @rubys3_client.get_object(bucket: 'logs', key: index_path, range: "bytes=-#{footer_length}").body.read
+      summary = Cosmos::PacketLogReader.parse_summary(footer)
+    rescue => err
+      Cosmos::Logger.debug "No summary for #{s3_path}: #{err.message}"
+    end
+    @summary_mutex.synchronize do
+      @summaries[s3_path] = summary
+    end
+    summary
+  end
+
+  # @return [Boolean] Whether a summary shows the packet may have an item
+  #   value in the range during the time range
+  def summary_in_range?(summary, cmd_or_tlm, target_name, packet_name, start_time_nsec, end_time_nsec, item_name = nil, min_value = nil, max_value = nil)
+    summary['packets'].each do |packet|
+      next unless packet['cmd_or_tlm'] == cmd_or_tlm.to_s and packet['target_name'] == target_name and packet['packet_name'] == packet_name
+      next if packet['max_time'] < start_time_nsec or packet['min_time'] > end_time_nsec
+      return true unless item_name and packet['items']
+
+      range = packet['items'][item_name]
+      return true unless range
+      return false if min_value and range[1] < min_value
+      return false if max_value and range[0] > max_value
+
+      return true
+    end
+    return false
+  end
+
   # private
 
   def file_in_time_range(s3_path, start_time_nsec, end_time_nsec)
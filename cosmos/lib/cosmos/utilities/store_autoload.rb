@@ -199,6 +199,26 @@ module Cosmos
       end
     end
 
+    # Add several entries to redis streams with a single round trip.
+    #
+    # @example
+    #   store.write_topics([['MANGO__TOPIC', {'message' => 'one'}], ['MANGO__TOPIC', {'message' => 'two'}]])
+    #
+    # @param entries [Array<Array(String, Hash)>] topic and msg_hash of each entry in order
+    # @param maxlen [Integer] max length of entries, default value is `nil`, it means will grow forever
+    # @param approximate [Boolean] whether to add `~` modifier of maxlen or not
+    #
+    # @return [Array<String>] the entry ids
+    def write_topics(entries, maxlen = nil, approximate = true)
+      @redis_pool.with do |redis|
+        return redis.pipelined do |pipeline|
+          entries.each do |topic, msg_hash|
+            pipeline.xadd(topic, msg_hash, id: '*', maxlen: maxlen, approximate: approximate)
+          end
+        end
+      end
+    end
+
     # Trims older entries of the redis stream if needed.
     # > https://www.rubydoc.info/github/redis/redis-rb/Redis:xtrim
     #
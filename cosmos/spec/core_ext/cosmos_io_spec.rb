@@ -82,4 +82,32 @@ describe StringIO do
       expect(io.read_length_bytes(4)).to eql "\x01\x02\x03"
     end
   end
+
+  describe "read_length_fields", no_ext: true do
+    it "complains about unsupported length fields" do
+      expect { CosmosIO.read_length_fields("\x01\x01\x01", 0, 3) }.to raise_error(ArgumentError, /Unsupported/)
+      expect { CosmosIO.read_length_fields("\x01\x01", 3, 1) }.to raise_error(IndexError)
+    end
+
+    it "returns the offset and length of each complete field" do
+      data = "\xAA\x02\x01\x02\x00\x01\x03\x05"
+      expect(CosmosIO.read_length_fields(data, 1, 1)).to eql [2, 2, 5, 0, 6, 1]
+      expect(CosmosIO.read_length_fields(data, 1, 1, 2)).to eql [2, 2, 5, 0]
+      expect(CosmosIO.read_length_fields("\x03\x01\x02", 0, 1)).to eql []
+    end
+
+    it "reads big and little endian length fields" do
+      expect(CosmosIO.read_length_fields("\x00\x02\x01\x02", 0, 2)).to eql [2, 2]
+      expect(CosmosIO.read_length_fields("\x02\x00\x01\x02", 0, 2, nil, :LITTLE_ENDIAN)).to eql [2, 2]
+      expect(CosmosIO.read_length_fields("\x00\x00\x00\x01\x01", 0, 4)).to eql [4, 1]
+      expect(CosmosIO.read_length_fields("\x01\x00\x00\x00\x01", 0, 4, nil, :LITTLE_ENDIAN)).to eql [4, 1]
+      expect(CosmosIO.read_length_fields("\x00\x00\x00\x00\x00\x00\x00\x01\x01", 0, 8)).to eql [8, 1]
+      expect(CosmosIO.read_length_fields("\x01\x00\x00\x00\x00\x00\x00\x00\x01", 0, 8, nil, :LITTLE_ENDIAN)).to eql [8, 1]
+      expect(CosmosIO.read_length_fields("\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x01", 0, 8)).to eql []
+    end
+
+    it "complains if a length is larger than max_length" do
+      expect { CosmosIO.read_length_fields("\x00\x00\x00\x05", 0, 4, nil, :BIG_ENDIAN, 4) }.to raise_error(/larger than max_length: 5 > 4/)
+    end
+  end
 end
@@ -57,7 +57,7 @@ module Cosmos
         @interface.add_protocol(BurstProtocol, [1, '0xDEADBEEF', true], :READ_WRITE)
         @interface.read_protocols[0].instance_variable_set(:@data, '\x00\x01\x02\x03')
         @interface.connect
-        expect(@interface.read_protocols[0].instance_variable_get(:@data)).to eql ''
+        expect(@interface.read_protocols[0].instance_variable_get(:@data)).to eq ''
       end
     end
 
@@ -66,7 +66,7 @@ module Cosmos
         @interface.add_protocol(BurstProtocol, [1, '0xDEADBEEF', true], :READ_WRITE)
         @interface.read_protocols[0].instance_variable_set(:@data, '\x00\x01\x02\x03')
         @interface.connect
-        expect(@interface.read_protocols[0].instance_variable_get(:@data)).to eql ''
+        expect(@interface.read_protocols[0].instance_variable_get(:@data)).to eq ''
       end
     end
 
@@ -180,6 +180,18 @@ module Cosmos
         expect(pkt.length).to eql 3 # sync plus one byte
       end
 
+      it "logs a single discard for several false positive sync patterns" do
+        messages = []
+        allow(Logger).to receive(:error) { |msg| messages << msg }
+        @interface.add_protocol(BurstProtocol, [0, '0x1234'], :READ_WRITE)
+        protocol = @interface.read_protocols[0]
+        expect(protocol.read_data("\x12\x00\x12\x12\x00\x12")).to eql :STOP
+        expect(protocol.read_data("\x34\x56")).to eql "\x12\x34\x56"
+        discards = messages.grep(/Discarding/)
+        expect(discards.length).to eql 1
+        expect(discards[0]).to match(/Sync not found. Discarding 5 bytes of data./)
+      end
+
       it "handle auto allow_empty_data correctly" do
         @interface.add_protocol(BurstProtocol, [0, nil, false, nil], :READ_WRITE)
         expect(@interface.read_protocols[0].read_data("")).to eql :STOP
@@ -199,6 +211,23 @@ module Cosmos
       end
     end
 
+    describe "find_sync", no_ext: true do
+      it "finds the first full sync pattern" do
+        expect(BurstProtocol.find_sync("\x00\x12\x00\x12\x34\x12\x34", "\x12\x34")).to eql 3
+        expect(BurstProtocol.find_sync("\x00\x12\x00\x12\x34\x12\x34", "\x12\x34", 4)).to eql 5
+      end
+
+      it "finds a partial sync pattern at the end of the data" do
+        expect(BurstProtocol.find_sync("\x12\x00\x12\x34", "\x12\x34\x56")).to eql 2
+        expect(BurstProtocol.find_sync("\x12\x34", "\x12\x34\x56")).to eql 0
+      end
+
+      it "returns the data length if there is no sync pattern" do
+        expect(BurstProtocol.find_sync("\x12\x00\x12\x35", "\x12\x34")).to eql 4
+        expect(BurstProtocol.find_sync("", "\x12\x34")).to eql 0
+      end
+    end
+
     describe "write" do
       it "doesn't change the data if fill_fields is false" do
         $data = ''
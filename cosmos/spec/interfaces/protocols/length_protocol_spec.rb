@@ -304,6 +304,35 @@ module Cosmos
       end
     end
 
+    describe "find_frames", no_ext: true do
+      it "frames every complete packet" do
+        protocol = LengthProtocol.new(16, 16, 4, 1, 'LITTLE_ENDIAN', 0, 'DEAD')
+        data = "\x00\xDE\xAD\x00\x00\xDE\xAD\x02\x00\x01\x02\xDE\xAD\x05\x00"
+        expect(protocol.find_frames(data, 1)).to eql [4, 6]
+        expect(protocol.find_frames(data, 5)).to eql [6]
+        expect(protocol.find_frames(data, 0)).to eql []
+      end
+
+      it "stops at lengths larger than max_length" do
+        protocol = LengthProtocol.new(8, 8, 0, 1, 'BIG_ENDIAN', 0, nil, 3)
+        expect(protocol.find_frames("\x00\x02\x00\x03\x00\x04\x00\x00")).to eql [2, 3]
+      end
+
+      it "only frames byte aligned length fields" do
+        protocol = LengthProtocol.new(4, 8)
+        expect(protocol.find_frames("\x00\x20\x00\x20")).to eql []
+      end
+
+      it "reads every framed packet before more data" do
+        @interface.add_protocol(LengthProtocol, [0, 8], :READ_WRITE)
+        protocol = @interface.read_protocols[0]
+        expect(protocol.read_data("\x02\x01\x03\x01\x02\x02")).to eql "\x02\x01"
+        expect(protocol.read_data("\x01")).to eql "\x03\x01\x02"
+        expect(protocol.read_data("")).to eql "\x02\x01"
+        expect(protocol.read_data("")).to eql :STOP
+      end
+    end
+
     describe "write" do
       it "sends data directly to the stream if no fill" do
         @interface.instance_variable_set(:@stream, LengthStream.new)
@@ -147,6 +147,22 @@ module Cosmos
       end
     end
 
+    describe "find_frames", no_ext: true do
+      it "frames every complete packet" do
+        protocol = TerminatedProtocol.new('', '0xABCD', true, 0, '0x12')
+        data = "\x00\x12\xAB\xCD\x12\x01\xAB\xAB\xCD\x12\xAB"
+        expect(protocol.find_frames(data, 1)).to eql [3, 5]
+        expect(protocol.find_frames(data, 0)).to eql []
+        expect(protocol.find_frames(data, 9)).to eql []
+      end
+
+      it "skips data already searched" do
+        protocol = TerminatedProtocol.new('', '0xABCD')
+        expect(protocol.find_frames("\xAB\xCD\x01\xAB\xCD", 0, 1)).to eql [5]
+        expect(protocol.find_frames("\xAB\xCD\x01\xAB\xCD", 0, 4)).to eql []
+      end
+    end
+
     describe "write" do
       it "appends termination characters to the packet" do
         @interface.instance_variable_set(:@stream, TerminatedStream.new)
@@ -143,6 +143,23 @@ module Cosmos
         Cosmos.close_socket(write)
       end
 
+      it "reads a batch of datagrams" do
+        write = UdpWriteSocket.new('localhost', 8889)
+        i = UdpInterface.new('localhost', 'nil', '8889')
+        i.set_option('READ_BATCH_SIZE', ['4'])
+        i.connect
+        write.write("\x00\x01")
+        write.write("\x02\x03")
+        write.write("\x04\x05")
+        sleep 0.1
+        packets = i.read_batch
+        expect(packets.map { |packet| packet.buffer }).to eql ["\x00\x01", "\x02\x03", "\x04\x05"]
+        expect(i.read_count).to eql 3
+        expect(i.bytes_read).to eql 6
+        i.disconnect
+        Cosmos.close_socket(write)
+      end
+
       xit "logs the raw data" do
         write = UdpWriteSocket.new('localhost', 8889)
         i = UdpInterface.new('localhost', 'nil', '8889')
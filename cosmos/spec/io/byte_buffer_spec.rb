@@ -0,0 +1,133 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require 'spec_helper'
+require 'cosmos/io/byte_buffer'
+
+module Cosmos
+  describe ByteBuffer, no_ext: true do
+    before(:each) do
+      @buffer = ByteBuffer.new
+      @buffer << "\x01\x02\x03\x04"
+      @buffer << "\x05\x06"
+    end
+
+    describe "<<" do
+      it "appends data after the unread bytes" do
+        @buffer.consume(5)
+        @buffer << "\x07\x08"
+        expect(@buffer.length).to eql 3
+        expect(@buffer.to_s).to eql "\x06\x07\x08"
+        expect(@buffer.read_index).to eql 0
+      end
+    end
+
+    describe "peek" do
+      it "returns the byte at an offset" do
+        @buffer.consume(1)
+        expect(@buffer.peek(0)).to eql 2
+        expect(@buffer.peek(4)).to eql 6
+        expect(@buffer.peek(5)).to be_nil
+      end
+    end
+
+    describe "find" do
+      it "returns the offset of a pattern" do
+        @buffer << "\x03\x04"
+        @buffer.consume(1)
+        expect(@buffer.find("\x03\x04")).to eql 1
+        expect(@buffer.find("\x03\x04", 2)).to eql 5
+        expect(@buffer.find("\x04\x03")).to be_nil
+      end
+    end
+
+    describe "consume" do
+      it "discards bytes from the front" do
+        @buffer.consume(2)
+        expect(@buffer.length).to eql 4
+        expect(@buffer.to_s).to eql "\x03\x04\x05\x06"
+        @buffer.consume(4)
+        expect(@buffer.empty?).to be true
+        expect(@buffer.buffer.length).to eql 0
+      end
+
+      it "complains about consuming too many bytes" do
+        expect { @buffer.consume(7) }.to raise_error(IndexError)
+      end
+    end
+
+    describe "slice" do
+      it "copies bytes without consuming them" do
+        @buffer.consume(1)
+        expect(@buffer.slice(1, 2)).to eql "\x03\x04"
+        expect(@buffer.slice(3)).to eql "\x05\x06"
+        expect(@buffer.length).to eql 5
+        expect { @buffer.slice(4, 2) }.to raise_error(IndexError)
+      end
+    end
+
+    describe "take" do
+      it "copies and consumes bytes" do
+        expect(@buffer.take(3)).to eql "\x01\x02\x03"
+        expect(@buffer.take(3)).to eql "\x04\x05\x06"
+        expect(@buffer.length).to eql 0
+      end
+    end
+
+    describe "String compatibility" do
+      it "compares with Strings" do
+        @buffer.consume(4)
+        expect(@buffer).to eq "\x05\x06"
+        expect(@buffer == "\x01").to be false
+        @buffer.consume(2)
+        expect(@buffer).to eq ''
+      end
+
+      it "is only eql? to other ByteBuffers" do
+        @buffer.consume(4)
+        other = ByteBuffer.new("\x05\x06")
+        expect(@buffer).to eql other
+        expect(@buffer.hash).to eql other.hash
+        expect(@buffer.eql?("\x05\x06")).to be false
+        expect("\x05\x06".eql?(@buffer)).to be false
+        expect({ other => 1 }[@buffer]).to eql 1
+        expect({ "\x05\x06" => 1 }[@buffer]).to be_nil
+      end
+
+      it "indexes and searches the unread bytes" do
+        @buffer.consume(1)
+        expect(@buffer[0]).to eql "\x02"
+        expect(@buffer[1, 2]).to eql "\x03\x04"
+        expect(@buffer[3..-1]).to eql "\x05\x06"
+        expect(@buffer.index("\x04")).to eql 2
+        expect(@buffer.index(/\x05/)).to eql 3
+      end
+
+      it "replaces and removes the unread bytes" do
+        @buffer.consume(1)
+        expect(@buffer.slice!(0, 2)).to eql "\x02\x03"
+        expect(@buffer.slice!(1, 1)).to eql "\x05"
+        expect(@buffer.to_s).to eql "\x04\x06"
+        @buffer.replace("\x07")
+        expect(@buffer.to_s).to eql "\x07"
+        expect(@buffer.read_index).to eql 0
+      end
+    end
+  end
+end
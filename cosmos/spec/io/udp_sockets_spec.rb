@@ -129,6 +129,27 @@ module Cosmos
       end
     end
 
+    describe "read_batch", no_ext: true do
+      it "reads every waiting datagram" do
+        udp_read  = UdpReadWriteSocket.new(8888)
+        udp_write = UdpWriteSocket.new('127.0.0.1', 8888)
+        udp_write.write("\x01\x02", 2.0)
+        udp_write.write("\x03", 2.0)
+        udp_write.write("\x04\x05\x06", 2.0)
+        sleep 0.1
+        expect(udp_read.read_batch(2)).to eql ["\x01\x02", "\x03"]
+        expect(udp_read.read_batch(2)).to eql ["\x04\x05\x06"]
+        udp_read.close
+        udp_write.close
+      end
+
+      it "handles timeouts" do
+        udp_read = UdpReadWriteSocket.new(8889)
+        expect { udp_read.read_batch(2, 0.1) }.to raise_error(Timeout::Error)
+        udp_read.close
+      end
+    end
+
     describe "write" do
       it "writes data" do
         udp_read  = UdpReadSocket.new(8888)
@@ -316,4 +316,60 @@ module Cosmos
       end
     end
   end
+
+  describe InterfacePipeline do
+    before(:each) do
+      @interface = Interface.new
+      @interface.name = "TEST_INT"
+      @tlm = double("InterfaceMicroservice")
+      allow(@tlm).to receive(:identify_packet) do |packet|
+        packet.target_name = "INST"
+        packet.packet_name = "HEALTH_STATUS"
+        packet.received_time = Time.now.sys unless packet.received_time
+        packet
+      end
+      @entries = []
+      allow(TelemetryTopic).to receive(:write_entries) { |entries| @entries.concat(entries) }
+      allow(InterfaceStatusModel).to receive(:set)
+      @metric = Metric.new(microservice: "DEFAULT__INTERFACE__TEST_INT", scope: "DEFAULT")
+    end
+
+    it "publishes every packet in order" do
+      pipeline = InterfacePipeline.new(@interface, @tlm, @metric, queue_size: 5, scope: "DEFAULT")
+      pipeline.start
+      50.times { |index| expect(pipeline.push(Packet.new(nil, nil, :BIG_ENDIAN, nil, [index].pack('N')))).to be true }
+      pipeline.stop
+      expect(@entries.length).to eql 50
+      expect(@entries[0][0]).to eql "DEFAULT__TELEMETRY__{INST}__HEALTH_STATUS"
+      expect(@entries.map { |_, msg_hash| msg_hash[:buffer].unpack('N')[0] }).to eql (0...50).to_a
+      histograms = @metric.histograms
+      expect(histograms["interface_pipeline_latency_seconds|stage=decode"].count).to eql 50
+      expect(histograms["interface_pipeline_latency_seconds|stage=publish"].count).to eql 50
+      expect(@metric.items.keys).to include("interface_pipeline_queue_depth|stage=decode")
+    end
+
+    it "sets the received time when the packet is read" do
+      pipeline = InterfacePipeline.new(@interface, @tlm, @metric, queue_size: 5, scope: "DEFAULT")
+      read_time = Time.now.sys
+      pipeline.push(Packet.new(nil, nil, :BIG_ENDIAN, nil, "\x00"))
+      # Wait in the decode queue before decoding starts
+      sleep 0.5
+      pipeline.start
+      pipeline.stop
+      expect(@entries.length).to eql 1
+      received_time = Time.from_nsec_from_epoch(@entries[0][1][:time])
+      expect(received_time).to be_within(0.25).of(read_time)
+    end
+
+    it "counts dropped packets" do
+      pipeline = InterfacePipeline.new(@interface, @tlm, @metric, queue_size: 2, drop: true, scope: "DEFAULT")
+      # Packets can't be dropped until the decode queue fills up
+      results = Array.new(10) { pipeline.push(Packet.new(nil, nil, :BIG_ENDIAN, nil, "\x00")) }
+      expect(results.count(false)).to eql 8
+      expect(pipeline.dropped_count).to eql 8
+      pipeline.start
+      pipeline.stop
+      expect(@entries.length).to eql 2
+    end
+  end
 end
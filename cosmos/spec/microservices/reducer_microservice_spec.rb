@@ -355,5 +355,91 @@ module Cosmos
         expect(index).to eql 49 # Check that we got 2 packets
       end
     end
+
+    describe "cascade" do
+      before(:each) do
+        model = MicroserviceModel.new(name: "DEFAULT__REDUCER__INST", options: [["CASCADE", "TRUE"]], scope: "DEFAULT")
+        model.create
+        @reducer = ReducerMicroservice.new("DEFAULT__REDUCER__INST")
+      end
+
+      it "reduces decom data to minutes, hours and days in one pass" do
+        start_time = Time.at(1640995200) # 2022/01/01 00:00:00 GMT
+        setup_logfile(start_time: start_time, num_pkts: 26, time_delta: 3600)
+        @reducer.reduce_minute
+        @reducer.shutdown
+        sleep 0.1
+
+        expect(ReducerModel.all_files(type: :DECOM, target: "INST", scope: "DEFAULT")).to be_empty
+        # Minute and hour reductions are never read back
+        expect(ReducerModel.all_files(type: :MINUTE, target: "INST", scope: "DEFAULT")).to_not be_empty
+        @reducer.reduce_hour
+        expect(ReducerModel.all_files(type: :MINUTE, target: "INST", scope: "DEFAULT")).to be_empty
+        # The second day is still being reduced
+        expect(@day_files.length).to eql 1
+
+        count = 0
+        plr = PacketLogReader.new
+        plr.each(@day_files[0]) do |pkt|
+          expect(pkt.read("COLLECTS_SAMPLES")).to eql(24)
+          expect(pkt.read("COLLECTS_MIN")).to eql(1)
+          expect(pkt.read("COLLECTS_MAX")).to eql(24)
+          expect(pkt.read("COLLECTS_AVG")).to eql(12.5)
+          count += 1
+        end
+        expect(count).to eql 1
+      end
+
+      it "saves a checkpoint after each file" do
+        start_time = Time.at(1640995200) # 2022/01/01 00:00:00 GMT
+        setup_logfile(start_time: start_time, num_pkts: 90, time_delta: 1)
+        decom_file = @decom_files[0]
+        @reducer.reduce_minute
+
+        checkpoint = ReducerModel.get_checkpoint(packet: "HEALTH_STATUS", target: "INST", scope: "DEFAULT")
+        expect(checkpoint['last_file']).to eql(decom_file)
+        # The minute tier has 30 samples left in the current entry
+        minute = ReducerAccumulator.new(checkpoint['plan'].length)
+        minute.load(checkpoint['tiers'][0]['stats'])
+        slot = checkpoint['plan'].index { |names| names[0] == "COLLECTS" }
+        expect(minute.samples(slot)).to eql 30
+        expect(minute.min(slot)).to eql 61
+        @reducer.shutdown
+      end
+
+      it "reduces stored packets older than the checkpoint" do
+        start_time = Time.at(1640995200) # 2022/01/01 00:00:00 GMT
+        setup_logfile(start_time: start_time, num_pkts: 90, time_delta: 1)
+        @reducer.reduce_minute
+        # A stored packet from the first minute arrives in a later file
+        setup_logfile(start_time: start_time + 10, num_pkts: 1, time_delta: 1)
+        @reducer.reduce_minute
+
+        checkpoint = ReducerModel.get_checkpoint(packet: "HEALTH_STATUS", target: "INST", scope: "DEFAULT")
+        minute = ReducerAccumulator.new(checkpoint['plan'].length)
+        minute.load(checkpoint['tiers'][0]['stats'])
+        slot = checkpoint['plan'].index { |names| names[0] == "COLLECTS" }
+        expect(minute.samples(slot)).to eql 1
+        expect(minute.min(slot)).to eql 1
+        expect(checkpoint['tiers'][0]['entry_time']).to eql((start_time + 10).to_f)
+        @reducer.shutdown
+      end
+
+      it "skips a file which was reduced before the checkpoint" do
+        start_time = Time.at(1640995200) # 2022/01/01 00:00:00 GMT
+        setup_logfile(start_time: start_time, num_pkts: 90, time_delta: 1)
+        decom_file = @decom_files[0]
+        @reducer.reduce_minute
+        # Reducing the file again is a no-op
+        expect(@reducer.cascade_file(decom_file)).to be true
+
+        checkpoint = ReducerModel.get_checkpoint(packet: "HEALTH_STATUS", target: "INST", scope: "DEFAULT")
+        minute = ReducerAccumulator.new(checkpoint['plan'].length)
+        minute.load(checkpoint['tiers'][0]['stats'])
+        slot = checkpoint['plan'].index { |names| names[0] == "COLLECTS" }
+        expect(minute.samples(slot)).to eql 30
+        @reducer.shutdown
+      end
+    end
   end
 end
@@ -127,6 +127,50 @@ module Cosmos
       end
     end
 
+    describe "cache" do
+      after(:each) do
+        CvtModel.cache_timeout = 0
+        CvtModel.clear_cache
+      end
+
+      it "fetches from the CVT every time when disabled" do
+        update_temp1()
+        expect(CvtModel.get_tlm_values(["INST__HEALTH_STATUS__TEMP1__RAW"], scope: "DEFAULT")).to eql [[1, nil]]
+        hash = JSON.parse(Store.hget("DEFAULT__tlm__INST", "HEALTH_STATUS"))
+        hash["TEMP1"] = 5
+        Store.hset("DEFAULT__tlm__INST", "HEALTH_STATUS", JSON.generate(hash))
+        expect(CvtModel.get_tlm_values(["INST__HEALTH_STATUS__TEMP1__RAW"], scope: "DEFAULT")).to eql [[5, nil]]
+      end
+
+      it "reuses the parsed packet until it is stale" do
+        CvtModel.cache_timeout = 10
+        update_temp1()
+        expect(CvtModel.get_tlm_values(["INST__HEALTH_STATUS__TEMP1__RAW"], scope: "DEFAULT")).to eql [[1, nil]]
+        # Change the CVT behind the cache's back
+        hash = JSON.parse(Store.hget("DEFAULT__tlm__INST", "HEALTH_STATUS"))
+        hash["TEMP1"] = 5
+        Store.hset("DEFAULT__tlm__INST", "HEALTH_STATUS", JSON.generate(hash))
+        expect(CvtModel.get_tlm_values(["INST__HEALTH_STATUS__TEMP1__RAW"], scope: "DEFAULT")).to eql [[1, nil]]
+        expect(CvtModel.get_item("INST", "HEALTH_STATUS", "TEMP1", type: :RAW, scope: "DEFAULT")).to eql 1
+
+        CvtModel.cache_timeout = 0.001
+        sleep 0.01
+        expect(CvtModel.get_tlm_values(["INST__HEALTH_STATUS__TEMP1__RAW"], scope: "DEFAULT")).to eql [[5, nil]]
+      end
+
+      it "invalidates when the CVT is updated in process" do
+        CvtModel.cache_timeout = 10
+        update_temp1()
+        expect(CvtModel.get_item("INST", "HEALTH_STATUS", "TEMP1", type: :RAW, scope: "DEFAULT")).to eql 1
+        CvtModel.set_item("INST", "HEALTH_STATUS", "TEMP1", 0, type: :RAW, scope: "DEFAULT")
+        expect(CvtModel.get_item("INST", "HEALTH_STATUS", "TEMP1", type: :RAW, scope: "DEFAULT")).to eql 0
+        update_temp1()
+        check_temp1()
+        CvtModel.del(target_name: "INST", packet_name: "HEALTH_STATUS", scope: "DEFAULT")
+        expect { CvtModel.get_tlm_values(["INST__HEALTH_STATUS__TEMP1__RAW"], scope: "DEFAULT") }.to raise_error(/does not exist/)
+      end
+    end
+
     describe "override" do
       it "raises for an unknown type" do
         expect { CvtModel.override("INST", "HEALTH_STATUS", "TEMP1", 0, type: :OTHER, scope: "DEFAULT") }.to raise_error(/Unknown type 'OTHER'/)
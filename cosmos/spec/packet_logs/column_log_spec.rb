@@ -0,0 +1,150 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require 'spec_helper'
+require 'tempfile'
+require 'cosmos/logs/packet_log_writer'
+require 'cosmos/logs/column_log_writer'
+require 'cosmos/logs/column_log_reader'
+
+module Cosmos
+  describe ColumnLogWriter, no_ext: true do
+    before(:all) do
+      setup_system()
+      @log_path = File.expand_path(File.join(SPEC_DIR, 'install', 'outputs', 'logs'))
+    end
+
+    before(:each) do
+      allow(File).to receive(:delete).and_return(nil)
+      s3 = double("Aws::S3::Client").as_null_object
+      allow(Aws::S3::Client).to receive(:new).and_return(s3)
+      plw = PacketLogWriter.new(@log_path, 'spec')
+      @pkt = System.telemetry.packet("INST", "HEALTH_STATUS")
+      @times = []
+      @collects = []
+      @temps = []
+      time = Time.now.to_nsec_from_epoch
+      10.times do |i|
+        @pkt.write("COLLECTS", i * 10)
+        @pkt.write("TEMP1", i * 1000, :RAW)
+        @times << time + (i * Time::NSEC_PER_SECOND)
+        @collects << i * 10
+        @temps << i * 1000
+        plw.write(:RAW_PACKET, :TLM, 'INST', 'HEALTH_STATUS', @times[-1], true, @pkt.buffer, nil, '0-0')
+        plw.write(:RAW_PACKET, :TLM, 'INST', 'ADCS', @times[-1], true, "\x00" * 8, nil, '0-0')
+      end
+      @logfile = plw.filename
+      plw.shutdown
+      sleep 0.1
+      @column_file = Tempfile.new('column')
+      @column_file.close
+    end
+
+    after(:each) do
+      @column_file.unlink
+    end
+
+    describe "column_type" do
+      it "uses the smallest standard type which holds the item" do
+        expect(ColumnLogWriter.column_type(@pkt.get_item("CCSDSVER"))).to eql "UINT8"
+        expect(ColumnLogWriter.column_type(@pkt.get_item("CCSDSSEQCNT"))).to eql "UINT16"
+        expect(ColumnLogWriter.column_type(@pkt.get_item("TIMESEC"))).to eql "UINT32"
+      end
+
+      it "does not export arrays, strings or derived items" do
+        expect(ColumnLogWriter.column_type(@pkt.get_item("ARY"))).to be_nil
+        expect(ColumnLogWriter.column_type(@pkt.get_item("RECEIVED_TIMESECONDS"))).to be_nil
+      end
+    end
+
+    describe "convert" do
+      it "exports only the requested packet" do
+        expect(ColumnLogWriter.convert(@logfile, @column_file.path, 'INST', 'HEALTH_STATUS', %w(COLLECTS TEMP1))).to eql 10
+        reader = ColumnLogReader.new(@column_file.path)
+        expect(reader.target_name).to eql 'INST'
+        expect(reader.packet_name).to eql 'HEALTH_STATUS'
+        expect(reader.count).to eql 10
+        expect(reader.column_names).to eql %w(COLLECTS TEMP1)
+        expect(reader.column_type('COLLECTS')).to eql 'UINT16'
+      end
+
+      it "exports every supported item by default" do
+        ColumnLogWriter.convert(@logfile, @column_file.path, 'INST', 'HEALTH_STATUS')
+        reader = ColumnLogReader.new(@column_file.path)
+        expect(reader.column_names).to include('COLLECTS', 'TEMP1', 'TIMESEC')
+        expect(reader.column_names).to_not include('ARY', 'RECEIVED_TIMESECONDS')
+      end
+
+      it "marks the values of packets too short to hold an item as missing" do
+        capture_io do |stdout|
+          # The ADCS packets are only 8 bytes
+          ColumnLogWriter.convert(@logfile, @column_file.path, 'INST', 'ADCS', %w(CCSDSLENGTH TIMESEC POSX))
+          # One warning for the whole log rather than one per packet
+          expect(stdout.string).to match(/INST ADCS 10 of 10 packets are too short to hold TIMESEC \(10\), POSX \(10\)/)
+          expect(stdout.string.scan(/too short/).length).to eql 1
+        end
+        reader = ColumnLogReader.new(@column_file.path)
+        expect(reader.read_column('CCSDSLENGTH')).to eql [0] * 10
+        expect(reader.read_column('TIMESEC')).to eql [nil] * 10
+        expect(reader.read_column('POSX', 9)).to eql [nil]
+        # Float columns hold NaN for the missing values
+        offset = reader.instance_variable_get(:@data_offset) + reader.instance_variable_get(:@columns)['POSX']['offset']
+        posx = reader.read_values(offset, 'FLOAT32', 1)
+        expect(posx[0].nan?).to be true
+      end
+
+      it "complains about items which can not be exported" do
+        expect { ColumnLogWriter.convert(@logfile, @column_file.path, 'INST', 'HEALTH_STATUS', %w(ARY)) }.to raise_error(/can not be exported/)
+      end
+    end
+
+    describe ColumnLogReader do
+      before(:each) do
+        ColumnLogWriter.convert(@logfile, @column_file.path, 'INST', 'HEALTH_STATUS', %w(COLLECTS TEMP1))
+        @reader = ColumnLogReader.new(@column_file.path)
+      end
+
+      it "reads raw column values and times" do
+        expect(@reader.read_times).to eql @times
+        expect(@reader.read_column('COLLECTS')).to eql @collects
+        expect(@reader.read_column('TEMP1')).to eql @temps
+      end
+
+      it "reads part of a column" do
+        expect(@reader.read_column('COLLECTS', 2, 3)).to eql @collects[2, 3]
+        expect(@reader.read_column('COLLECTS', 8, 100)).to eql @collects[8, 2]
+        expect(@reader.read_column('COLLECTS', 10)).to eql []
+      end
+
+      it "finds the rows within a time range" do
+        expect(@reader.time_range(@times[2], @times[5])).to eql [2, 4]
+        expect(@reader.time_range(@times[2] + 1, nil)).to eql [3, 7]
+        expect(@reader.time_range(nil, @times[0] - 1)).to eql [0, 0]
+      end
+
+      it "complains about unknown columns" do
+        expect { @reader.read_column('BLAH') }.to raise_error("Column BLAH not found")
+      end
+
+      it "complains about files which are not columnar" do
+        expect { ColumnLogReader.new(@logfile) }.to raise_error(/header not found/)
+      end
+    end
+  end
+end
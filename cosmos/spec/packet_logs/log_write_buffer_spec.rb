@@ -0,0 +1,99 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require 'spec_helper'
+require 'tempfile'
+require 'cosmos/logs/log_write_buffer'
+
+module Cosmos
+  describe LogWriteBuffer, no_ext: true do
+    before(:each) do
+      @file = Tempfile.new('log')
+      @index_file = Tempfile.new('idx')
+      @buffer = LogWriteBuffer.new(@file, @index_file, 16)
+    end
+
+    after(:each) do
+      @file.close!
+      @index_file.close!
+    end
+
+    describe "write" do
+      it "buffers until the flush size is reached" do
+        @buffer.write("\x01\x02\x03\x04", "\x05")
+        @buffer.write("\x06\x07\x08\x09", "\x0A")
+        expect(@buffer.buffered).to eql 10
+        expect(File.size(@file.path)).to eql 0
+        expect(File.size(@index_file.path)).to eql 0
+
+        @buffer.write("\x0B" * 8, "\x0C")
+        expect(@buffer.buffered).to eql 0
+        expect(File.binread(@file.path)).to eql "\x01\x02\x03\x04\x06\x07\x08\x09" + ("\x0B" * 8)
+        expect(File.binread(@index_file.path)).to eql "\x05\x0A\x0C"
+      end
+
+      it "writes entries larger than the flush size" do
+        @buffer.write("\x01")
+        @buffer.write("\x02" * 100)
+        expect(File.binread(@file.path)).to eql "\x01" + ("\x02" * 100)
+      end
+
+      it "complains about index data without an index file" do
+        buffer = LogWriteBuffer.new(@file)
+        expect { buffer.write("\x01", "\x02") }.to raise_error(ArgumentError, /index/)
+      end
+    end
+
+    describe "flush and sync" do
+      it "writes all buffered data" do
+        @buffer.write("\x01\x02", "\x03")
+        @buffer.flush
+        expect(File.binread(@file.path)).to eql "\x01\x02"
+        expect(File.binread(@index_file.path)).to eql "\x03"
+        @buffer.write("\x04", "\x05")
+        @buffer.sync
+        expect(File.binread(@file.path)).to eql "\x01\x02\x04"
+        expect(File.binread(@index_file.path)).to eql "\x03\x05"
+        expect(@buffer.buffered).to eql 0
+      end
+    end
+
+    describe "write failures" do
+      it "keeps the data which was not written" do
+        @buffer.write("\x01\x02", "\x03")
+        # Reopening read only keeps the file descriptor but writes fail
+        @file.reopen(@file.path, 'rb')
+        expect { @buffer.flush }.to raise_error(StandardError)
+        # The index file is still written
+        expect(File.binread(@index_file.path)).to eql "\x03"
+        expect(@buffer.buffered).to eql 2
+        expect { @buffer.write("\x04" * 20, "\x05") }.to raise_error(StandardError)
+        expect(@buffer.buffered).to eql 22
+        expect { @buffer.sync }.to raise_error(StandardError)
+        expect(@buffer.buffered).to eql 22
+
+        @file.reopen(@file.path, 'ab')
+        @buffer.sync
+        expect(@buffer.buffered).to eql 0
+        expect(File.binread(@file.path)).to eql "\x01\x02" + ("\x04" * 20)
+        expect(File.binread(@index_file.path)).to eql "\x03\x05"
+      end
+    end
+  end
+end
@@ -32,6 +32,36 @@ module Cosmos
       @plr = PacketLogReader.new
     end
 
+    def setup_logfile(cmd_or_tlm, raw_or_json, compress: false)
+      allow(File).to receive(:delete).and_return(nil)
+      s3 = double("Aws::S3::Client").as_null_object
+      allow(Aws::S3::Client).to receive(:new).and_return(s3)
+      plw = PacketLogWriter.new(@log_path, 'spec', compress: compress)
+      @start_time = Time.now
+      time = @start_time.to_nsec_from_epoch
+      @times = [time, time + Time::NSEC_PER_SECOND, time + 2 * Time::NSEC_PER_SECOND]
+      if cmd_or_tlm == :CMD
+        @pkt = System.commands.packet("INST", "COLLECT")
+        @pkt.write("DURATION", 10.0)
+      else
+        @pkt = System.telemetry.packet("INST", "HEALTH_STATUS")
+        @pkt.write("COLLECTS", 100)
+      end
+      data = raw_or_json == :RAW_PACKET ? @pkt.buffer : JSON.generate(@pkt.as_json)
+      plw.write(raw_or_json, cmd_or_tlm, @pkt.target_name, @pkt.packet_name, @times[0], true, data, nil, '0-0')
+      plw.write(raw_or_json, cmd_or_tlm, @pkt.target_name, @pkt.packet_name, @times[1], true, data, nil, '0-0')
+      plw.write(raw_or_json, cmd_or_tlm, @pkt.target_name, @pkt.packet_name, @times[2], true, data, nil, '0-0')
+      @logfile = plw.filename
+      @indexfile = plw.instance_variable_get(:@index_filename)
+      plw.shutdown
+      sleep 0.1
+
+      # Calculate the size of a single packet entry
+      tmp = Array.new(PacketLogReader::COSMOS5_PACKET_PACK_ITEMS, 0)
+      raw = tmp.pack(PacketLogReader::COSMOS5_PACKET_PACK_DIRECTIVE)
+      @pkt_entry_length = raw.length + data.length
+    end
+
     describe "open" do
       it "complains if the log file is too small" do
         tf = Tempfile.new('log_file')
@@ -69,35 +99,6 @@ module Cosmos
     end
 
     describe "each" do
-      def setup_logfile(cmd_or_tlm, raw_or_json)
-        allow(File).to receive(:delete).and_return(nil)
-        s3 = double("Aws::S3::Client").as_null_object
-        allow(Aws::S3::Client).to receive(:new).and_return(s3)
-        plw = PacketLogWriter.new(@log_path, 'spec')
-        @start_time = Time.now
-        time = @start_time.to_nsec_from_epoch
-        @times = [time, time + Time::NSEC_PER_SECOND, time + 2 * Time::NSEC_PER_SECOND]
-        if cmd_or_tlm == :CMD
-          @pkt = System.commands.packet("INST", "COLLECT")
-          @pkt.write("DURATION", 10.0)
-        else
-          @pkt = System.telemetry.packet("INST", "HEALTH_STATUS")
-          @pkt.write("COLLECTS", 100)
-        end
-        data = raw_or_json == :RAW_PACKET ? @pkt.buffer : JSON.generate(@pkt.as_json)
-        plw.write(raw_or_json, cmd_or_tlm, @pkt.target_name, @pkt.packet_name, @times[0], true, data, nil, '0-0')
-        plw.write(raw_or_json, cmd_or_tlm, @pkt.target_name, @pkt.packet_name, @times[1], true, data, nil, '0-0')
-        plw.write(raw_or_json, cmd_or_tlm, @pkt.target_name, @pkt.packet_name, @times[2], true, data, nil, '0-0')
-        @logfile = plw.filename
-        plw.shutdown
-        sleep 0.1
-
-        # Calculate the size of a single packet entry
-        tmp = Array.new(PacketLogReader::COSMOS5_PACKET_PACK_ITEMS, 0)
-        raw = tmp.pack(PacketLogReader::COSMOS5_PACKET_PACK_DIRECTIVE)
-        @pkt_entry_length = raw.length + data.length
-      end
-
       context "with raw telemetry" do
         before(:each) do
           setup_logfile(:TLM, :RAW_PACKET)
@@ -331,45 +332,293 @@ module Cosmos
       end
     end
 
-    # describe "packet_offsets and read_at_offset" do
-    #   it "returns packet offsets CTS-20, CTS-22" do
-    #     packet_offsets = @plr.packet_offsets(Dir[File.join(@log_path,"*cmd.bin")][0])
-    #     expect(@plr.log_type).to eql :CMD
-    #     expect(@plr.configuration_name).not_to be_nil
-    #     expect(@plr.hostname).to eql Socket.gethostname
-    #     header_length = 1 + 8 + 1 + 6 + 1 + 12 + 4
-    #     meta_header_length = 1 + 8 + 1 + 6 + 1 + 4 + 4
-    #     meta_length = System.telemetry.packet('SYSTEM', 'META').length
-    #     expect(packet_offsets).to eql [PacketLogReader::COSMOS4_HEADER_LENGTH, PacketLogReader::COSMOS4_HEADER_LENGTH + meta_header_length + meta_length, PacketLogReader::COSMOS4_HEADER_LENGTH + meta_header_length + meta_length + header_length + @cmd_packet_length, PacketLogReader::COSMOS4_HEADER_LENGTH + meta_header_length + meta_length + (header_length + @cmd_packet_length) * 2]
+    describe "each_view" do
+      before(:each) do
+        setup_logfile(:TLM, :RAW_PACKET)
+      end
+      after(:each) do
+        FileUtils.rm_f @logfile
+      end
 
-    #     expect(@plr.open(Dir[File.join(@log_path,"*cmd.bin")][0])).to eql [true, nil]
-    #     pkt = @plr.read_at_offset(packet_offsets[2]) # Grab the second STARTLOGGING (META is 0)
-    #     expect(pkt.target_name).to eql "SYSTEM"
-    #     expect(pkt.packet_name).to eql "STARTLOGGING"
-    #     expect(pkt.read('LABEL')).to eql "PKT2"
-    #     expect(pkt.received_time).to eql @time + 1
-    #     @plr.close
-    #   end
+      it "yields a reused view of each packet" do
+        views = []
+        @plr.each_view(@logfile) do |view|
+          expect(view).to be_a PacketView
+          expect(view.target_name).to eql @pkt.target_name
+          expect(view.packet_name).to eql @pkt.packet_name
+          expect(view.buffer).to eql @pkt.buffer
+          expect(view.read("COLLECTS")).to eql 100
+          expect(view.read("TEMP1", :RAW)).to eql @pkt.read("TEMP1", :RAW)
+          expect(view.received_time.to_nsec_from_epoch).to eql @times[views.length]
+          views << view
+        end
+        expect(views.length).to eql 3
+        expect(views.uniq.length).to eql 1
+      end
 
-    #   it "returns telemetry packet information" do
-    #     packet_offsets = @plr.packet_offsets(Dir[File.join(@log_path,"*tlm.bin")][0])
-    #     expect(@plr.log_type).to eql :TLM
-    #     expect(@plr.configuration_name).not_to be_nil
-    #     expect(@plr.hostname).to eql Socket.gethostname
-    #     header_length = 1 + 8 + 1 + 6 + 1 + 13 + 4
-    #     meta_header_length = 1 + 8 + 1 + 6 + 1 + 4 + 4
-    #     meta_length = System.telemetry.packet('SYSTEM', 'META').length
-    #     expect(packet_offsets).to eql [PacketLogReader::COSMOS4_HEADER_LENGTH, PacketLogReader::COSMOS4_HEADER_LENGTH + meta_header_length + meta_length, PacketLogReader::COSMOS4_HEADER_LENGTH + meta_header_length + meta_length + header_length + @tlm_packet_length, PacketLogReader::COSMOS4_HEADER_LENGTH + meta_header_length + meta_length + (header_length + @tlm_packet_length) * 2]
+      it "retains views" do
+        views = []
+        @plr.each_view(@logfile) { |view| views << view.retain }
+        expect(views.map { |view| view.received_time_nsec }).to eql @times
+      end
 
-    #     expect(@plr.open(Dir[File.join(@log_path,"*tlm.bin")][0])).to eql [true, nil]
-    #     pkt = @plr.read_at_offset(packet_offsets[2]) # Grab the second LIMITS_CHANGE (META is 0)
-    #     expect(pkt.target_name).to eql "SYSTEM"
-    #     expect(pkt.packet_name).to eql "LIMITS_CHANGE"
-    #     expect(pkt.read('PACKET')).to eql "PKT2"
-    #     expect(pkt.received_time).to eql @time + 1
-    #     @plr.close
-    #   end
-    # end
+      it "reads derived items and builds packets" do
+        @plr.each_view(@logfile) do |view|
+          expect(view.read("RECEIVED_TIMESECONDS")).to eql view.received_time.to_f
+          packet = view.to_packet
+          expect(packet.read("COLLECTS")).to eql 100
+          expect(packet.received_time).to eql view.received_time
+        end
+      end
+
+      it "returns packets between times" do
+        times = []
+        start_time = Time.from_nsec_from_epoch(@times[1])
+        @plr.each_view(@logfile, start_time, start_time) { |view| times << view.received_time_nsec }
+        expect(times).to eql [@times[1]]
+      end
+
+      it "does not change the packet definition" do
+        buffer = System.telemetry.packet("INST", "HEALTH_STATUS").buffer
+        @plr.each_view(@logfile) { |view| view.read("COLLECTS") }
+        expect(System.telemetry.packet("INST", "HEALTH_STATUS").buffer).to eql buffer
+      end
+    end
+
+    describe "each_merged_entry", no_ext: true do
+      before(:each) do
+        allow(File).to receive(:delete).and_return(nil)
+        s3 = double("Aws::S3::Client").as_null_object
+        allow(Aws::S3::Client).to receive(:new).and_return(s3)
+        @logfiles = []
+        time = Time.now.to_nsec_from_epoch
+        [['INST', 'HEALTH_STATUS', 0], ['INST', 'ADCS', 5], ['SYSTEM', 'LIMITS_CHANGE', 5]].each_with_index do |(target_name, packet_name, offset), index|
+          plw = PacketLogWriter.new(@log_path, "spec#{index}", compress: (index == 2))
+          4.times do |i|
+            plw.write(:RAW_PACKET, :TLM, target_name, packet_name, time + (i * 10) + offset, true, "\x00" * (index + 1), nil, '0-0')
+          end
+          @logfiles << plw.filename
+          plw.shutdown
+        end
+        sleep 0.1
+        @start = time
+      end
+      after(:each) do
+        @logfiles.each { |logfile| FileUtils.rm_f logfile }
+      end
+
+      it "yields entries from every log in time order" do
+        entries = []
+        @plr.each_merged_entry(@logfiles) do |cmd_or_tlm, target_name, packet_name, time_nsec, stored, data, log_index|
+          expect(cmd_or_tlm).to eql :TLM
+          expect(stored).to be true
+          expect(data).to eql "\x00" * (log_index + 1)
+          entries << [time_nsec - @start, packet_name, log_index]
+        end
+        expect(entries.length).to eql 12
+        expect(entries[0..3]).to eql [[0, 'HEALTH_STATUS', 0], [5, 'ADCS', 1], [5, 'LIMITS_CHANGE', 2], [10, 'HEALTH_STATUS', 0]]
+        expect(entries.map { |entry| entry[0] }).to eql entries.map { |entry| entry[0] }.sort
+      end
+
+      it "yields entries between times" do
+        times = []
+        @plr.each_merged_entry(@logfiles, @start + 10, @start + 20) { |_, _, _, time_nsec, _, _, _| times << (time_nsec - @start) }
+        expect(times).to eql [10, 15, 15, 20]
+      end
+    end
+
+    describe "each_entry" do
+      before(:each) do
+        setup_logfile(:TLM, :RAW_PACKET)
+      end
+      after(:each) do
+        FileUtils.rm_f @logfile
+      end
+
+      it "yields the contents of each packet entry" do
+        index = 0
+        @plr.each_entry(@logfile) do |cmd_or_tlm, target_name, packet_name, time_nsec, stored, data|
+          expect(cmd_or_tlm).to eql :TLM
+          expect(target_name).to eql @pkt.target_name
+          expect(packet_name).to eql @pkt.packet_name
+          expect(time_nsec).to eql @times[index]
+          expect(stored).to be true
+          expect(data).to eql @pkt.buffer
+          index += 1
+        end
+        expect(index).to eql 3
+        expect(@plr.redis_offset).to eql '0-0'
+      end
+
+      it "optionally yields data offsets" do
+        file_data = File.binread(@logfile)
+        index = 0
+        @plr.each_entry(@logfile, true) do |_, _, _, time_nsec, _, offset, length|
+          expect(time_nsec).to eql @times[index]
+          expect(file_data[offset, length]).to eql @pkt.buffer
+          index += 1
+        end
+        expect(index).to eql 3
+      end
+
+      it "complains about truncated files" do
+        File.open(@logfile, 'ab') { |file| file.write("\x00\x00\x01\x00\x10") }
+        expect { @plr.each_entry(@logfile) { |*args| } }.to raise_error(/entry/)
+      end
+    end
+
+    describe "index" do
+      before(:each) do
+        setup_logfile(:TLM, :RAW_PACKET)
+      end
+      after(:each) do
+        @plr.close
+        FileUtils.rm_f @logfile
+        FileUtils.rm_f @indexfile
+      end
+
+      it "returns the same packet offsets with or without the index" do
+        offsets = @plr.packet_offsets(@logfile)
+        expect(offsets.length).to eql 3
+        expect(offsets[1] - offsets[0]).to eql @pkt_entry_length + 4
+        expect(@plr.packet_offsets(@logfile, @indexfile)).to eql offsets
+      end
+
+      it "reads packets at offsets" do
+        offsets = @plr.packet_offsets(@logfile, @indexfile)
+        @plr.open(@logfile, @indexfile)
+        pkt = @plr.read_at_offset(offsets[1])
+        expect(pkt.target_name).to eql @pkt.target_name
+        expect(pkt.packet_name).to eql @pkt.packet_name
+        expect(pkt.packet_time.to_nsec_from_epoch).to eql @times[1]
+        expect(pkt.read('COLLECTS')).to eql 100
+        expect(@plr.read).to be_nil
+      end
+
+      it "splits the log into chunks" do
+        offsets = @plr.packet_offsets(@logfile, @indexfile)
+        end_offset = offsets[2] + 4 + @pkt_entry_length
+        expect(@plr.chunks(@logfile, @indexfile, 1)).to eql [offsets[0]...end_offset]
+        expect(@plr.chunks(@logfile, @indexfile, 3)).to eql [offsets[0]...offsets[1], offsets[1]...offsets[2], offsets[2]...end_offset]
+        # There are only 3 packets to split
+        expect(@plr.chunks(@logfile, @indexfile, 10).length).to eql 3
+      end
+
+      it "reads the same packets in chunks" do
+        times = []
+        @plr.each(@logfile) { |packet| times << packet.packet_time.to_nsec_from_epoch }
+        (1..4).each do |count|
+          chunk_times = []
+          @plr.chunks(@logfile, @indexfile, count).each do |chunk|
+            @plr.each_in_chunk(@logfile, @indexfile, chunk) do |packet|
+              expect(packet.target_name).to eql @pkt.target_name
+              expect(packet.packet_name).to eql @pkt.packet_name
+              expect(packet.read('COLLECTS')).to eql 100
+              chunk_times << packet.packet_time.to_nsec_from_epoch
+            end
+          end
+          expect(chunk_times).to eql times
+        end
+      end
+
+      it "seeks to a time" do
+        @plr.open(@logfile, @indexfile)
+        expect(@plr.seek_to_time(Time.from_nsec_from_epoch(@times[1] - 1))).to be true
+        expect(@plr.read.packet_time.to_nsec_from_epoch).to eql @times[1]
+        expect(@plr.seek_to_time(Time.from_nsec_from_epoch(@times[0] - 1))).to be true
+        expect(@plr.read.packet_time.to_nsec_from_epoch).to eql @times[0]
+        expect(@plr.seek_to_time(Time.from_nsec_from_epoch(@times[2] + 1))).to be false
+        expect(@plr.read.packet_time.to_nsec_from_epoch).to eql @times[2]
+      end
+
+      it "returns packets after a start time using the index" do
+        times = []
+        @plr.each(@logfile, true, Time.from_nsec_from_epoch(@times[1]), nil, index_filename: @indexfile) do |packet|
+          times << packet.packet_time.to_nsec_from_epoch
+        end
+        expect(times).to eql @times[1..2]
+      end
+
+      it "complains if no index is open" do
+        @plr.open(@logfile)
+        expect { @plr.seek_to_time(Time.now) }.to raise_error(/index/)
+      end
+
+      it "complains about a bad index header" do
+        File.open(@indexfile, 'r+b') { |file| file.write('BADHEADR') }
+        expect { @plr.open(@logfile, @indexfile) }.to raise_error(/index file header/)
+      end
+    end
+
+    describe "compressed logs" do
+      before(:each) do
+        setup_logfile(:TLM, :RAW_PACKET, compress: true)
+      end
+      after(:each) do
+        @plr.close
+        FileUtils.rm_f @logfile
+        FileUtils.rm_f @indexfile
+      end
+
+      it "writes the compressed headers" do
+        expect(File.binread(@logfile, PacketLogReader::COSMOS5_HEADER_LENGTH)).to eql PacketLogReader::COSMOS5_COMPRESSED_FILE_HEADER
+        expect(File.binread(@indexfile, PacketLogReader::COSMOS5_HEADER_LENGTH)).to eql PacketLogReader::COSMOS5_COMPRESSED_INDEX_HEADER
+      end
+
+      it "returns packets" do
+        index = 0
+        @plr.each(@logfile) do |packet|
+          expect(packet.target_name).to eql @pkt.target_name
+          expect(packet.packet_name).to eql @pkt.packet_name
+          expect(packet.packet_time.to_nsec_from_epoch).to eql @times[index]
+          expect(packet.read('COLLECTS')).to eql 100
+          index += 1
+        end
+        expect(index).to eql 3
+      end
+
+      it "yields packet entries" do
+        times = []
+        @plr.each_entry(@logfile) do |_, _, _, time_nsec, _, data|
+          expect(data).to eql @pkt.buffer
+          times << time_nsec
+        end
+        expect(times).to eql @times
+        expect(@plr.redis_offset).to eql '0-0'
+        expect { @plr.each_entry(@logfile, true) { |*args| } }.to raise_error(/compressed/)
+      end
+
+      it "returns the compressed size and position" do
+        @plr.open(@logfile)
+        expect(@plr.size).to eql File.size(@logfile)
+        expect(@plr.bytes_read).to eql PacketLogReader::COSMOS5_HEADER_LENGTH
+        # All the packets are in one block which is read with the first packet
+        @plr.read
+        expect(@plr.bytes_read).to eql File.size(@logfile)
+        @plr.read
+        @plr.read
+        expect(@plr.read).to be_nil
+        expect(@plr.bytes_read).to eql @plr.size
+      end
+
+      it "seeks to the block containing a time" do
+        @plr.open(@logfile, @indexfile)
+        expect(@plr.seek_to_time(Time.from_nsec_from_epoch(@times[1]))).to be true
+        expect(@plr.read.packet_time.to_nsec_from_epoch).to eql @times[0] # All in one block
+        expect(@plr.seek_to_time(Time.from_nsec_from_epoch(@times[2] + 1))).to be false
+      end
+
+      it "complains about chunks" do
+        expect { @plr.chunks(@logfile, @indexfile, 2) }.to raise_error(/compressed/)
+        expect { @plr.each_in_chunk(@logfile, @indexfile, 0...1) { |packet| } }.to raise_error(/compressed/)
+      end
+
+      it "complains about mismatched index files" do
+        expect { @plr.open(@logfile, @indexfile) }.not_to raise_error
+        File.open(@indexfile, 'r+b') { |file| file.write(PacketLogReader::COSMOS5_INDEX_HEADER) }
+        expect { @plr.open(@logfile, @indexfile) }.to raise_error(/uncompressed/)
+      end
+    end
 
     # describe "first" do
     #   it "returns the first command packet and retain the file position" do
@@ -43,6 +43,11 @@ module Cosmos
         expect { PacketLogWriter.new(@log_dir, "test", true, 1, nil) }.to raise_error("cycle_time must be >= #{PacketLogWriter::CYCLE_TIME_INTERVAL}")
         expect { PacketLogWriter.new(@log_dir, "test", true, 1.5, nil) }.to raise_error("cycle_time must be >= #{PacketLogWriter::CYCLE_TIME_INTERVAL}")
       end
+
+      it "raises with an invalid durability" do
+        expect { PacketLogWriter.new(@log_dir, "test", durability: 'BLAH') }.to raise_error(ArgumentError)
+        expect { PacketLogWriter.new(@log_dir, "test", durability: 0) }.to raise_error(/durability must be/)
+      end
     end
 
     describe "write" do
@@ -231,6 +236,93 @@ module Cosmos
       end
     end
 
+    describe "summary" do
+      it "adds a packet summary to the index footer" do
+        time = Time.now.to_nsec_from_epoch
+        plw = PacketLogWriter.new(@log_dir, 'test')
+        plw.write(:RAW_PACKET, :TLM, 'TGT1', 'PKT1', time + 10, false, "\x01\x02", nil, '0-0')
+        plw.write(:RAW_PACKET, :TLM, 'TGT1', 'PKT1', time, false, "\x01\x02", nil, '0-0')
+        plw.write(:RAW_PACKET, :CMD, 'TGT2', 'PKT2', time + 5, false, "\x03\x04", nil, '0-0')
+        plw.shutdown
+        sleep 0.1
+
+        idx = @files.select { |name, _| File.extname(name) == '.idx' }.values[0]
+        footer_length = idx[-4..-1].unpack('N')[0]
+        summary = PacketLogReader.parse_summary(idx[-footer_length..-1])
+        expect(summary['packets']).to contain_exactly(
+          { 'cmd_or_tlm' => 'TLM', 'target_name' => 'TGT1', 'packet_name' => 'PKT1', 'count' => 2, 'min_time' => time, 'max_time' => time + 10 },
+          { 'cmd_or_tlm' => 'CMD', 'target_name' => 'TGT2', 'packet_name' => 'PKT2', 'count' => 1, 'min_time' => time + 5, 'max_time' => time + 5 }
+        )
+      end
+
+      it "optionally summarizes numeric items" do
+        pkt = System.telemetry.packet("INST", "HEALTH_STATUS")
+        plw = PacketLogWriter.new(@log_dir, 'test', summary_items: true)
+        [100, 50, 200].each do |collects|
+          pkt.write("COLLECTS", collects)
+          plw.write(:RAW_PACKET, :TLM, 'INST', 'HEALTH_STATUS', Time.now.to_nsec_from_epoch, false, pkt.buffer, nil, '0-0')
+        end
+        plw.write(:JSON_PACKET, :TLM, 'INST', 'ADCS', Time.now.to_nsec_from_epoch, false, JSON.generate({ 'POSX' => 1.5, 'POSX__F' => '1.5' }), nil, '0-0')
+        plw.shutdown
+        sleep 0.1
+
+        idx = @files.select { |name, _| File.extname(name) == '.idx' }.values[0]
+        File.open('test_log.idx', 'wb') { |file| file.write idx }
+        summary = PacketLogReader.new.summary('test_log.idx')
+        health_status, adcs = summary['packets']
+        expect(health_status['items']['COLLECTS']).to eql [50, 200]
+        expect(health_status['items']).to_not have_key('ARY')
+        expect(adcs['items']).to eql({ 'POSX' => [1.5, 1.5] })
+        FileUtils.rm_f 'test_log.idx'
+      end
+
+      it "writes the summary length in bytes" do
+        plw = PacketLogWriter.new(@log_dir, 'test', summary_items: true)
+        plw.write(:JSON_PACKET, :TLM, 'INST', 'ADCS', Time.now.to_nsec_from_epoch, false, JSON.generate({ "TEMP\u00B0C" => 20 }).b, nil, '0-0')
+        plw.shutdown
+        sleep 0.1
+
+        idx = @files.select { |name, _| File.extname(name) == '.idx' }.values[0]
+        footer_length = idx[-4..-1].unpack('N')[0]
+        summary = PacketLogReader.parse_summary(idx[-footer_length..-1])
+        expect(summary['packets'][0]['items']).to eql({ "TEMP\u00B0C" => [20, 20] })
+      end
+    end
+
+    describe "flush_buffer" do
+      it "flushes buffered data after the flush interval" do
+        plw = PacketLogWriter.new(@log_dir, 'test', flush_interval: 0.2)
+        plw.write(:RAW_PACKET, :TLM, 'TGT1', 'PKT1', Time.now.to_nsec_from_epoch, false, "\x01\x02", nil, '0-0')
+        filename = plw.filename
+        expect(File.size(filename)).to eql 0
+        sleep 0.5
+        expect(File.size(filename)).to_not eql 0
+        plw.shutdown
+        sleep 0.1
+      end
+
+      it "flushes a partial compressed block after the flush interval" do
+        plw = PacketLogWriter.new(@log_dir, 'test', flush_interval: 0.2, compress: true)
+        plw.write(:RAW_PACKET, :TLM, 'TGT1', 'PKT1', Time.now.to_nsec_from_epoch, false, "\x01\x02", nil, '0-0')
+        filename = plw.filename
+        expect(plw.instance_variable_get(:@block)).to_not be_empty
+        sleep 0.5
+        expect(plw.instance_variable_get(:@block)).to be_empty
+        expect(File.size(filename)).to eql plw.instance_variable_get(:@file_size)
+        plw.shutdown
+        sleep 0.1
+      end
+
+      it "syncs the log files at the durability interval" do
+        plw = PacketLogWriter.new(@log_dir, 'test', flush_interval: nil, durability: 100)
+        expect_any_instance_of(LogWriteBuffer).to receive(:sync).at_least(:once).and_call_original
+        plw.write(:RAW_PACKET, :TLM, 'TGT1', 'PKT1', Time.now.to_nsec_from_epoch, false, "\x01\x02", nil, '0-0')
+        sleep 0.3
+        plw.shutdown
+        sleep 0.1
+      end
+    end
+
     describe "start" do
       it "enables logging" do
         plw = PacketLogWriter.new(@log_dir, 'test', false) # Logging not enabled
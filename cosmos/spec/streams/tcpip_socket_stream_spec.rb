@@ -107,6 +107,28 @@ module Cosmos
           ss.disconnect
         end
 
+        it "returns data which later reads don't change" do
+          server = TCPServer.new(2000) # Server bound to port 2000
+          thread = Thread.new do
+            client = server.accept # Wait for a client to connect
+            client.write "first"
+            sleep 0.2
+            client.write "second"
+            client.close
+          end
+          socket = TCPSocket.new('localhost', 2000)
+          ss = TcpipSocketStream.new(nil, socket, nil, nil)
+          first = ss.read
+          expect(ss.read).to eql 'second'
+          expect(first).to eql 'first'
+          expect(first.encoding).to eql Encoding::ASCII_8BIT
+          thread.join
+          Cosmos.close_socket(socket)
+          Cosmos.close_socket(server)
+          sleep 0.1
+          ss.disconnect
+        end
+
         it "handles socket timeouts" do
           server = TCPServer.new(2000) # Server bound to port 2000
           thread = Thread.new do
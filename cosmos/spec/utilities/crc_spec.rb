@@ -30,6 +30,11 @@ module Cosmos
         @crc = Crc16.new()
         expect(@crc.calc('123456789')).to eql 0x29B1
       end
+
+      it "calculates a reflected 16 bit CRC" do
+        @crc = Crc16.new(Crc16::DEFAULT_POLY, 0, false, true)
+        expect(@crc.calc('123456789')).to eql 0x2189
+      end
     end
   end
 
@@ -39,6 +44,41 @@ module Cosmos
         @crc = Crc32.new()
         expect(@crc.calc('123456789')).to eql 0xCBF43926
       end
+
+      it "calculates a 32 bit CRC across a large buffer" do
+        @crc = Crc32.new()
+        expect(@crc.calc('123456789' * 100)).to eql 0x09FD0FD7
+      end
+
+      it "calculates a non-reflected 32 bit CRC" do
+        @crc = Crc32.new(Crc32::DEFAULT_POLY, Crc32::DEFAULT_SEED, true, false)
+        expect(@crc.calc('123456789')).to eql 0xFC891918
+      end
+    end
+
+    describe "update" do
+      it "calculates a 32 bit CRC across chunks" do
+        @crc = Crc32.new()
+        state = @crc.update(nil, '1234')
+        state = @crc.update(state, 'xx56789', 2)
+        expect(@crc.finalize(state)).to eql 0xCBF43926
+        state = @crc.update(@crc.seed, '123456789xx', 0, 9)
+        expect(@crc.finalize(state)).to eql 0xCBF43926
+      end
+    end
+
+    describe "calc_range" do
+      it "calculates a 32 bit CRC across part of the data" do
+        @crc = Crc32.new()
+        expect(@crc.calc_range('xx123456789xx', 2, 9)).to eql 0xCBF43926
+        expect(@crc.calc_range('123456789', 9, 0)).to eql @crc.calc('')
+      end
+
+      it "complains about ranges outside the data" do
+        @crc = Crc32.new()
+        expect { @crc.calc_range('123456789', 8, 2) }.to raise_error(IndexError)
+        expect { @crc.calc_range('123456789', -1, 2) }.to raise_error(IndexError)
+      end
     end
   end
 
@@ -48,6 +88,11 @@ module Cosmos
         @crc = Crc64.new()
         expect(@crc.calc('123456789')).to eql 0x995dc9bbdf1939fa
       end
+
+      it "calculates a non-reflected 64 bit CRC" do
+        @crc = Crc64.new(Crc64::DEFAULT_POLY, 0, false, false)
+        expect(@crc.calc('123456789')).to eql 0x6c40df5f0b497347
+      end
     end
   end
 end
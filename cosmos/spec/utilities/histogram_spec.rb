@@ -0,0 +1,93 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require "spec_helper"
+require "cosmos/utilities/histogram"
+
+module Cosmos
+  describe Histogram, no_ext: true do
+    before(:each) do
+      @histogram = Histogram.new
+    end
+
+    describe "record" do
+      it "counts values and tracks the max" do
+        expect(@histogram.count).to eql 0
+        expect(@histogram.max).to eql 0.0
+        @histogram.record(0.001)
+        @histogram.record(0.5)
+        @histogram.record(0.002)
+        expect(@histogram.count).to eql 3
+        expect(@histogram.max).to eql 0.5
+      end
+
+      it "clamps negative and huge values" do
+        @histogram.record(-1)
+        @histogram.record(1_000_000)
+        expect(@histogram.count).to eql 2
+        expect(@histogram.percentile(50)).to eql 0.0
+        expect(@histogram.max).to be_within(1).of(4398)
+      end
+    end
+
+    describe "percentile" do
+      it "returns 0 when empty" do
+        expect(@histogram.percentile(99)).to eql 0.0
+      end
+
+      it "returns values within the bucket precision" do
+        1.upto(1000) { |i| @histogram.record(i / 1000.0) }
+        expect(@histogram.percentile(50)).to be_within(0.5 * 0.04).of(0.5)
+        expect(@histogram.percentile(99)).to be_within(0.99 * 0.04).of(0.99)
+        expect(@histogram.percentile(99.9)).to be_within(0.999 * 0.04).of(0.999)
+        expect(@histogram.percentile(100)).to be_within(0.04).of(1.0)
+      end
+
+      it "is exact for small nanosecond values" do
+        @histogram.record(10e-9)
+        expect(@histogram.percentile(50)).to be_within(1e-12).of(10e-9)
+      end
+    end
+
+    describe "reset" do
+      it "clears all values" do
+        @histogram.record(0.1)
+        @histogram.reset
+        expect(@histogram.count).to eql 0
+        expect(@histogram.max).to eql 0.0
+        expect(@histogram.percentile(50)).to eql 0.0
+      end
+    end
+
+    describe "snapshot_and_reset" do
+      it "returns the values and clears them" do
+        @histogram.record(0.1)
+        @histogram.record(0.2)
+        snapshot = @histogram.snapshot_and_reset
+        expect(snapshot).to be_a Histogram
+        expect(snapshot.count).to eql 2
+        expect(snapshot.max).to eql 0.2
+        expect(@histogram.count).to eql 0
+        @histogram.record(0.3)
+        expect(snapshot.count).to eql 2
+        expect(@histogram.snapshot_and_reset.max).to eql 0.3
+      end
+    end
+  end
+end
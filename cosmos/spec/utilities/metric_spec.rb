@@ -84,6 +84,15 @@ module Cosmos
       end
     end
 
+    describe "histogram" do
+      it "registers a histogram once per name and labels" do
+        histogram = @metric.histogram(name: "test", labels: { "is" => true })
+        expect(@metric.histogram(name: "test", labels: { "is" => true })).to be(histogram)
+        expect(@metric.histogram(name: "test", labels: { "is" => false })).not_to be(histogram)
+        expect(@metric.histograms.keys).to eql(["test|is=true", "test|is=false"])
+      end
+    end
+
     describe "output" do
       it "empty value generate summary metrics based on samples" do
         expect(@metric.items.empty?).to eql(true)
@@ -106,6 +115,29 @@ module Cosmos
         @metric.output
         expect(@redis.hget("bar__cosmos__metric", "foo")).not_to eql(nil)
       end
+
+      it "generates percentile and max metrics for histograms" do
+        histogram = @metric.histogram(name: "test", labels: { "is" => true })
+        @metric.output
+        expect(@redis.hget("bar__cosmos__metric", "foo")).to eql(nil)
+        histogram.record(0.5)
+        @metric.output
+        json = JSON.parse(@redis.hget("bar__cosmos__metric", "foo"))
+        expect(json['metric_name']).to eql("test")
+        expect(json['label_list'].map { |labels| labels['percentile'] }).to eql([50, 99, 99.9, 'max'])
+        expect(json['label_list'][-1]['metric__value']).to eql(0.5)
+      end
+
+      it "resets histograms after each output" do
+        histogram = @metric.histogram(name: "test", labels: { "is" => true })
+        histogram.record(0.5)
+        @metric.output
+        expect(histogram.count).to eql(0)
+        histogram.record(0.25)
+        @metric.output
+        json = JSON.parse(@redis.hget("bar__cosmos__metric", "foo"))
+        expect(json['label_list'][-1]['metric__value']).to eql(0.25)
+      end
     end
   end
 end
@@ -0,0 +1,158 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+require "spec_helper"
+require "cosmos/utilities/reducer_accumulator"
+
+module Cosmos
+  describe ReducerAccumulator, no_ext: true do
+    before(:each) do
+      @accumulator = ReducerAccumulator.new(2)
+    end
+
+    describe "add" do
+      it "returns nil for empty slots" do
+        expect(@accumulator.samples(0)).to eql 0
+        expect(@accumulator.min(0)).to be_nil
+        expect(@accumulator.max(0)).to be_nil
+        expect(@accumulator.mean(0)).to be_nil
+        expect(@accumulator.stddev(0)).to be_nil
+      end
+
+      it "matches the population statistics" do
+        values = (1..60).to_a
+        values.each { |value| @accumulator.add(1, value) }
+        mean, stddev = Math.stddev_population(values)
+        expect(@accumulator.samples(1)).to eql 60
+        expect(@accumulator.min(1)).to eql 1
+        expect(@accumulator.max(1)).to eql 60
+        expect(@accumulator.mean(1)).to eql mean
+        expect(@accumulator.stddev(1)).to be_within(1e-9).of(stddev)
+        expect(@accumulator.samples(0)).to eql 0
+      end
+
+      it "returns floats once a float is added" do
+        @accumulator.add(0, 1)
+        @accumulator.add(0, 2.5)
+        expect(@accumulator.min(0)).to eql 1.0
+        expect(@accumulator.max(0)).to eql 2.5
+      end
+
+      it "complains about slots out of range" do
+        expect { @accumulator.add(2, 1) }.to raise_error(IndexError)
+        expect { @accumulator.samples(-1) }.to raise_error(IndexError)
+      end
+    end
+
+    describe "combine" do
+      it "matches the statistics of all the values" do
+        values = Array.new(100) { |i| (i * 7919) % 101 - 50.5 }
+        values.each_slice(30) do |slice|
+          mean, stddev = Math.stddev_population(slice)
+          @accumulator.combine(0, slice.length, slice.min, slice.max, mean, stddev)
+        end
+        mean, stddev = Math.stddev_population(values)
+        expect(@accumulator.samples(0)).to eql 100
+        expect(@accumulator.min(0)).to eql values.min
+        expect(@accumulator.max(0)).to eql values.max
+        expect(@accumulator.mean(0)).to be_within(1e-9).of(mean)
+        expect(@accumulator.stddev(0)).to be_within(1e-9).of(stddev)
+      end
+    end
+
+    describe "add_hash" do
+      it "prefers numeric converted values over raw values" do
+        keys = ["A__C", "A", nil, "B"]
+        @accumulator.add_hash({ "A" => 1, "A__C" => 2.5, "B" => 3 }, keys)
+        @accumulator.add_hash({ "A" => 4, "A__C" => "STATE", "B" => "STRING" }, keys)
+        expect(@accumulator.samples(0)).to eql 2
+        expect(@accumulator.min(0)).to eql 2.5
+        expect(@accumulator.max(0)).to eql 4.0
+        expect(@accumulator.samples(1)).to eql 1
+        expect(@accumulator.max(1)).to eql 3
+      end
+
+      it "complains about the wrong number of keys" do
+        expect { @accumulator.add_hash({}, ["A"]) }.to raise_error(ArgumentError)
+      end
+    end
+
+    describe "combine_hash" do
+      it "skips slots without every reduced value" do
+        keys = %w(A_SAMPLES A_MIN A_MAX A_AVG A_STDDEV B_SAMPLES B_MIN B_MAX B_AVG B_STDDEV)
+        hash = { "A_SAMPLES" => 2, "A_MIN" => 1, "A_MAX" => 3, "A_AVG" => 2.0, "A_STDDEV" => 1.0, "B_SAMPLES" => 2 }
+        @accumulator.combine_hash(hash, keys)
+        @accumulator.combine_hash(hash, keys)
+        expect(@accumulator.samples(0)).to eql 4
+        expect(@accumulator.min(0)).to eql 1
+        expect(@accumulator.stddev(0)).to eql 1.0
+        expect(@accumulator.samples(1)).to eql 0
+      end
+    end
+
+    describe "add_json" do
+      it "matches add_hash" do
+        keys = ["A__C", "A", nil, "B"]
+        json = ['{"A":1,"A__C":2.5,"B":3,"S":"}","ARY":[1,{"B":9}]}', '{ "A" : 4 , "A__C" : "STATE" , "B" : -2e3 }']
+        other = ReducerAccumulator.new(2)
+        json.each do |data|
+          @accumulator.add_json(data, keys)
+          other.add_hash(JSON.parse(data), keys)
+        end
+        2.times do |slot|
+          expect(@accumulator.samples(slot)).to eql other.samples(slot)
+          expect(@accumulator.min(slot)).to eql other.min(slot)
+          expect(@accumulator.max(slot)).to eql other.max(slot)
+          expect(@accumulator.mean(slot)).to eql other.mean(slot)
+          expect(@accumulator.stddev(slot)).to eql other.stddev(slot)
+        end
+      end
+
+      it "complains about invalid JSON objects" do
+        ['{"A":1', '[1]', '{"A":1,}'].each do |data|
+          expect { @accumulator.add_json(data, [nil, "A", nil, "B"]) }.to raise_error(ArgumentError, "Invalid JSON object")
+        end
+      end
+    end
+
+    describe "combine_json" do
+      it "combines reduced values" do
+        keys = %w(A_SAMPLES A_MIN A_MAX A_AVG A_STDDEV B_SAMPLES B_MIN B_MAX B_AVG B_STDDEV)
+        @accumulator.combine_json('{"A_SAMPLES":2,"A_MIN":1,"A_MAX":3,"A_AVG":2.0,"A_STDDEV":1.0}', keys)
+        @accumulator.combine_json('{"A_SAMPLES":2,"A_MIN":1,"A_MAX":3,"A_AVG":2.0,"A_STDDEV":1.0}', keys)
+        expect(@accumulator.samples(0)).to eql 4
+        expect(@accumulator.max(0)).to eql 3
+        expect(@accumulator.stddev(0)).to eql 1.0
+        expect(@accumulator.samples(1)).to eql 0
+      end
+    end
+
+    describe "reset" do
+      it "clears every slot" do
+        @accumulator.add(0, 1.5)
+        @accumulator.add(1, 2)
+        @accumulator.reset
+        expect(@accumulator.samples(0)).to eql 0
+        expect(@accumulator.samples(1)).to eql 0
+        @accumulator.add(1, 3)
+        expect(@accumulator.min(1)).to eql 3
+      end
+    end
+  end
+end
@@ -0,0 +1,119 @@
+# encoding: ascii-8bit
+
+# Copyright 2022 Ball Aerospace & Technologies Corp.
+# All Rights Reserved.
+#
+# This program is free software; you can modify and/or redistribute it
+# under the terms of the GNU Affero General Public License
+# as published by the Free Software Foundation; version 3 with
+# attribution addendums as found in the LICENSE.txt
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Affero General Public License for more details.
+#
+# This program may also be used under the terms of a commercial or
+# enterprise edition license of COSMOS if purchased from the
+# copyright holder
+
+# Replays a synthetic day of decom logs through the minute reducer with
+# different worker counts. S3 and Redis are replaced with local files.
+#
+# Environment variables:
+#   PACKETS - Number of packets (default 8)
+#   PERIOD - Seconds between samples of each packet (default 10)
+#   ITEMS - Numeric items per packet (default 50)
+#   WORKERS - Comma separated worker counts (default 1,4)
+
+require 'benchmark'
+require 'tmpdir'
+require 'fileutils'
+require 'cosmos'
+require 'cosmos/microservices/reducer_microservice'
+
+PACKETS = (ENV['PACKETS'] || 8).to_i
+PERIOD = (ENV['PERIOD'] || 10).to_i
+ITEMS = (ENV['ITEMS'] || 50).to_i
+WORKERS = (ENV['WORKERS'] || '1,4').split(',').map(&:to_i)
+FILE_SECONDS = 600
+START_TIME = Time.utc(2022, 1, 1).to_i
+BENCH_DIR = Dir.mktmpdir
+
+module Cosmos
+  class S3Utilities
+    # Keep the decom logs to reduce and throw away everything else
+    def self.move_log_file_to_s3(filename, s3_key)
+      if s3_key.end_with?('__decom.bin')
+        FileUtils.mv(filename, File.join(BENCH_DIR, File.basename(s3_key)))
+      else
+        File.delete(filename)
+      end
+    end
+  end
+
+  class S3File
+    def initialize(s3_path)
+      @s3_path = s3_path
+    end
+
+    def retrieve
+    end
+
+    def local_path
+      @s3_path
+    end
+
+    def delete
+    end
+  end
+
+  class ReducerModel
+    def self.rm_file(s3_key)
+    end
+  end
+end
+
+# The log writers look up target ids so use a system without any targets
+Cosmos::System.instance([], File.expand_path(File.join(__dir__, '..', '..', 'spec', 'install', 'config', 'targets')))
+
+PACKETS.times do |packet|
+  packet_name = "PKT#{packet}"
+  (0...86400).step(FILE_SECONDS) do |file_offset|
+    plw = Cosmos::PacketLogWriter.new('bench', "DEFAULT__BENCH__#{packet_name}__rt__decom")
+    (file_offset...(file_offset + FILE_SECONDS)).step(PERIOD) do |offset|
+      time = (START_TIME + offset) * Time::NSEC_PER_SECOND
+      json_hash = {}
+      ITEMS.times do |item|
+        json_hash["ITEM#{item}"] = (offset + item) % 4096
+        json_hash["ITEM#{item}__C"] = ((offset + item) % 4096) * 0.5 if item.even?
+      end
+      json_hash["STRING"] = "#{packet_name} #{offset}"
+      plw.write(:JSON_PACKET, :TLM, 'BENCH', packet_name, time, false, JSON.generate(json_hash), nil, '0-0')
+    end
+    plw.shutdown
+  end
+end
+sleep 0.1 while Dir[File.join(BENCH_DIR, '*.bin')].length < PACKETS * (86400 / FILE_SECONDS)
+files = Dir[File.join(BENCH_DIR, '*.bin')].sort
+samples = PACKETS * (86400 / PERIOD)
+puts "#{files.length} files, #{samples} packets, #{ITEMS} items per packet"
+
+Benchmark.bm(12) do |x|
+  WORKERS.each do |worker_count|
+    reducer = Cosmos::ReducerMicroservice.allocate
+    reducer.instance_variable_set(:@target_name, 'BENCH')
+    reducer.instance_variable_set(:@packet_logs, {})
+    reducer.instance_variable_set(:@packet_logs_mutex, Mutex.new)
+    reducer.instance_variable_set(:@worker_count, worker_count)
+    result = x.report("#{worker_count} workers") do
+      reducer.reduce_files(files) do |file|
+        reducer.process_file(file, 'minute', Cosmos::ReducerMicroservice::MINUTE_ENTRY_SECS, Cosmos::ReducerMicroservice::MINUTE_FILE_SECS)
+      end
+    end
+    reducer.instance_variable_get(:@packet_logs).each_value(&:shutdown)
+    puts "#{(samples / result.real).round} packets/s"
+  end
+end
+
+FileUtils.rm_rf(BENCH_DIR)